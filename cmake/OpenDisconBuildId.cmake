@@ -0,0 +1,37 @@
+# Copyright (C) 2017 IK4-IKERLAN
+#
+# This file is part of OpenDiscon.
+#
+# OpenDiscon is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# OpenDiscon is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+
+# Build identity of OpenDiscon, run by the OpenDisconBuildId target with
+# cmake -P. It hashes the configuration hash and the contents of the files
+# listed in FILE_LIST, one per line, and writes OPENDISCON_BUILD_ID to OUTPUT,
+# which is only touched when the identity changes. The initialised controller
+# cache, ikParcache, keys its files on it.
+#
+# Variables: FILE_LIST, CONFIGURATION, OUTPUT
+
+file (STRINGS ${FILE_LIST} FILES)
+set (IDENTITY "${CONFIGURATION}")
+foreach (FILE ${FILES})
+	file (SHA256 ${FILE} FILE_HASH)
+	set (IDENTITY "${IDENTITY}${FILE_HASH}")
+endforeach ()
+string (SHA256 IDENTITY "${IDENTITY}")
+string (SUBSTRING ${IDENTITY} 0 16 IDENTITY)
+
+file (WRITE ${OUTPUT}.new "/* generated by cmake/OpenDisconBuildId.cmake, do not edit */\n#define OPENDISCON_BUILD_ID 0x${IDENTITY}ULL\n")
+configure_file (${OUTPUT}.new ${OUTPUT} COPYONLY)
+file (REMOVE ${OUTPUT}.new)
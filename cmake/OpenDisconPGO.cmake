@@ -0,0 +1,58 @@
+# Copyright (C) 2017 IK4-IKERLAN
+#
+# This file is part of OpenDiscon.
+#
+# OpenDiscon is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# OpenDiscon is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+
+# Profile-guided, link-time optimised build of OpenDiscon, run by the pgo target
+# with cmake -P. The tree in BINARY_DIR is configured as a unity build with
+# link-time optimisation, built with instrumentation, trained with the regress
+# benchmark, which runs the closed loop below and above rated wind speed, and
+# rebuilt with the collected profile.
+#
+# Variables: SOURCE_DIR, BINARY_DIR, C_COMPILER, BUILD_TYPE, FAST_STEP, DIAGNOSTICS
+
+if (NOT BUILD_TYPE)
+	set (BUILD_TYPE Release)
+endif ()
+set (CONFIGURE_ARGS
+	-DCMAKE_C_COMPILER=${C_COMPILER}
+	-DCMAKE_BUILD_TYPE=${BUILD_TYPE}
+	-DOPENDISCON_FAST_STEP=${FAST_STEP}
+	-DOPENDISCON_DIAGNOSTICS=${DIAGNOSTICS}
+	-DOPENDISCON_UNITY_BUILD=ON
+	-DOPENDISCON_LTO=ON
+)
+
+function (run)
+	execute_process (COMMAND ${ARGN} WORKING_DIRECTORY ${BINARY_DIR} RESULT_VARIABLE RESULT)
+	if (RESULT)
+		message (FATAL_ERROR "failed: ${ARGN}")
+	endif ()
+endfunction ()
+
+file (MAKE_DIRECTORY ${BINARY_DIR})
+
+# instrumented build, trained from scratch
+run (${CMAKE_COMMAND} ${CONFIGURE_ARGS} -DOPENDISCON_PGO=GENERATE ${SOURCE_DIR})
+run (${CMAKE_COMMAND} --build . --target regress)
+file (GLOB_RECURSE PROFILES ${BINARY_DIR}/*.gcda)
+if (PROFILES)
+	file (REMOVE ${PROFILES})
+endif ()
+run (${BINARY_DIR}/regress bench)
+
+# optimised build
+run (${CMAKE_COMMAND} -DOPENDISCON_PGO=USE ${SOURCE_DIR})
+run (${CMAKE_COMMAND} --build .)
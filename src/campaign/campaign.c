@@ -0,0 +1,484 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file campaign.c
+ *
+ * @brief Resumable parallel load case campaign
+ *
+ * Runs a list of load cases, each @link ikClwindconWTCon @endlink in closed
+ * loop with @link ikWtPlant @endlink in turbulent wind from
+ * @link ikWindGen @endlink, on a pool of threads, and writes the time series
+ * of every case to an @link ikSiglog @endlink file of its own in directory
+ * DIR, which is created if need be. Usage:
+ * @li campaign CASES DIR [-j THREADS] [-d DECIMATION] [-p PERIOD]
+ *
+ * CASES is a text file with a case per line, as
+ * NAME WINDSPEED TI SEED DURATION [DERATING], with the mean wind speed in
+ * m/s, the turbulence intensity non-dimensional, the duration in s and the
+ * derating ratio non-dimensional, 0 if left out. Empty lines and lines
+ * starting with # are skipped. Names must be unique, shorter than 64
+ * characters and made of letters, digits, '-', '_' and '.'. The defaults
+ * are a thread per processor, a logged sample per step and a progress report
+ * every 10 s.
+ *
+ * The cases are queued in the order of the file, and the threads take the
+ * next one as they become free. Each case starts from the steady operating
+ * point at its mean wind speed, as in powercurve, with the controller a
+ * clone of a template instance. Its signals are streamed, a sample every
+ * DECIMATION steps, to NAME.bin.part, which is renamed NAME.bin once closed
+ * and synced to disk, and the rename is made durable by syncing DIR. Then the case is appended to the journal,
+ * DIR/journal.txt, as a line with its name and its simulated and wall clock
+ * times, which is synced to disk too.
+ *
+ * Run again on the same DIR, the tool skips the cases in the journal, so a
+ * campaign which was killed, or whose machine went down, resumes where it
+ * stopped, losing at most the cases it was running, whose .part files are
+ * overwritten. A case whose parameters are changed is not run again unless
+ * its line is removed from the journal. Cases which fail, because the wind
+ * parameters are invalid or the log cannot be written, are reported and
+ * left out of the journal, so that the next run tries them again, and make
+ * the tool exit with 1.
+ *
+ * The progress report gives the cases done, the throughput in cases and in
+ * simulated seconds per second, and the estimated time to completion, the
+ * simulated time left over the throughput so far.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "ikClwindconWTConfig.h"
+#include "ikAtomic.h"
+#include "ikSiglog.h"
+#include "ikWindGen.h"
+#include "ikWtPlant.h"
+#include "ikClosedLoop.h"
+
+#define PI 3.14159265358979
+#define SAMPLE_PERIOD 0.01 /* s */
+#define MAXTHREADS 64
+#define MAXNAME 64
+#define MAXPATH 1024
+#define MAXLINE 1024
+#define JOURNAL "journal.txt"
+
+#define NSIGNALS 7
+static const char *signalNames[NSIGNALS] = {"wind speed", "generator speed", "generator torque", "electrical power",
+        "pitch angle", "tower top acceleration", "estimated wind speed"};
+static const char *signalUnits[NSIGNALS] = {"m/s", "rad/s", "kNm", "kW", "deg", "m/s^2", "m/s"};
+
+typedef struct loadCase {
+    char name[MAXNAME];
+    double windSpeed; /* m/s */
+    double turbulenceIntensity; /* - */
+    uint64_t seed;
+    double duration; /* s */
+    double deratingRatio; /* - */
+    int done;
+} loadCase;
+
+static loadCase *cases;
+static int nCases;
+static int *byName; /* case indices sorted by name */
+static int *jobs; /* indices of the cases to run, in order */
+static int nJobs;
+static ikAtomicInt nextJob;
+static const char *directory;
+static int decimation = 1;
+
+/* progress, guarded by the journal lock */
+static pthread_mutex_t journalLock = PTHREAD_MUTEX_INITIALIZER;
+static FILE *journal;
+static int nDone;
+static int nFailed;
+static double simulatedDone; /* s */
+static double simulatedFailed; /* s */
+
+static ikClwindconWTConParams param;
+static ikClwindconWTCon original;
+static ikClwindconWTCon cons[MAXTHREADS];
+static ikWtPlant plants[MAXTHREADS];
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9*ts.tv_nsec;
+}
+
+static int compareNames(const void *a, const void *b) {
+    return strcmp(cases[*(const int *) a].name, cases[*(const int *) b].name);
+}
+
+static loadCase *findCase(const char *name) {
+    int low = 0, high = nCases;
+
+    while (low < high) {
+        const int middle = low + (high - low)/2;
+        const int c = strcmp(cases[byName[middle]].name, name);
+        if (!c) return &(cases[byName[middle]]);
+        if (c < 0) low = middle + 1;
+        else high = middle;
+    }
+    return NULL;
+}
+
+static int validName(const char *name) {
+    const char *p;
+
+    for (p = name; *p; p++) {
+        if (!isalnum((unsigned char) *p) && '-' != *p && '_' != *p && '.' != *p) return 0;
+    }
+    return p > name && strcmp(name, ".") && strcmp(name, "..");
+}
+
+/* read the case list, and sort the cases by name to look them up */
+
+static int readCases(const char *fileName) {
+    FILE *f = fopen(fileName, "r");
+    char line[MAXLINE];
+    int capacity = 0;
+    int lineNumber = 0;
+    int i;
+
+    if (NULL == f) {
+        printf("cannot read %s\n", fileName);
+        return -1;
+    }
+    nCases = 0;
+    while (NULL != fgets(line, sizeof(line), f)) {
+        char name[MAXLINE];
+        unsigned long long seed;
+        loadCase *c;
+        int n;
+
+        lineNumber++;
+        n = sscanf(line, "%s", name);
+        if (n < 1 || '#' == name[0]) continue;
+        if (nCases == capacity) {
+            loadCase *grown;
+            capacity = capacity > 0 ? 2*capacity : 256;
+            grown = (loadCase *) realloc(cases, capacity*sizeof(loadCase));
+            if (NULL == grown) {
+                printf("out of memory\n");
+                fclose(f);
+                return -1;
+            }
+            cases = grown;
+        }
+        c = &(cases[nCases]);
+        c->deratingRatio = 0.0;
+        c->done = 0;
+        n = sscanf(line, "%s %lf %lf %llu %lf %lf", name, &(c->windSpeed), &(c->turbulenceIntensity), &seed, &(c->duration), &(c->deratingRatio));
+        if (n < 5 || strlen(name) >= MAXNAME || !validName(name) || !(c->duration > 0.0)) {
+            printf("%s:%d: expected NAME WINDSPEED TI SEED DURATION [DERATING]\n", fileName, lineNumber);
+            fclose(f);
+            return -1;
+        }
+        strcpy(c->name, name);
+        c->seed = (uint64_t) seed;
+        nCases++;
+    }
+    fclose(f);
+
+    byName = (int *) malloc((nCases > 0 ? nCases : 1)*sizeof(int));
+    jobs = (int *) malloc((nCases > 0 ? nCases : 1)*sizeof(int));
+    if (NULL == byName || NULL == jobs) {
+        printf("out of memory\n");
+        return -1;
+    }
+    for (i = 0; i < nCases; i++) byName[i] = i;
+    qsort(byName, nCases, sizeof(int), compareNames);
+    for (i = 1; i < nCases; i++) {
+        if (!strcmp(cases[byName[i - 1]].name, cases[byName[i]].name)) {
+            printf("%s: case %s is listed twice\n", fileName, cases[byName[i]].name);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* mark the cases in the journal as done, and open it for appending, on a
+   line of its own in case the last one was cut short */
+
+static int openJournal(void) {
+    char fileName[MAXPATH];
+    char line[MAXLINE];
+    int complete = 1;
+    FILE *f;
+
+    if (snprintf(fileName, MAXPATH, "%s/%s", directory, JOURNAL) >= MAXPATH) return -1;
+    f = fopen(fileName, "r");
+    if (NULL != f) {
+        while (NULL != fgets(line, sizeof(line), f)) {
+            char name[MAXLINE];
+            double simulated, wall;
+            loadCase *c;
+            complete = NULL != strchr(line, '\n');
+            if (!complete || 3 != sscanf(line, "%s %lf %lf", name, &simulated, &wall)) continue;
+            c = findCase(name);
+            if (NULL != c) c->done = 1;
+        }
+        fclose(f);
+    }
+
+    journal = fopen(fileName, "a");
+    if (NULL == journal) {
+        printf("cannot write %s\n", fileName);
+        return -1;
+    }
+    if (!complete) fputc('\n', journal);
+    return 0;
+}
+
+/* make a closed file durable, before it is renamed or journalled, or a rename in a directory */
+
+static int syncFile(const char *fileName) {
+    int fd = open(fileName, O_RDONLY);
+    int err;
+
+    if (fd < 0) return -1;
+    err = fsync(fd);
+    close(fd);
+    return err ? -1 : 0;
+}
+
+static int runCase(const loadCase *c, ikClwindconWTCon *con, ikWtPlant *wt) {
+    char partName[MAXPATH];
+    char fileName[MAXPATH];
+    ikWindGenParams windParams;
+    ikWindGen wind;
+    ikWtPlantParams plantParams;
+    ikSiglogParams logParams;
+    ikSiglog log;
+    double values[NSIGNALS];
+    long nSteps = (long) (c->duration/SAMPLE_PERIOD + 0.5);
+    long k;
+    int err = 0;
+    int i;
+
+    ikWindGen_initParams(&windParams);
+    windParams.meanSpeed = c->windSpeed;
+    windParams.turbulenceIntensity = c->turbulenceIntensity;
+    windParams.seed = c->seed;
+    windParams.samplePeriod = SAMPLE_PERIOD;
+    if (ikWindGen_init(&wind, &windParams)) return -1;
+
+    ikWtPlant_initParams(&plantParams);
+    plantParams.samplePeriod = SAMPLE_PERIOD;
+    ikWtPlant_init(wt, &plantParams);
+    if (ikClwindconWTCon_clone(con, &original)) ikClwindconWTCon_init(con, &param);
+    /* start at the steady operating point of the control law at the mean wind speed, if there is one */
+    ikClosedLoop_setInputs(&(con->in), c->deratingRatio, 0.0);
+    ikClosedLoop_trim(con, wt, &param, c->windSpeed, IKCLOSEDLOOP_TRIMSTEPS);
+
+    if (snprintf(fileName, MAXPATH, "%s/%s.bin", directory, c->name) >= MAXPATH
+            || snprintf(partName, MAXPATH, "%s.part", fileName) >= MAXPATH) {
+        ikWindGen_close(&wind);
+        return -2;
+    }
+    ikSiglog_initParams(&logParams);
+    logParams.fileName = partName;
+    logParams.nSignals = NSIGNALS;
+    for (i = 0; i < NSIGNALS; i++) {
+        logParams.names[i] = signalNames[i];
+        logParams.units[i] = signalUnits[i];
+    }
+    logParams.samplePeriod = decimation*SAMPLE_PERIOD;
+    logParams.startTime = SAMPLE_PERIOD;
+    logParams.pyramidLevels = 3;
+    if (ikSiglog_init(&log, &logParams)) {
+        ikWindGen_close(&wind);
+        return -2;
+    }
+
+    for (k = 0; k < nSteps && !err; k++) {
+        wt->in.windSpeed = ikWindGen_step(&wind);
+        ikClosedLoop_setInputs(&(con->in), c->deratingRatio, wt->out.generatorSpeed);
+        ikClwindconWTCon_step(con);
+        wt->in.torqueDemand = con->out.torqueDemand*1.0e3; /* kNm to Nm */
+        wt->in.pitchDemand[0] = con->out.pitchDemandBlade1/180.0*PI; /* deg to rad */
+        wt->in.pitchDemand[1] = con->out.pitchDemandBlade2/180.0*PI; /* deg to rad */
+        wt->in.pitchDemand[2] = con->out.pitchDemandBlade3/180.0*PI; /* deg to rad */
+        ikWtPlant_step(wt);
+        if (k % decimation) continue;
+
+        values[0] = wt->in.windSpeed;
+        values[1] = wt->out.generatorSpeed;
+        values[2] = wt->out.generatorTorque*1.0e-3; /* Nm to kNm */
+        values[3] = wt->out.electricalPower*1.0e-3; /* W to kW */
+        values[4] = wt->out.pitch[0]*180.0/PI; /* rad to deg */
+        values[5] = wt->out.towerTopAcceleration;
+        ikClwindconWTCon_getOutput(con, &(values[6]), "wind speed estimator>wind speed");
+        err = ikSiglog_write(&log, values);
+    }
+    if (ikSiglog_close(&log)) err = -2;
+    ikWindGen_close(&wind);
+
+    if (err || syncFile(partName) || rename(partName, fileName) || syncFile(directory)) return -2;
+    return 0;
+}
+
+/* journal a case done, or report it failed */
+
+static void finishCase(const loadCase *c, int err, double wall) {
+    pthread_mutex_lock(&journalLock);
+    if (!err) {
+        if (fprintf(journal, "%s\t%g\t%.3f\n", c->name, c->duration, wall) < 0 || fflush(journal)
+                || fsync(fileno(journal))) err = -3;
+    }
+    if (err) {
+        printf("case %s failed: %s\n", c->name, -1 == err ? "invalid wind parameters"
+                : (-2 == err ? "cannot write its log" : "cannot write the journal"));
+        nFailed++;
+        simulatedFailed += c->duration;
+    } else {
+        nDone++;
+        simulatedDone += c->duration;
+    }
+    pthread_mutex_unlock(&journalLock);
+}
+
+static void *worker(void *arg) {
+    int w = (int) (size_t) arg;
+    long j;
+
+    /* take the next case in the queue until there are none left */
+    while ((j = ikAtomic_fetchAdd(&nextJob, 1)) < nJobs) {
+        const loadCase *c = &(cases[jobs[j]]);
+        double start = now();
+        int err = runCase(c, &(cons[w]), &(plants[w]));
+        finishCase(c, err, now() - start);
+    }
+
+    return NULL;
+}
+
+static void report(int nSkipped, double simulatedTotal, double elapsed) {
+    int done, failed;
+    double simulated, left, rate;
+
+    pthread_mutex_lock(&journalLock);
+    done = nDone;
+    failed = nFailed;
+    simulated = simulatedDone;
+    left = simulatedTotal - simulatedDone - simulatedFailed;
+    pthread_mutex_unlock(&journalLock);
+
+    rate = elapsed > 0.0 ? simulated/elapsed : 0.0;
+    printf("%d/%d cases done, %d failed, %.2f cases/s, %.0f simulated s/s", nSkipped + done, nCases, failed,
+            elapsed > 0.0 ? done/elapsed : 0.0, rate);
+    if (left <= 0.0) printf(", completed in %.0f s\n", elapsed);
+    else if (rate > 0.0) printf(", %.0f s to completion\n", left/rate);
+    else printf("\n");
+    fflush(stdout);
+}
+
+static void usage(void) {
+    printf("usage: campaign CASES DIR [-j THREADS] [-d DECIMATION] [-p PERIOD]\n");
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t threads[MAXTHREADS];
+    long nProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    int nThreads = nProcessors > 0 ? (nProcessors < MAXTHREADS ? (int) nProcessors : MAXTHREADS) : 1;
+    double period = 10.0; /* s */
+    double simulatedTotal = 0.0;
+    double start, lastReport;
+    int finished;
+    int i;
+
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    for (i = 3; i < argc; i++) {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc) nThreads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc) decimation = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc) period = atof(argv[++i]);
+        else {
+            usage();
+            return 2;
+        }
+    }
+    directory = argv[2];
+    if (nThreads < 1 || nThreads > MAXTHREADS || decimation < 1 || !(period > 0.0) || strlen(directory) + MAXNAME + 16 > MAXPATH) {
+        usage();
+        return 2;
+    }
+    if (mkdir(directory, 0777) && EEXIST != errno) {
+        printf("cannot create %s\n", directory);
+        return 1;
+    }
+
+    /* queue the cases not in the journal */
+    if (readCases(argv[1]) || openJournal()) return 1;
+    nJobs = 0;
+    for (i = 0; i < nCases; i++) {
+        if (cases[i].done) continue;
+        jobs[nJobs++] = i;
+        simulatedTotal += cases[i].duration;
+    }
+    printf("%d cases, %d done before, %d to run on %d threads\n", nCases, nCases - nJobs, nJobs, nThreads);
+    fflush(stdout);
+
+    /* every case starts from a clone of this instance */
+    ikClwindconWTCon_initParams(&param);
+    setParams(&param);
+    if (ikClwindconWTCon_init(&original, &param)) {
+        printf("cannot initialise the controller\n");
+        return 1;
+    }
+
+    start = now();
+    lastReport = start;
+    nextJob = 0;
+    for (i = 0; i < nThreads; i++) {
+        if (pthread_create(&(threads[i]), NULL, worker, (void *) (size_t) i)) {
+            printf("cannot start the threads\n");
+            return 1;
+        }
+    }
+
+    /* report the progress until every case is done or has failed */
+    do {
+        usleep(100000);
+        pthread_mutex_lock(&journalLock);
+        finished = nDone + nFailed == nJobs;
+        pthread_mutex_unlock(&journalLock);
+        if (!finished && now() - lastReport >= period) {
+            lastReport = now();
+            report(nCases - nJobs, simulatedTotal, lastReport - start);
+        }
+    } while (!finished);
+    for (i = 0; i < nThreads; i++) pthread_join(threads[i], NULL);
+    report(nCases - nJobs, simulatedTotal, now() - start);
+
+    fclose(journal);
+    return nFailed ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file cosim.c
+ *
+ * @brief Pipelined multi-turbine co-simulation
+ *
+ * Runs a set of turbines in closed loop, each an @link ikWtPlant @endlink in
+ * turbulent wind from @link ikWindGen @endlink controlled by an
+ * @link ikDiscon @endlink instance through the swap array, twice: first on a
+ * single thread, alternating plant and controller steps turbine by turbine,
+ * and then pipelined, with the plants and the controllers on threads of
+ * their own. Usage:
+ * @li cosim [-n TURBINES] [-t DURATION] [-p PLANTTHREADS] [-c CONTROLLERTHREADS] [-d DIR]
+ *
+ * DURATION is in s. The defaults are 8 turbines, 60 s, 1 plant thread and
+ * 1 controller thread. Turbine i runs in wind of mean speed 6 + i mod 13 m/s
+ * and is stepped by plant thread i mod PLANTTHREADS and controller thread i
+ * mod CONTROLLERTHREADS. The controllers write their logs to DIR, default
+ * ".", prefixed with "turbine_" and the turbine number.
+ *
+ * In the pipelined run, each turbine owns its swap array, and the threads
+ * hand it back and forth through @link ikSpsc @endlink queues, one per pair
+ * of plant and controller threads and direction. A plant thread writes the
+ * plant outputs to the swap array and pushes it to the controller thread of
+ * the turbine, and goes on with whichever of its turbines has its controller
+ * outputs back, so that plant and controller steps of different turbines
+ * overlap. Each turbine still alternates plant and controller steps in the
+ * sequential order, so both runs must give the same results bit for bit; the
+ * tool reports the time per turbine step of each run and fails if they do
+ * not.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "ikDiscon.h"
+#include "ikSpsc.h"
+#include "ikWtPlant.h"
+#include "ikWindGen.h"
+
+#define SAMPLE_PERIOD 0.01 /* s */
+#define SWAP_SIZE 128
+#define MAXTURBINES 256
+#define MAXTHREADS 16
+
+#define NSIGNALS 3 /* generator speed, torque demand and collective pitch demand, traced at every step */
+
+typedef struct turbine {
+    ikDiscon discon;
+    ikWtPlant wt;
+    ikWindGen wind;
+    float DATA[SWAP_SIZE];
+    long step;
+    double *trace;
+} turbine;
+
+static turbine *turbines[MAXTURBINES];
+static int nTurbines = 8;
+static long nSteps;
+static int nPlantThreads = 1;
+static int nControllerThreads = 1;
+
+/* queues from plant thread p to controller thread c, and back */
+static ikSpsc toController[MAXTHREADS][MAXTHREADS];
+static ikSpsc toPlant[MAXTHREADS][MAXTHREADS];
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9*ts.tv_nsec;
+}
+
+static int start(turbine *t, int i, const char *dir) {
+    ikWtPlantParams plantParams;
+    ikWindGenParams windParams;
+    ikDisconParams disconParams;
+    char prefix[IKDISCON_MAXPREFIX + 32];
+
+    ikWtPlant_initParams(&plantParams);
+    plantParams.samplePeriod = SAMPLE_PERIOD;
+    if (ikWtPlant_init(&(t->wt), &plantParams)) return -1;
+
+    ikWindGen_initParams(&windParams);
+    windParams.meanSpeed = 6.0 + i % 13;
+    windParams.samplePeriod = SAMPLE_PERIOD;
+    windParams.seed = i + 1;
+    if (ikWindGen_init(&(t->wind), &windParams)) return -1;
+
+    ikDiscon_initParams(&disconParams);
+    sprintf(prefix, "%s/turbine_%03d_", dir, i);
+    disconParams.filePrefix = prefix;
+    disconParams.fullLog = 1;
+    disconParams.eventRecording = 1;
+    disconParams.fatigue = 1;
+    disconParams.statistics = 1;
+    if (ikDiscon_init(&(t->discon), &disconParams)) return -1;
+
+    memset(t->DATA, 0, sizeof(t->DATA));
+    t->step = 0;
+    return 0;
+}
+
+/* plant half of a step: plant outputs to the swap array */
+
+static void plantOut(turbine *t) {
+    t->wt.in.windSpeed = ikWindGen_step(&(t->wind));
+    t->DATA[0] = (float) (0 == t->step ? 0 : (nSteps - 1 == t->step ? -1 : 1));
+    ikWtPlant_writeSwap(&(t->wt), t->DATA);
+}
+
+/* controller step */
+
+static void controllerStep(turbine *t) {
+    char message[1024];
+    ikDiscon_step(&(t->discon), t->DATA, 0, "", "", message);
+}
+
+/* plant half of a step: controller outputs from the swap array, and plant step */
+
+static void plantIn(turbine *t) {
+    double *sample = t->trace + NSIGNALS*t->step;
+    ikWtPlant_readSwap(&(t->wt), t->DATA);
+    sample[0] = t->wt.out.generatorSpeed;
+    sample[1] = t->DATA[46]*1.0e-3;
+    sample[2] = t->DATA[44];
+    ikWtPlant_step(&(t->wt));
+    t->step++;
+}
+
+static void sequential(void) {
+    long k;
+    int i;
+
+    for (k = 0; k < nSteps; k++) {
+        for (i = 0; i < nTurbines; i++) {
+            plantOut(turbines[i]);
+            controllerStep(turbines[i]);
+            plantIn(turbines[i]);
+        }
+    }
+}
+
+static void *plantThread(void *arg) {
+    int p = (int) (size_t) arg;
+    int remaining = 0;
+    void *item;
+    int c;
+    int i;
+
+    /* start every turbine of this thread */
+    for (i = p; i < nTurbines; i += nPlantThreads) {
+        plantOut(turbines[i]);
+        while (ikSpsc_push(&(toController[p][i % nControllerThreads]), turbines[i])) sched_yield();
+        remaining++;
+    }
+
+    /* step whichever turbine has its controller outputs back */
+    while (remaining > 0) {
+        int idle = 1;
+        for (c = 0; c < nControllerThreads; c++) {
+            while (!ikSpsc_pop(&(toPlant[c][p]), &item)) {
+                turbine *t = (turbine *) item;
+                idle = 0;
+                plantIn(t);
+                if (t->step < nSteps) {
+                    plantOut(t);
+                    while (ikSpsc_push(&(toController[p][c]), t)) sched_yield();
+                } else {
+                    remaining--;
+                }
+            }
+        }
+        if (idle) sched_yield();
+    }
+
+    return NULL;
+}
+
+static void *controllerThread(void *arg) {
+    int c = (int) (size_t) arg;
+    long remaining = 0;
+    void *item;
+    int p;
+    int i;
+
+    for (i = c; i < nTurbines; i += nControllerThreads) remaining += nSteps;
+
+    while (remaining > 0) {
+        int idle = 1;
+        for (p = 0; p < nPlantThreads; p++) {
+            while (!ikSpsc_pop(&(toController[p][c]), &item)) {
+                idle = 0;
+                controllerStep((turbine *) item);
+                while (ikSpsc_push(&(toPlant[c][p]), item)) sched_yield();
+                remaining--;
+            }
+        }
+        if (idle) sched_yield();
+    }
+
+    return NULL;
+}
+
+static void pipelined(void) {
+    pthread_t threads[2*MAXTHREADS];
+    ikSpscParams queueParams;
+    int nThreads = 0;
+    int err = 0;
+    int p, c;
+
+    /* each queue holds at most one frame per turbine */
+    ikSpsc_initParams(&queueParams);
+    queueParams.size = 2;
+    while (queueParams.size < nTurbines) queueParams.size *= 2;
+    for (p = 0; p < nPlantThreads; p++) {
+        for (c = 0; c < nControllerThreads; c++) {
+            ikSpsc_init(&(toController[p][c]), &queueParams);
+            ikSpsc_init(&(toPlant[c][p]), &queueParams);
+        }
+    }
+
+    for (c = 0; c < nControllerThreads && !err; c++) {
+        err = pthread_create(&(threads[nThreads]), NULL, controllerThread, (void *) (size_t) c);
+        if (!err) nThreads++;
+    }
+    for (p = 0; p < nPlantThreads && !err; p++) {
+        err = pthread_create(&(threads[nThreads]), NULL, plantThread, (void *) (size_t) p);
+        if (!err) nThreads++;
+    }
+    if (err) {
+        printf("cannot start the threads\n");
+        exit(1);
+    }
+    while (nThreads > 0) pthread_join(threads[--nThreads], NULL);
+}
+
+static void usage(void) {
+    printf("usage: cosim [-n TURBINES] [-t DURATION] [-p PLANTTHREADS] [-c CONTROLLERTHREADS] [-d DIR]\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *dir = ".";
+    double duration = 60.0;
+    double *traces[2];
+    double elapsed[2];
+    double startTime;
+    int run;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        if (!strcmp(argv[i], "-n")) nTurbines = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t")) duration = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-p")) nPlantThreads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-c")) nControllerThreads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-d")) dir = argv[++i];
+        else {
+            usage();
+            return 2;
+        }
+    }
+    nSteps = (long) (duration/SAMPLE_PERIOD + 0.5);
+    if (nTurbines < 1 || nTurbines > MAXTURBINES || nSteps < 2 || nPlantThreads < 1 || nPlantThreads > MAXTHREADS
+            || nControllerThreads < 1 || nControllerThreads > MAXTHREADS || strlen(dir) + 16 >= IKDISCON_MAXPREFIX) {
+        usage();
+        return 2;
+    }
+
+    /* the controller state is cache line aligned */
+    for (i = 0; i < nTurbines; i++) {
+        void *memory;
+        if (posix_memalign(&memory, IKLAYOUT_CACHELINE, sizeof(turbine))) return 1;
+        turbines[i] = (turbine *) memory;
+    }
+    for (run = 0; run < 2; run++) {
+        traces[run] = (double *) malloc(sizeof(double)*NSIGNALS*nSteps*nTurbines);
+        if (NULL == traces[run]) return 1;
+    }
+
+    for (run = 0; run < 2; run++) {
+        for (i = 0; i < nTurbines; i++) {
+            if (start(turbines[i], i, dir)) {
+                printf("cannot initialise turbine %d\n", i);
+                return 1;
+            }
+            turbines[i]->trace = traces[run] + NSIGNALS*nSteps*i;
+        }
+        startTime = now();
+        if (0 == run) sequential();
+        else pipelined();
+        elapsed[run] = now() - startTime;
+        for (i = 0; i < nTurbines; i++) ikWindGen_close(&(turbines[i]->wind));
+    }
+
+    printf("%d turbines, %ld steps\n", nTurbines, nSteps);
+    printf("sequential              %8.1f ns per turbine step\n", elapsed[0]/nSteps/nTurbines*1.0e9);
+    printf("pipelined, %2d+%-2d threads %8.1f ns per turbine step, %.2fx\n", nPlantThreads, nControllerThreads,
+            elapsed[1]/nSteps/nTurbines*1.0e9, elapsed[0]/elapsed[1]);
+
+    for (i = 0; i < nTurbines; i++) {
+        long k;
+        for (k = 0; k < NSIGNALS*nSteps; k++) {
+            if (traces[0][NSIGNALS*nSteps*i + k] != traces[1][NSIGNALS*nSteps*i + k]) break;
+        }
+        if (k < NSIGNALS*nSteps) {
+            printf("turbine %d: the pipelined run differs from the sequential one at t = %g s\n", i, k/NSIGNALS*SAMPLE_PERIOD);
+            return 1;
+        }
+    }
+    printf("identical results\n");
+
+    for (run = 0; run < 2; run++) free(traces[run]);
+    for (i = 0; i < nTurbines; i++) free(turbines[i]);
+    return 0;
+}
@@ -17,43 +17,18 @@ You should have received a copy of the GNU General Public License
 along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
 */
 
-#define NINT(a) ((a) >= 0.0 ? (int) ((a)+0.5) : ((a)-0.5))
-
-#include "ikClwindconWTConfig.h"
+#include "ikDiscon.h"
 #include "OpenDiscon_EXPORT.h"
-#include <stdio.h>
 
 void OpenDiscon_EXPORT DISCON(float *DATA, int FLAG, const char *INFILE, const char *OUTNAME, char *MESSAGE) {
-	int err;
-	static ikClwindconWTCon con;
-	double output = -12.0;
-	static FILE *f = NULL;
-	const double deratingRatio = 0.2; /* later to be got via the supercontroller interface */
-		
-	if (NINT(DATA[0]) == 0) {
-		ikClwindconWTConParams param;
-		ikClwindconWTCon_initParams(&param);
-		setParams(&param);
-		ikClwindconWTCon_init(&con, &param);
-		f = fopen("log.bin", "wb");
-	}
-//TODO lower maximum torque according to maximum power with derating (it may be time to bring the power manager back)
-	con.in.deratingRatio = deratingRatio;
-	con.in.externalMaximumTorque = 230.0; /* kNm */
-	con.in.externalMinimumTorque = 0.0; /* kNm */
-	con.in.externalMaximumPitch = 90.0; /* deg */
-	con.in.externalMinimumPitch = 0.0; /* deg */
-	con.in.generatorSpeed = (double) DATA[19]; /* rad/s */
-	con.in.maximumSpeed = 480.0/30*3.1416; /* rpm to rad/s */
-	
-	ikClwindconWTCon_step(&con);
-	
-	DATA[46] = (float) (con.out.torqueDemand*1.0e3); /* kNm to Nm */
-	DATA[41] = (float) (con.out.pitchDemandBlade1/180.0*3.1416); /* deg to rad */
-	DATA[42] = (float) (con.out.pitchDemandBlade2/180.0*3.1416); /* deg to rad */
-	DATA[43] = (float) (con.out.pitchDemandBlade3/180.0*3.1416); /* deg to rad */
-	DATA[44] = (float) (con.out.pitchDemandBlade1/180.0*3.1416); /* deg to rad (collective pitch angle) */
+	static ikDiscon discon;
+	static int initialised = 0;
 
-	err = ikClwindconWTCon_getOutput(&con, &output, "maximum torque");
-	fwrite(&(output), 1, sizeof(output), f);
-}	
+	if (!initialised) {
+		ikDisconParams params;
+		ikDiscon_initParams(&params);
+		ikDiscon_init(&discon, &params);
+		initialised = 1;
+	}
+	ikDiscon_step(&discon, DATA, FLAG, INFILE, OUTNAME, MESSAGE);
+}
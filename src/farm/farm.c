@@ -0,0 +1,681 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file farm.c
+ *
+ * @brief Sharded multi-process wind farm simulation
+ *
+ * Runs a farm of turbines, each an @link ikClwindconWTCon @endlink instance
+ * in closed loop with an @link ikWtPlant @endlink, split into shards, each
+ * stepped by a process of its own, in lockstep under a farm power controller
+ * that sets the derating ratio of every turbine. Usage:
+ * @li farm [-n TURBINES] [-s SHARDS] [-t DURATION] [-u WINDSPEED] [-P POWER] [-w WAKE] [-x TRANSPORT] [-o FILE]
+ *
+ * DURATION is in s, WINDSPEED in m/s and POWER, the farm power demand per
+ * turbine, in MW. The defaults are 1000 turbines, a shard per processor,
+ * 60 s, 14 m/s and 8 MW. Shard s owns turbines s*TURBINES/SHARDS to
+ * (s + 1)*TURBINES/SHARDS - 1. All turbines start from clones of a controller
+ * and a plant trimmed at WINDSPEED.
+ *
+ * The turbines stand on a square grid, in rows across the wind 7 rotor
+ * diameters apart, with 5 rotor diameters between neighbours in a row;
+ * turbine i stands in row i modulo the number of rows. They see the same
+ * turbulent wind series from @link ikWindGen @endlink, delayed by the time
+ * the mean wind takes to reach their row. With WAKE "jensen" or "gaussian",
+ * that wind is reduced by the deficit worked out by an @link ikWake @endlink
+ * model from the thrust coefficients of the turbines upwind, so that
+ * derating a turbine, which pitches its blades and lowers its thrust, gives
+ * more wind to those behind it. The default is "none", for no wakes.
+ *
+ * The main process is the farm coordinator. At every step k, it publishes
+ * the derating ratios and wake deficits of step k, one of each per turbine,
+ * and waits for every shard to have stepped its turbines and sent back
+ * their electrical power and thrust coefficients; from the farm power, an
+ * integral controller works out the derating ratio of step k + 1, and from
+ * the thrust coefficients, the wake model works out the deficits. The
+ * coordinator is thus the time-step barrier: no shard starts a step before
+ * all of them have finished the previous one.
+ *
+ * TRANSPORT carries this exchange. With "shm", the default, the farm inputs
+ * and the turbine outputs live in a region of memory shared by all the
+ * processes, and the barrier is a pair of counters in it, one of shard steps
+ * done, which the shards increment, and one of farm steps released, which
+ * the coordinator sets, each on a cache line of its own. With "socket", the
+ * shards connect to the coordinator over TCP on the loopback interface, send
+ * the outputs and receive the inputs of their turbines, as they
+ * would from other nodes; only the coordinator address would change. With
+ * "both", the farm is run over each and the tool fails unless the farm
+ * power is the same, bit for bit. The tool reports the time per farm step
+ * and per turbine step, and with -o, writes the farm power demand, farm
+ * power and derating ratio at every step to FILE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "ikClwindconWTConfig.h"
+#include "ikAtomic.h"
+#include "ikLayout.h"
+#include "ikWtPlant.h"
+#include "ikClosedLoop.h"
+#include "ikWindGen.h"
+#include "ikWake.h"
+
+#define PI 3.14159265358979
+#define SAMPLE_PERIOD 0.01 /* s */
+#define MAXTURBINES 100000
+#define MAXSHARDS 256
+#define ROTOR_DIAMETER 178.3 /* m, of the plant */
+#define ROW_SPACING 7.0 /* rotor diameters, down the wind */
+#define COLUMN_SPACING 5.0 /* rotor diameters, across the wind */
+#define FARM_TIME_CONSTANT 5.0 /* s, of the farm power controller */
+#define MAXIMUM_DERATING 0.5
+
+/* farm inputs and turbine outputs, interleaved by turbine */
+#define NINPUTS 2 /* derating ratio, wake deficit */
+#define NOUTPUTS 2 /* electrical power (W), thrust coefficient */
+
+typedef struct turbine {
+    ikClwindconWTCon con;
+    ikWtPlant wt;
+    long delay;
+} turbine;
+
+/* shared region: the barrier counters, the turbine outputs and the farm inputs */
+
+typedef struct region {
+    IKLAYOUT_ALIGNED ikAtomicInt arrivals; /* shard steps done, over all shards */
+    IKLAYOUT_ALIGNED ikAtomicInt released; /* farm steps whose inputs are published */
+    IKLAYOUT_ALIGNED ikAtomicInt failed;
+    IKLAYOUT_ALIGNED double outputs[MAXTURBINES*NOUTPUTS];
+    IKLAYOUT_ALIGNED double inputs[MAXTURBINES*NINPUTS];
+} region;
+
+/* a transport carries the farm inputs from the coordinator to the shards and
+   the turbine outputs back; step -1 tells the coordinator that the shards are
+   ready */
+
+typedef struct transport {
+    const char *name;
+    int (*open)(void); /* coordinator, before the shards start */
+    int (*attach)(int shard); /* shard */
+    int (*receive)(int shard, long k, double *inputs, int first, int n); /* shard, inputs of step k */
+    int (*send)(int shard, long k, const double *outputs, int first, int n); /* shard, outputs of step k */
+    int (*scatter)(long k, const double *inputs); /* coordinator, inputs of step k */
+    int (*gather)(long k, double *outputs); /* coordinator, outputs of step k of all shards */
+    void (*fail)(void); /* either side, to let the others go */
+    void (*close)(void);
+} transport;
+
+static int nTurbines = 1000;
+static int nShards;
+static long nSteps;
+static double windSpeed = 14.0; /* m/s */
+static double powerDemand = 8.0e6; /* W per turbine */
+static int wakeModel = -1; /* none */
+
+/* turbine positions, down and across the wind, in m, and the wind delay of the last row, in samples */
+static double positionX[MAXTURBINES];
+static double positionY[MAXTURBINES];
+static long maximumDelay;
+
+static ikClwindconWTConParams param;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9*ts.tv_nsec;
+}
+
+static int firstTurbine(int shard) {
+    return (int) ((long) shard*nTurbines/nShards);
+}
+
+/* a square grid, filled a column down the wind at a time, so that the shards own whole columns */
+
+static void layout(void) {
+    int nRows = 1;
+    int i;
+
+    while ((long) nRows*nRows < nTurbines) nRows++;
+    for (i = 0; i < nTurbines; i++) {
+        positionX[i] = (i % nRows)*ROW_SPACING*ROTOR_DIAMETER;
+        positionY[i] = (i/nRows)*COLUMN_SPACING*ROTOR_DIAMETER;
+    }
+    maximumDelay = (long) ((nRows - 1)*ROW_SPACING*ROTOR_DIAMETER/windSpeed/SAMPLE_PERIOD + 0.5);
+}
+
+/* wait, spinning a little and then giving up the processor, since there may
+   be more processes than processors */
+
+static int waitFor(const ikAtomicInt *counter, long k, const ikAtomicInt *failed) {
+    int spins = 0;
+
+    while (ikAtomic_load(counter) < k) {
+        if (ikAtomic_load(failed)) return -1;
+        if (++spins > 100) sched_yield();
+    }
+    return 0;
+}
+
+/* shared memory transport */
+
+static region *shared;
+
+static int shmOpen(void) {
+    void *memory = mmap(NULL, sizeof(region), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (MAP_FAILED == memory) return -1;
+    shared = (region *) memory;
+    shared->arrivals = 0;
+    shared->released = 0;
+    shared->failed = 0;
+    return 0;
+}
+
+static int shmAttach(int shard) {
+    (void) shard;
+    return 0;
+}
+
+static int shmReceive(int shard, long k, double *inputs, int first, int n) {
+    (void) shard;
+    if (waitFor(&(shared->released), k + 1, &(shared->failed))) return -1;
+    memcpy(inputs, shared->inputs + first*NINPUTS, n*NINPUTS*sizeof(double));
+    return 0;
+}
+
+static int shmSend(int shard, long k, const double *outputs, int first, int n) {
+    (void) shard;
+    (void) k;
+    memcpy(shared->outputs + first*NOUTPUTS, outputs, n*NOUTPUTS*sizeof(double));
+    ikAtomic_fetchAdd(&(shared->arrivals), 1);
+    return 0;
+}
+
+static int shmScatter(long k, const double *inputs) {
+    memcpy(shared->inputs, inputs, nTurbines*NINPUTS*sizeof(double));
+    ikAtomic_store(&(shared->released), k + 1);
+    return 0;
+}
+
+static int shmGather(long k, double *outputs) {
+    if (waitFor(&(shared->arrivals), (k + 2)*nShards, &(shared->failed))) return -1;
+    memcpy(outputs, shared->outputs, nTurbines*NOUTPUTS*sizeof(double));
+    return 0;
+}
+
+static void shmFail(void) {
+    ikAtomic_store(&(shared->failed), 1);
+}
+
+static void shmClose(void) {
+    if (NULL != shared) munmap(shared, sizeof(region));
+    shared = NULL;
+}
+
+static const transport shmTransport = {"shm", shmOpen, shmAttach, shmReceive, shmSend, shmScatter, shmGather, shmFail, shmClose};
+
+/* loopback socket transport */
+
+static int listener = -1;
+static struct sockaddr_in coordinator;
+static int links[MAXSHARDS];
+
+static int sendAll(int fd, const void *data, size_t n) {
+    const char *p = (const char *) data;
+
+    while (n > 0) {
+        ssize_t m = send(fd, p, n, 0);
+        if (m <= 0) return -1;
+        p += m;
+        n -= (size_t) m;
+    }
+    return 0;
+}
+
+static int receiveAll(int fd, void *data, size_t n) {
+    char *p = (char *) data;
+
+    while (n > 0) {
+        ssize_t m = recv(fd, p, n, 0);
+        if (m <= 0) return -1;
+        p += m;
+        n -= (size_t) m;
+    }
+    return 0;
+}
+
+static void noDelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+static int socketOpen(void) {
+    socklen_t length = sizeof(coordinator);
+    int s;
+
+    for (s = 0; s < MAXSHARDS; s++) links[s] = -1;
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return -1;
+    memset(&coordinator, 0, sizeof(coordinator));
+    coordinator.sin_family = AF_INET;
+    coordinator.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    coordinator.sin_port = 0; /* any free port */
+    if (bind(listener, (struct sockaddr *) &coordinator, sizeof(coordinator))
+            || listen(listener, MAXSHARDS)
+            || getsockname(listener, (struct sockaddr *) &coordinator, &length)) return -1;
+    return 0;
+}
+
+static int socketAttach(int shard) {
+    int fd;
+
+    close(listener);
+    listener = -1;
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *) &coordinator, sizeof(coordinator))) {
+        close(fd);
+        return -1;
+    }
+    noDelay(fd);
+    links[shard] = fd;
+    return sendAll(fd, &shard, sizeof(shard));
+}
+
+static int socketReceive(int shard, long k, double *inputs, int first, int n) {
+    long step;
+
+    (void) first;
+    if (receiveAll(links[shard], &step, sizeof(step)) || step != k) return -1;
+    return receiveAll(links[shard], inputs, n*NINPUTS*sizeof(double));
+}
+
+static int socketSend(int shard, long k, const double *outputs, int first, int n) {
+    (void) first;
+    if (sendAll(links[shard], &k, sizeof(k))) return -1;
+    return sendAll(links[shard], outputs, n*NOUTPUTS*sizeof(double));
+}
+
+static int socketScatter(long k, const double *inputs) {
+    int s;
+
+    for (s = 0; s < nShards; s++) {
+        int first = firstTurbine(s);
+        if (sendAll(links[s], &k, sizeof(k))
+                || sendAll(links[s], inputs + first*NINPUTS, (firstTurbine(s + 1) - first)*NINPUTS*sizeof(double))) return -1;
+    }
+    return 0;
+}
+
+static int socketGather(long k, double *outputs) {
+    long step;
+    int s;
+
+    /* the shards connect at step -1, in any order, and say which they are */
+    if (k < 0) {
+        for (s = 0; s < nShards; s++) {
+            int fd = accept(listener, NULL, NULL);
+            int shard;
+            if (fd < 0) return -1;
+            noDelay(fd);
+            if (receiveAll(fd, &shard, sizeof(shard)) || shard < 0 || shard >= nShards || links[shard] >= 0) {
+                close(fd);
+                return -1;
+            }
+            links[shard] = fd;
+        }
+    }
+    for (s = 0; s < nShards; s++) {
+        int first = firstTurbine(s);
+        if (receiveAll(links[s], &step, sizeof(step)) || step != k
+                || receiveAll(links[s], outputs + first*NOUTPUTS, (firstTurbine(s + 1) - first)*NOUTPUTS*sizeof(double))) return -1;
+    }
+    return 0;
+}
+
+static void socketFail(void) {
+    /* the others see the connections close */
+}
+
+static void socketClose(void) {
+    int s;
+
+    for (s = 0; s < MAXSHARDS; s++) {
+        if (links[s] >= 0) close(links[s]);
+        links[s] = -1;
+    }
+    if (listener >= 0) close(listener);
+    listener = -1;
+}
+
+static const transport socketTransport = {"socket", socketOpen, socketAttach, socketReceive, socketSend, socketScatter, socketGather, socketFail, socketClose};
+
+/* turbines */
+
+/* start at the steady operating point of the control law at the mean wind speed */
+
+static int trim(ikClwindconWTCon *con, ikWtPlant *wt) {
+    ikWtPlantParams plantParams;
+
+    ikWtPlant_initParams(&plantParams);
+    plantParams.samplePeriod = SAMPLE_PERIOD;
+    if (ikClwindconWTCon_init(con, &param) || ikWtPlant_init(wt, &plantParams)) return -1;
+
+    ikClosedLoop_setInputs(&(con->in), 0.0, 0.0);
+    return ikClosedLoop_trim(con, wt, &param, windSpeed, IKCLOSEDLOOP_TRIMSTEPS) ? -1 : 0;
+}
+
+/* a shard process: set up its turbines, then step them as the coordinator says */
+
+static int runShard(const transport *tr, int shard) {
+    const int first = firstTurbine(shard);
+    const int n = firstTurbine(shard + 1) - first;
+    ikWindGenParams windParams;
+    ikWindGen wind;
+    double *history;
+    long historyMask = 1;
+    ikClwindconWTCon original;
+    ikWtPlant trimmed;
+    turbine *turbines;
+    void *memory;
+    double *inputs;
+    double *outputs;
+    long k;
+    int i;
+
+    if (tr->attach(shard)) return 1;
+    while (historyMask <= maximumDelay) historyMask *= 2;
+    historyMask--;
+    /* the controller state is cache line aligned */
+    if (posix_memalign(&memory, IKLAYOUT_CACHELINE, (n > 0 ? n : 1)*sizeof(turbine))) memory = NULL;
+    turbines = (turbine *) memory;
+    inputs = (double *) malloc((n > 0 ? n : 1)*NINPUTS*sizeof(double));
+    outputs = (double *) malloc((n > 0 ? n : 1)*NOUTPUTS*sizeof(double));
+    history = (double *) malloc((historyMask + 1)*sizeof(double));
+    if (NULL == turbines || NULL == inputs || NULL == outputs || NULL == history || trim(&original, &trimmed)) return 1;
+
+    /* every shard synthesises the same wind series, and keeps enough of it for the last row */
+    ikWindGen_initParams(&windParams);
+    windParams.meanSpeed = windSpeed;
+    windParams.samplePeriod = SAMPLE_PERIOD;
+    if (ikWindGen_init(&wind, &windParams)) return 1;
+    ikWindGen_read(&wind, history, maximumDelay);
+
+    for (i = 0; i < n; i++) {
+        turbine *t = &(turbines[i]);
+        if (ikClwindconWTCon_clone(&(t->con), &original) && trim(&(t->con), &(t->wt))) return 1;
+        memcpy(&(t->wt), &trimmed, sizeof(ikWtPlant));
+        t->delay = (long) (positionX[first + i]/windSpeed/SAMPLE_PERIOD + 0.5);
+        outputs[i*NOUTPUTS] = t->wt.out.electricalPower;
+        ikWtPlant_getOutput(&(t->wt), &(outputs[i*NOUTPUTS + 1]), "thrust coefficient");
+    }
+    if (tr->send(shard, -1, outputs, first, n)) return 1;
+
+    for (k = 0; k < nSteps; k++) {
+        const long newest = k + maximumDelay;
+
+        if (tr->receive(shard, k, inputs, first, n)) return 1;
+        history[newest & historyMask] = ikWindGen_step(&wind);
+        for (i = 0; i < n; i++) {
+            turbine *t = &(turbines[i]);
+            ikClosedLoop_setInputs(&(t->con.in), inputs[i*NINPUTS], t->wt.out.generatorSpeed);
+            ikClwindconWTCon_step(&(t->con));
+            t->wt.in.windSpeed = history[(newest - t->delay) & historyMask]*(1.0 - inputs[i*NINPUTS + 1]);
+            t->wt.in.torqueDemand = t->con.out.torqueDemand*1.0e3; /* kNm to Nm */
+            t->wt.in.pitchDemand[0] = t->con.out.pitchDemandBlade1/180.0*PI; /* deg to rad */
+            t->wt.in.pitchDemand[1] = t->con.out.pitchDemandBlade2/180.0*PI; /* deg to rad */
+            t->wt.in.pitchDemand[2] = t->con.out.pitchDemandBlade3/180.0*PI; /* deg to rad */
+            ikWtPlant_step(&(t->wt));
+            outputs[i*NOUTPUTS] = t->wt.out.electricalPower;
+            ikWtPlant_getOutput(&(t->wt), &(outputs[i*NOUTPUTS + 1]), "thrust coefficient");
+        }
+        if (tr->send(shard, k, outputs, first, n)) return 1;
+    }
+
+    ikWindGen_close(&wind);
+    free(turbines);
+    free(inputs);
+    free(outputs);
+    free(history);
+    return 0;
+}
+
+/* the coordinator: run the farm over a transport, tracing the farm power and derating ratio */
+
+static int runFarm(const transport *tr, double *farmPower, double *farmDerating) {
+    static double inputs[MAXTURBINES*NINPUTS];
+    static double outputs[MAXTURBINES*NOUTPUTS];
+    static double thrustCoefficient[MAXTURBINES];
+    static double deficit[MAXTURBINES];
+    const double demand = powerDemand*nTurbines;
+    pid_t pids[MAXSHARDS];
+    ikWakeParams wakeParams;
+    ikWake wake;
+    double derating = 0.0;
+    double start = 0.0, elapsed;
+    double wakeTime = 0.0;
+    double pairs = 0.0;
+    int ok = 1;
+    long k;
+    int s, i;
+
+    for (i = 0; i < nTurbines; i++) deficit[i] = 0.0;
+    if (wakeModel >= 0) {
+        ikWake_initParams(&wakeParams);
+        wakeParams.nTurbines = nTurbines;
+        wakeParams.x = positionX;
+        wakeParams.y = positionY;
+        wakeParams.model = wakeModel;
+        wakeParams.rotorDiameter = ROTOR_DIAMETER;
+        if (ikWake_init(&wake, &wakeParams)) {
+            printf("cannot set up the wake model\n");
+            return -1;
+        }
+        ikWake_getOutput(&wake, &pairs, "pairs");
+    }
+    if (tr->open()) {
+        printf("cannot open the %s transport\n", tr->name);
+        if (wakeModel >= 0) ikWake_close(&wake);
+        return -1;
+    }
+    for (s = 0; s < nShards; s++) {
+        pids[s] = fork();
+        if (0 == pids[s]) {
+            if (runShard(tr, s)) {
+                tr->fail();
+                _exit(1);
+            }
+            _exit(0);
+        }
+        if (pids[s] < 0) {
+            printf("cannot start the shards\n");
+            nShards = s;
+            ok = 0;
+            break;
+        }
+    }
+
+    if (ok && tr->gather(-1, outputs)) ok = 0;
+    start = now();
+    for (k = 0; ok && k < nSteps; k++) {
+        double total = 0.0;
+
+        /* wakes of the thrust of the previous step, or of the trimmed turbines at the first */
+        if (wakeModel >= 0) {
+            const double wakeStart = now();
+            for (i = 0; i < nTurbines; i++) thrustCoefficient[i] = outputs[i*NOUTPUTS + 1];
+            ikWake_step(&wake, thrustCoefficient, deficit);
+            wakeTime += now() - wakeStart;
+        }
+        for (i = 0; i < nTurbines; i++) {
+            inputs[i*NINPUTS] = derating;
+            inputs[i*NINPUTS + 1] = deficit[i];
+        }
+        if (tr->scatter(k, inputs) || tr->gather(k, outputs)) {
+            ok = 0;
+            break;
+        }
+        for (i = 0; i < nTurbines; i++) total += outputs[i*NOUTPUTS];
+        farmPower[k] = total;
+        farmDerating[k] = derating;
+
+        /* integral farm power control, within the derating range of the turbines */
+        derating += SAMPLE_PERIOD/FARM_TIME_CONSTANT*(total - demand)/demand;
+        if (derating < 0.0) derating = 0.0;
+        if (derating > MAXIMUM_DERATING) derating = MAXIMUM_DERATING;
+    }
+    elapsed = now() - start;
+
+    /* a failed coordinator lets the shards go */
+    if (!ok) tr->fail();
+    tr->close();
+    if (wakeModel >= 0) ikWake_close(&wake);
+    for (s = 0; s < nShards; s++) {
+        int status;
+        if (waitpid(pids[s], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) ok = 0;
+    }
+    if (!ok) {
+        printf("the farm failed over the %s transport\n", tr->name);
+        return -1;
+    }
+
+    printf("%-8s %d turbines on %d shards, %.0f s simulated in %.2f s: %.1f us per farm step, %.0f ns per turbine step\n",
+            tr->name, nTurbines, nShards, nSteps*SAMPLE_PERIOD, elapsed,
+            elapsed/nSteps*1.0e6, elapsed/nSteps/nTurbines*1.0e9);
+    if (wakeModel >= 0) printf("%-8s wake model over %.0f pairs of turbines, %.1f us per farm step\n", tr->name, pairs, wakeTime/nSteps*1.0e6);
+    return 0;
+}
+
+static void usage(void) {
+    printf("usage: farm [-n TURBINES] [-s SHARDS] [-t DURATION] [-u WINDSPEED] [-P POWER] [-w none|jensen|gaussian] [-x shm|socket|both] [-o FILE]\n");
+}
+
+int main(int argc, char *argv[]) {
+    long nProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *mode = "shm";
+    const char *wake = "none";
+    const char *fileName = NULL;
+    double duration = 60.0; /* s */
+    double *farmPower[2];
+    double *farmDerating[2];
+    const transport *transports[2];
+    int nTransports;
+    double average = 0.0;
+    long k;
+    int i;
+
+    nShards = nProcessors > 0 ? (nProcessors < MAXSHARDS ? (int) nProcessors : MAXSHARDS) : 1;
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) nTurbines = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) nShards = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) duration = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-u") && i + 1 < argc) windSpeed = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-P") && i + 1 < argc) powerDemand = atof(argv[++i])*1.0e6;
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc) wake = argv[++i];
+        else if (!strcmp(argv[i], "-x") && i + 1 < argc) mode = argv[++i];
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) fileName = argv[++i];
+        else {
+            usage();
+            return 2;
+        }
+    }
+    nSteps = (long) (duration/SAMPLE_PERIOD + 0.5);
+    if (nTurbines < 1 || nTurbines > MAXTURBINES || nShards < 1 || nShards > MAXSHARDS || nShards > nTurbines
+            || nSteps < 1 || windSpeed <= 0.0 || powerDemand <= 0.0) {
+        usage();
+        return 2;
+    }
+    if (!strcmp(wake, "jensen")) {
+        wakeModel = IKWAKE_JENSEN;
+    } else if (!strcmp(wake, "gaussian")) {
+        wakeModel = IKWAKE_GAUSSIAN;
+    } else if (strcmp(wake, "none")) {
+        usage();
+        return 2;
+    }
+    if (!strcmp(mode, "shm")) {
+        transports[0] = &shmTransport;
+        nTransports = 1;
+    } else if (!strcmp(mode, "socket")) {
+        transports[0] = &socketTransport;
+        nTransports = 1;
+    } else if (!strcmp(mode, "both")) {
+        transports[0] = &shmTransport;
+        transports[1] = &socketTransport;
+        nTransports = 2;
+    } else {
+        usage();
+        return 2;
+    }
+
+    ikClwindconWTCon_initParams(&param);
+    setParams(&param);
+    layout();
+    for (i = 0; i < nTransports; i++) {
+        farmPower[i] = (double *) malloc(nSteps*sizeof(double));
+        farmDerating[i] = (double *) malloc(nSteps*sizeof(double));
+        if (NULL == farmPower[i] || NULL == farmDerating[i]) {
+            printf("out of memory\n");
+            return 1;
+        }
+        if (runFarm(transports[i], farmPower[i], farmDerating[i])) return 1;
+    }
+
+    for (k = nSteps/2; k < nSteps; k++) average += farmPower[0][k];
+    average /= nSteps - nSteps/2;
+    printf("farm power %.3f MW over the second half, for a demand of %.3f MW, derating ratio %.4f at the end\n",
+            average*1.0e-6, powerDemand*nTurbines*1.0e-6, farmDerating[0][nSteps - 1]);
+    if (2 == nTransports) {
+        if (memcmp(farmPower[0], farmPower[1], nSteps*sizeof(double))) {
+            printf("the transports give different results\n");
+            return 1;
+        }
+        printf("the transports give the same results\n");
+    }
+
+    if (NULL != fileName) {
+        FILE *f = fopen(fileName, "w");
+        if (NULL == f) {
+            printf("cannot write %s\n", fileName);
+            return 1;
+        }
+        fprintf(f, "# time (s)\tfarm power demand (MW)\tfarm power (MW)\tderating ratio (-)\n");
+        for (k = 0; k < nSteps; k++) {
+            fprintf(f, "%.2f\t%.6f\t%.6f\t%.6f\n", k*SAMPLE_PERIOD, powerDemand*nTurbines*1.0e-6, farmPower[0][k]*1.0e-6, farmDerating[0][k]);
+        }
+        if (fclose(f)) {
+            printf("cannot write %s\n", fileName);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,432 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file hilrt.c
+ *
+ * @brief Real-time execution harness for hardware-in-the-loop runs
+ *
+ * Runs the controller behind DISCON, an @link ikDiscon @endlink instance, as
+ * a periodic real-time task on Linux, exchanging swap arrays through shared
+ * memory with a plant, and reports how long the task takes to wake up and to
+ * run, and so how much of the period it leaves. Usage:
+ * @li hilrt [-m MODE] [-t DURATION] [-p PERIOD] [-c CPU] [-r PRIORITY] [-u WINDSPEED] [-s NAME] [-o FILE]
+ *
+ * MODE is "both", the default, to run the controller and fork a plant
+ * stand-in, an @link ikWtPlant @endlink in turbulent wind from
+ * @link ikWindGen @endlink of mean speed WINDSPEED, default 14 m/s;
+ * "controller" to run the controller only; or "plant" to run the plant
+ * stand-in only, for a controller started before. DURATION is in s, default
+ * 60 s, and PERIOD in ms, default 10 ms. NAME is the name of the shared
+ * memory object, default "/opendiscon_hilrt". The controller runs without
+ * the DISCON recorders, the log, event recorder, fatigue counters and
+ * statistics, whose file I/O would otherwise be timed as part of the step
+ * and could block the task; it is the controller step that is timed.
+ *
+ * The controller task is pinned to CPU, if given, which should be isolated
+ * from the scheduler, for instance with isolcpus, and run under SCHED_FIFO at
+ * PRIORITY, default 80, with its memory locked and its stack prefaulted, so
+ * that neither page faults nor other tasks get in its way. Failing any of
+ * this, for instance for lack of privileges, it runs anyway and says so.
+ * Each period starts at an absolute time, with clock_nanosleep on
+ * CLOCK_MONOTONIC, so that the periods do not drift with the time taken by
+ * the steps. At the start of period k, the task takes the plant outputs of
+ * step k from shared memory, runs the controller and gives back its outputs;
+ * the plant, on its own, waits for them, steps and writes the plant outputs
+ * of step k + 1.
+ *
+ * The tool reports the distributions of the wake-up latency, the time from
+ * the start of the period to the task running, the execution time, the time
+ * taken by the controller step, and the response time, their sum, for the
+ * regular calls; the first call, which initialises the controller, and the
+ * last are reported apart. The headroom is the period less the worst response
+ * time. A period is missed when the response time exceeds it, and the next
+ * one then starts late, without skipping any step. With -o, the histograms,
+ * in 1 us bins, are written to FILE.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "ikDiscon.h"
+#include "ikAtomic.h"
+#include "ikLayout.h"
+#include "ikWtPlant.h"
+#include "ikWindGen.h"
+
+#define SWAP_SIZE 128
+#define STACK_PREFAULT (512*1024) /* bytes */
+#define HISTOGRAM_BINS 20000 /* 1 us bins, the last one counting anything longer */
+
+/* shared memory: the plant writes the plant outputs of a step and publishes
+   its number in request, and the controller writes the controller outputs
+   and publishes the step number in reply */
+
+typedef struct exchange {
+    IKLAYOUT_ALIGNED long request;
+    IKLAYOUT_ALIGNED long reply;
+    long nSteps;
+    double period;
+    float DATA[SWAP_SIZE];
+} exchange;
+
+typedef struct distribution {
+    long counts[HISTOGRAM_BINS];
+    long n;
+    double sum;
+    double min;
+    double max;
+} distribution;
+
+static distribution latency;
+static distribution execution;
+static distribution response;
+
+static ikDiscon discon;
+
+static double elapsed(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec)*1.0e6 + (to->tv_nsec - from->tv_nsec)*1.0e-3;
+}
+
+static void addNanoseconds(struct timespec *ts, long ns) {
+    ts->tv_nsec += ns;
+    while (ts->tv_nsec >= 1000000000L) {
+        ts->tv_nsec -= 1000000000L;
+        ts->tv_sec++;
+    }
+}
+
+static void record(distribution *d, double us) {
+    int bin = (int) us;
+
+    if (bin < 0) bin = 0;
+    if (bin >= HISTOGRAM_BINS) bin = HISTOGRAM_BINS - 1;
+    d->counts[bin]++;
+    if (0 == d->n || us < d->min) d->min = us;
+    if (0 == d->n || us > d->max) d->max = us;
+    d->n++;
+    d->sum += us;
+}
+
+static double percentile(const distribution *d, double p) {
+    long target = (long) (p*d->n);
+    long count = 0;
+    int i;
+
+    for (i = 0; i < HISTOGRAM_BINS - 1; i++) {
+        count += d->counts[i];
+        if (count > target) return i + 1.0;
+    }
+    return d->max;
+}
+
+static void report(const char *label, const distribution *d) {
+    if (0 == d->n) return;
+    printf("%-16s %9.1f %9.1f %9.0f %9.0f %9.0f %9.0f %9.1f\n", label, d->min, d->sum/d->n,
+            percentile(d, 0.5), percentile(d, 0.99), percentile(d, 0.999), percentile(d, 0.9999), d->max);
+}
+
+/* keep the task off page faults: lock the memory and touch the stack it will use */
+
+static void prefaultStack(void) {
+    volatile unsigned char stack[STACK_PREFAULT];
+    size_t i;
+
+    for (i = 0; i < sizeof(stack); i += 4096) stack[i] = 0;
+}
+
+static int goRealTime(int cpu, int priority) {
+    struct sched_param sp;
+    int ok = 1;
+
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set)) {
+            printf("cannot pin to CPU %d: %s\n", cpu, strerror(errno));
+            ok = 0;
+        }
+    }
+    sp.sched_priority = priority;
+    if (sched_setscheduler(0, SCHED_FIFO, &sp)) {
+        printf("cannot run under SCHED_FIFO: %s\n", strerror(errno));
+        ok = 0;
+    }
+    if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+        printf("cannot lock the memory: %s\n", strerror(errno));
+        ok = 0;
+    }
+    prefaultStack();
+
+    return ok;
+}
+
+/* wait with short sleeps, so that a plant on the same CPU gets to run */
+
+static void waitFor(const long *counter, long k) {
+    struct timespec pause;
+
+    pause.tv_sec = 0;
+    pause.tv_nsec = 10000;
+    while (ikAtomic_load(counter) < k) nanosleep(&pause, NULL);
+}
+
+static exchange *attach(const char *name, int create) {
+    void *memory;
+    int fd;
+
+    fd = shm_open(name, create ? O_CREAT | O_RDWR : O_RDWR, 0600);
+    if (fd < 0) return NULL;
+    if (create && ftruncate(fd, sizeof(exchange))) {
+        close(fd);
+        return NULL;
+    }
+    memory = mmap(NULL, sizeof(exchange), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return MAP_FAILED == memory ? NULL : (exchange *) memory;
+}
+
+/* plant stand-in: plant outputs of step k, then controller outputs of step k */
+
+static int runPlant(exchange *x, double windSpeed) {
+    ikWtPlantParams plantParams;
+    ikWindGenParams windParams;
+    ikWtPlant wt;
+    ikWindGen wind;
+    long nSteps;
+    long k;
+
+    /* wait for the controller to set up the exchange */
+    while (ikAtomic_load(&(x->nSteps)) <= 0) usleep(1000);
+    nSteps = x->nSteps;
+
+    ikWtPlant_initParams(&plantParams);
+    plantParams.samplePeriod = x->period;
+    if (ikWtPlant_init(&wt, &plantParams)) return 1;
+    ikWindGen_initParams(&windParams);
+    windParams.meanSpeed = windSpeed;
+    windParams.samplePeriod = x->period;
+    if (ikWindGen_init(&wind, &windParams)) return 1;
+
+    for (k = 0; k < nSteps; k++) {
+        wt.in.windSpeed = ikWindGen_step(&wind);
+        x->DATA[0] = (float) (0 == k ? 0 : (nSteps - 1 == k ? -1 : 1));
+        ikWtPlant_writeSwap(&wt, x->DATA);
+        ikAtomic_store(&(x->request), k);
+        while (ikAtomic_load(&(x->reply)) < k) sched_yield();
+        ikWtPlant_readSwap(&wt, x->DATA);
+        ikWtPlant_step(&wt);
+    }
+
+    ikWindGen_close(&wind);
+    return 0;
+}
+
+/* controller task */
+
+static int runController(exchange *x, long nSteps, double period, int cpu, int priority) {
+    ikDisconParams disconParams;
+    char message[1024];
+    float DATA[SWAP_SIZE];
+    struct timespec release, wake, done;
+    const long periodNs = (long) (period*1.0e9 + 0.5);
+    double firstCall = 0.0;
+    double lastCall = 0.0;
+    long misses = 0;
+    long lateFrames = 0;
+    int realTime;
+    long k;
+
+    /* the recorders stay off, as their file I/O has no place in the period */
+    ikDiscon_initParams(&disconParams);
+    disconParams.fullLog = 0;
+    if (ikDiscon_init(&discon, &disconParams)) return 1;
+
+    realTime = goRealTime(cpu, priority);
+
+    /* start the clock with the first plant outputs in */
+    waitFor(&(x->request), 0);
+    clock_gettime(CLOCK_MONOTONIC, &release);
+
+    for (k = 0; k < nSteps; k++) {
+        double us;
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &release, NULL) == EINTR);
+        clock_gettime(CLOCK_MONOTONIC, &wake);
+
+        /* a plant late with its outputs is waited for, and counted */
+        if (ikAtomic_load(&(x->request)) < k) {
+            lateFrames++;
+            waitFor(&(x->request), k);
+        }
+        memcpy(DATA, x->DATA, sizeof(DATA));
+        ikDiscon_step(&discon, DATA, 0, "", "", message);
+        memcpy(x->DATA, DATA, sizeof(DATA));
+        ikAtomic_store(&(x->reply), k);
+        clock_gettime(CLOCK_MONOTONIC, &done);
+
+        us = elapsed(&release, &done);
+        if (us > period*1.0e6) misses++;
+        if (0 == k) {
+            firstCall = elapsed(&wake, &done);
+        } else if (nSteps - 1 == k) {
+            lastCall = elapsed(&wake, &done);
+        } else {
+            record(&latency, elapsed(&release, &wake));
+            record(&execution, elapsed(&wake, &done));
+            record(&response, us);
+        }
+        addNanoseconds(&release, periodNs);
+    }
+
+    printf("%ld steps of %.3f ms, %s", nSteps, period*1.0e3, realTime ? "SCHED_FIFO" : "not real-time");
+    if (realTime) printf(" at priority %d", priority);
+    if (cpu >= 0) printf(" on CPU %d", cpu);
+    printf("\n\n%-16s %9s %9s %9s %9s %9s %9s %9s\n", "us", "min", "mean", "p50", "p99", "p99.9", "p99.99", "max");
+    report("wake-up latency", &latency);
+    report("execution time", &execution);
+    report("response time", &response);
+    printf("\nfirst call %.1f us, last call %.1f us\n", firstCall, lastCall);
+    printf("missed periods %ld, late plant outputs %ld\n", misses, lateFrames);
+    printf("headroom %.1f us, %.1f%% of the period\n", period*1.0e6 - response.max, 100.0 - response.max/(period*1.0e4));
+
+    return 0;
+}
+
+static int writeHistograms(const char *fileName) {
+    FILE *f = fopen(fileName, "w");
+    int i;
+
+    if (NULL == f) return -1;
+    fprintf(f, "us\twake-up latency\texecution time\tresponse time\n");
+    for (i = 0; i < HISTOGRAM_BINS; i++) {
+        if (latency.counts[i] || execution.counts[i] || response.counts[i]) {
+            fprintf(f, "%d\t%ld\t%ld\t%ld\n", i, latency.counts[i], execution.counts[i], response.counts[i]);
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static void usage(void) {
+    printf("usage: hilrt [-m MODE] [-t DURATION] [-p PERIOD] [-c CPU] [-r PRIORITY] [-u WINDSPEED] [-s NAME] [-o FILE]\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *mode = "both";
+    const char *name = "/opendiscon_hilrt";
+    const char *histogramFile = NULL;
+    double duration = 60.0;
+    double period = 10.0;
+    double windSpeed = 14.0;
+    int cpu = -1;
+    int priority = 80;
+    long nSteps;
+    exchange *x;
+    pid_t plant = 0;
+    int err;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        if (!strcmp(argv[i], "-m")) mode = argv[++i];
+        else if (!strcmp(argv[i], "-t")) duration = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-p")) period = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-c")) cpu = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r")) priority = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-u")) windSpeed = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-s")) name = argv[++i];
+        else if (!strcmp(argv[i], "-o")) histogramFile = argv[++i];
+        else {
+            usage();
+            return 2;
+        }
+    }
+    period *= 1.0e-3;
+    nSteps = period > 0.0 ? (long) (duration/period + 0.5) : 0;
+    if ((strcmp(mode, "both") && strcmp(mode, "controller") && strcmp(mode, "plant")) || nSteps < 2
+            || priority < sched_get_priority_min(SCHED_FIFO) || priority > sched_get_priority_max(SCHED_FIFO)) {
+        usage();
+        return 2;
+    }
+
+    /* the plant only attaches to the exchange set up by the controller */
+    if (!strcmp(mode, "plant")) {
+        x = attach(name, 0);
+        if (NULL == x) {
+            printf("cannot attach to %s, start the controller first\n", name);
+            return 1;
+        }
+        return runPlant(x, windSpeed);
+    }
+
+    x = attach(name, 1);
+    if (NULL == x) {
+        printf("cannot create %s: %s\n", name, strerror(errno));
+        return 1;
+    }
+    memset(x, 0, sizeof(exchange));
+    x->request = -1;
+    x->reply = -1;
+    x->period = period;
+    ikAtomic_store(&(x->nSteps), nSteps);
+
+    if (!strcmp(mode, "both")) {
+        plant = fork();
+        if (plant < 0) {
+            printf("cannot start the plant\n");
+            shm_unlink(name);
+            return 1;
+        }
+        if (0 == plant) _exit(runPlant(x, windSpeed));
+    }
+
+    err = runController(x, nSteps, period, cpu, priority);
+    if (plant > 0) {
+        if (err) kill(plant, SIGTERM);
+        waitpid(plant, NULL, 0);
+    }
+    munmap(x, sizeof(exchange));
+    shm_unlink(name);
+    if (err) {
+        printf("cannot initialise the controller\n");
+        return 1;
+    }
+
+    if (NULL != histogramFile && writeHistograms(histogramFile)) {
+        printf("cannot write %s\n", histogramFile);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikAtomic.h
+ *
+ * @brief Atomic operations on integers shared between threads
+ *
+ * A minimal, portable set of atomic operations on @link ikAtomicInt @endlink,
+ * mapped onto the GCC/Clang __atomic builtins or the MSVC Interlocked
+ * functions:
+ * @li ikAtomic_load(p): read *p, with acquire semantics
+ * @li ikAtomic_store(p, v): write v to *p, with release semantics
+ * @li ikAtomic_exchange(p, v): write v to *p and return its previous value, as a full barrier
+ * @li ikAtomic_compareExchange(p, e, d): if *p is e, write d to it and return non-zero, otherwise return 0, as a full barrier
+ * @li ikAtomic_fetchAdd(p, v): add v to *p and return its previous value, as a full barrier
+ * @li ikAtomic_fence(): full memory barrier
+ */
+
+#ifndef IKATOMIC_H
+#define IKATOMIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_MSC_VER)
+
+#include <windows.h>
+
+    typedef volatile LONG ikAtomicInt; /**<integer shared between threads*/
+
+#define ikAtomic_load(p) InterlockedCompareExchange((p), 0, 0)
+#define ikAtomic_store(p, v) ((void) InterlockedExchange((p), (v)))
+#define ikAtomic_exchange(p, v) InterlockedExchange((p), (v))
+#define ikAtomic_compareExchange(p, e, d) (InterlockedCompareExchange((p), (d), (e)) == (e))
+#define ikAtomic_fetchAdd(p, v) InterlockedExchangeAdd((p), (v))
+#define ikAtomic_fence() MemoryBarrier()
+
+#else
+
+    typedef volatile long ikAtomicInt; /**<integer shared between threads*/
+
+#define ikAtomic_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ikAtomic_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ikAtomic_exchange(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define ikAtomic_compareExchange(p, e, d) __sync_bool_compare_and_swap((p), (e), (d))
+#define ikAtomic_fetchAdd(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+#define ikAtomic_fence() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKATOMIC_H */
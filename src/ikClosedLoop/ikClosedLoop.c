@@ -0,0 +1,62 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikClosedLoop.c
+ *
+ * @brief Closed-loop simulation helpers implementation
+ */
+
+/* @cond */
+
+#include "ikClosedLoop.h"
+
+#define PI 3.14159265358979
+
+void ikClosedLoop_setInputs(ikClwindconWTConInputs *in, double deratingRatio, double generatorSpeed) {
+    in->deratingRatio = deratingRatio;
+    in->externalMaximumTorque = 230.0; /* kNm */
+    in->externalMinimumTorque = 0.0; /* kNm */
+    in->externalMaximumPitch = 90.0; /* deg */
+    in->externalMinimumPitch = 0.0; /* deg */
+    in->generatorSpeed = generatorSpeed; /* rad/s */
+    in->maximumSpeed = 480.0/30*3.1416; /* rpm to rad/s */
+}
+
+int ikClosedLoop_trim(ikClwindconWTCon *con, ikWtPlant *wt, const ikClwindconWTConParams *params, double windSpeed, int nSteps) {
+    double belowRatedTorque, maximumTorque, minimumPitch;
+    int err;
+
+    /* pick up the control law at the maximum speed */
+    con->in.generatorSpeed = con->in.maximumSpeed;
+    ikClwindconWTCon_step(con);
+    ikClwindconWTCon_getOutput(con, &belowRatedTorque, "power manager>below rated torque");
+    ikClwindconWTCon_getOutput(con, &maximumTorque, "maximum torque");
+    ikClwindconWTCon_getOutput(con, &minimumPitch, "minimum pitch");
+
+    /* find the plant operating point and settle the controller on it */
+    err = ikWtPlant_trim(wt, windSpeed, params->torqueControl.setpointGenerator.setpoints[0][0], con->in.maximumSpeed,
+            belowRatedTorque*1.0e3/(con->in.maximumSpeed*con->in.maximumSpeed), maximumTorque*1.0e3, minimumPitch/180.0*PI);
+    if (err) return err;
+    con->in.generatorSpeed = wt->out.generatorSpeed;
+    ikClwindconWTCon_trim(con, wt->in.torqueDemand*1.0e-3, wt->in.pitchDemand[0]*180.0/PI, nSteps);
+    return 0;
+}
+
+/* @endcond */
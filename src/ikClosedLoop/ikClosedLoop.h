@@ -0,0 +1,73 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikClosedLoop.h
+ *
+ * @brief Closed-loop simulation helpers interface
+ */
+
+#ifndef IKCLOSEDLOOP_H
+#define IKCLOSEDLOOP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ikClwindconWTCon.h"
+#include "ikWtPlant.h"
+
+#define IKCLOSEDLOOP_TRIMSTEPS 3000 /**<controller steps for the loop filters to settle on a trimmed operating point*/
+
+    /**
+     * Set the controller inputs the way DISCON sets them: the external torque
+     * limits at 0 and 230 kNm, the external pitch limits at 0 and 90 deg and
+     * the maximum speed at 480 rpm.
+     * @param in controller inputs
+     * @param deratingRatio derating ratio, non-dimensional
+     * @param generatorSpeed generator speed, in rad/s
+     */
+    void ikClosedLoop_setInputs(ikClwindconWTConInputs *in, double deratingRatio, double generatorSpeed);
+
+    /**
+     * Start a closed-loop simulation at the steady operating point of the
+     * control law at a constant wind speed. The controller is stepped once at
+     * the maximum speed to pick up the control law, the plant is set to the
+     * operating point of that law, see @link ikWtPlant_trim @endlink, and the
+     * controller is settled on it, see @link ikClwindconWTCon_trim @endlink.
+     * The controller inputs other than the generator speed must have been set,
+     * see @link ikClosedLoop_setInputs @endlink. On error, the controller is
+     * left after its first step and the plant is unchanged.
+     * @param con controller instance
+     * @param wt plant instance
+     * @param params controller initialisation parameters con was initialised with
+     * @param windSpeed hub height wind speed, in m/s
+     * @param nSteps controller settling steps, e.g. @link IKCLOSEDLOOP_TRIMSTEPS @endlink
+     * @return error code:
+     * @li 0: no error
+     * @li -1: no steady operating point, the wind speed is too low
+     * @li -2: no steady operating point at the maximum speed, the wind speed is too high for the pitch range
+     */
+    int ikClosedLoop_trim(ikClwindconWTCon *con, ikWtPlant *wt, const ikClwindconWTConParams *params, double windSpeed, int nSteps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKCLOSEDLOOP_H */
@@ -25,17 +25,168 @@ along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <math.h>
 #include "ikClwindconWTCon.h"
 
-int ikClwindconWTCon_init(ikClwindconWTCon *self, const ikClwindconWTConParams *params) {
-    int err;
-	ikClwindconWTConParams params_ = *params;
+/* keep the signals exchanged at every step within their cache lines */
+#define STEPLINES 4
+IKLAYOUT_ASSERT(ikClwindconWTCon_stepSignalsFit, offsetof(ikClwindconWTCon, priv.tpManager) <= STEPLINES*IKLAYOUT_CACHELINE);
+
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+/* and nothing but the sub-blocks, the relocations and their padding between them and the diagnostics */
+#define SUBBLOCKS (sizeof(ikTpman) + sizeof(ikPowman) + 2*sizeof(ikCvfnotch) + 3*sizeof(ikConLoop) + sizeof(ikSpecmon) + sizeof(ikWsest) \
+		+ 2*sizeof(int) + IKCLWINDCONWTCON_MAXRELOCATIONS*sizeof(size_t))
+IKLAYOUT_ASSERT(ikClwindconWTCon_hotStateFits, offsetof(ikClwindconWTCon, priv.diagnostics) <= offsetof(ikClwindconWTCon, priv.tpManager) + SUBBLOCKS + IKLAYOUT_CACHELINE);
+#endif
+
+/* record a pointer into the instance held at a known offset */
+static int addRelocation(ikClwindconWTCon *self, size_t offset) {
+	if (self->priv.nRelocations >= IKCLWINDCONWTCON_MAXRELOCATIONS) return -1;
+	self->priv.relocations[self->priv.nRelocations++] = offset;
+	return 0;
+}
+
+/* initialise the sub-blocks holding OpenWitcon structures, as addSubBlockRelocations takes them */
+static int initLoop(void *block, const void *params) {
+	return ikConLoop_init((ikConLoop *) block, (const ikConLoopParams *) params);
+}
+
+static int initPowman(void *block, const void *params) {
+	return ikPowman_init((ikPowman *) block, (const ikPowmanParams *) params);
+}
+
+/*
+ * record the pointers into the instance held by a sub-block built on OpenWitcon
+ * structures, whatever their layout, by initialising it twice more, side by side,
+ * with the reference passed on, if any, once as is and once at another address
+ * holding the same bytes: the words holding the reference, or pointing into the
+ * copy they are in, are the ones to relocate, and any other difference between
+ * the copies is a pointer elsewhere, such as to memory of its own, which
+ * returns -1
+ */
+static int addSubBlockRelocations(ikClwindconWTCon *self, size_t blockOffset, size_t blockSize, int (*init)(void *, const void *),
+		const void *params, size_t paramsSize, size_t referenceOffset, size_t referenceSize) {
+	const uintptr_t block = (uintptr_t) ((char *) self + blockOffset);
+	unsigned char *copies = (unsigned char *) calloc(2, blockSize);
+	unsigned char *other = (unsigned char *) malloc(paramsSize);
+	unsigned char *shadow = (unsigned char *) malloc(referenceSize);
+	uintptr_t a, b;
+	void *reference = NULL;
+	size_t offset;
+	int err = 0;
+	
+	/* the copies, with the reference moved in the second one */
+	if (NULL == copies || NULL == other || NULL == shadow) err = -1;
+	else {
+		memcpy(other, params, paramsSize);
+		if (referenceOffset < paramsSize) memcpy(&reference, other + referenceOffset, sizeof(reference));
+		if (NULL != reference) {
+			memcpy(shadow, reference, referenceSize);
+			memcpy(other + referenceOffset, &shadow, sizeof(shadow));
+		}
+		if (init(copies, params) || init(copies + blockSize, other)) err = -1;
+	}
+	a = (uintptr_t) copies;
+	b = (uintptr_t) (copies + blockSize);
+	
+	/* tell the differing words apart */
+	for (offset = 0; !err && offset < blockSize; offset++) {
+		uintptr_t wordA, wordB, own;
+		if (copies[offset] == copies[blockSize + offset]) continue;
+		offset -= offset % sizeof(void *);
+		if (offset + sizeof(void *) > blockSize) {
+			err = -1;
+			break;
+		}
+		memcpy(&wordA, copies + offset, sizeof(wordA));
+		memcpy(&wordB, copies + blockSize + offset, sizeof(wordB));
+		memcpy(&own, (char *) block + offset, sizeof(own));
+		if (NULL != reference && wordA == (uintptr_t) reference && wordB == (uintptr_t) shadow && own == wordA) err = addRelocation(self, blockOffset + offset);
+		else if (wordA - a == wordB - b && own - block == wordA - a) err = addRelocation(self, blockOffset + offset);
+		else err = -1;
+		offset += sizeof(void *) - 1;
+	}
+	
+	free(copies);
+	free(other);
+	free(shadow);
+	return err;
+}
+
+#ifdef OPENDISCON_FAST_STEP
+#define FASTSTEP_PROBESTEPS 2000 /* steps the specialised step is checked over */
+#define FASTSTEP_TOLERANCE 1.0e-9 /* relative, rounding differences only */
+
+/*
+ * check the specialised step against the generic one over a sweep of generator
+ * speeds about the speed setpoints, as the tables it folds restate those of
+ * the power manager
+ */
+static int fastStepAgrees(const ikClwindconWTConParams *params) {
+	ikClwindconWTConParams generic = *params;
+	const double speed = params->torqueControl.setpointGenerator.nzones > 0 ? params->torqueControl.setpointGenerator.setpoints[1][0] : 1.0;
+	char *memory;
+	ikClwindconWTCon *a, *b;
+	int agrees = 1;
+	int i;
 
+	/* two aligned instances, of which the second runs the specialised step */
+	memory = (char *) malloc(2*sizeof(ikClwindconWTCon) + IKLAYOUT_CACHELINE);
+	if (NULL == memory) return 0;
+	a = (ikClwindconWTCon *) (((uintptr_t) memory + IKLAYOUT_CACHELINE - 1) & ~(uintptr_t) (IKLAYOUT_CACHELINE - 1));
+	b = a + 1;
+	generic.fastStep = 0;
+	if (ikClwindconWTCon_init(a, &generic) || ikClwindconWTCon_init(b, &generic)) agrees = 0;
+
+	/* sweep the generator speed through the below and above rated regions */
+	for (i = 0; agrees && i < FASTSTEP_PROBESTEPS; i++) {
+		a->in.externalMaximumTorque = 1.0e6;
+		a->in.externalMinimumTorque = 0.0;
+		a->in.externalMaximumPitch = 90.0;
+		a->in.externalMinimumPitch = 0.0;
+		a->in.maximumSpeed = speed;
+		a->in.generatorSpeed = speed*(1.0 + 0.3*sin(6.283185307179586*i/FASTSTEP_PROBESTEPS) + 0.02*sin(0.7*i));
+		a->in.deratingRatio = 0.0;
+		b->in = a->in;
+		ikClwindconWTCon_step(a);
+		ikClwindconWTCon_fastStep(b);
+		if (!(fabs(b->out.torqueDemand - a->out.torqueDemand) <= FASTSTEP_TOLERANCE*(1.0 + fabs(a->out.torqueDemand)))) agrees = 0;
+		if (!(fabs(b->out.pitchDemandBlade1 - a->out.pitchDemandBlade1) <= FASTSTEP_TOLERANCE*(1.0 + fabs(a->out.pitchDemandBlade1)))) agrees = 0;
+	}
+
+	free(memory);
+	return agrees;
+}
+#endif
+
+/* pass on the references into the instance, and the signal names, that the sub-blocks take */
+static void passReferences(ikClwindconWTCon *self, ikClwindconWTConParams *params) {
 	/* pass reference to collective pitch demand for use in gain scheduling */
-	params_.collectivePitchControl.linearController.gainShedXVal = &(self->priv.collectivePitchDemand);
+	params->collectivePitchControl.linearController.gainShedXVal = &(self->priv.collectivePitchDemand);
 
 	/* pass reference to preferred torque for use in torque control */
-	params_.torqueControl.setpointGenerator.preferredControlAction = &(self->priv.belowRatedTorque);
+	params->torqueControl.setpointGenerator.preferredControlAction = &(self->priv.belowRatedTorque);
+
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+	/* keep the inputs of the managers in the cold diagnostics block */
+	params->torquePitchManager.diagnostics = &(self->priv.diagnostics.tpManager);
+	params->powerManager.diagnostics = &(self->priv.diagnostics.powerManager);
+#endif
+
+	/* name the monitored signals, in the order they are passed on at every step */
+	params->spectralMonitor.nSignals = 3;
+	params->spectralMonitor.names[0] = "generator speed";
+	params->spectralMonitor.names[1] = "torque demand";
+	params->spectralMonitor.names[2] = "collective pitch demand";
+	params->spectralMonitor.nameStore = &(self->priv.spectralMonitorNames);
+}
+
+int ikClwindconWTCon_init(ikClwindconWTCon *self, const ikClwindconWTConParams *params) {
+    int err;
+	ikClwindconWTConParams params_ = *params;
+
+	passReferences(self, &params_);
 
     /* pass on the member parameters */
     err = ikConLoop_init(&(self->priv.dtdamper), &(params_.drivetrainDamper));
@@ -48,14 +199,81 @@ int ikClwindconWTCon_init(ikClwindconWTCon *self, const ikClwindconWTConParams *
     if (err) return -5;
 	err = ikPowman_init(&(self->priv.powerManager), &(params_.powerManager));
 	if (err) return -6;
+	err = ikSpecmon_init(&(self->priv.spectralMonitor), &(params_.spectralMonitor));
+	if (err) return -7;
+	err = ikCvfnotch_init(&(self->priv.torqueSpeedNotch), &(params_.torqueSpeedNotch));
+	if (err) return -8;
+	err = ikCvfnotch_init(&(self->priv.pitchSpeedNotch), &(params_.pitchSpeedNotch));
+	if (err) return -9;
+	err = ikWsest_init(&(self->priv.windSpeedEstimator), &(params_.windSpeedEstimator));
+	if (err) return -10;
     
     /* initialise feedback signals */
     self->priv.torqueFromTorqueCon = 0.0;
 	self->priv.collectivePitchDemand = 0.0;
+	self->out.torqueDemand = 0.0;
+	self->priv.tracking = 0;
+
+#ifdef OPENDISCON_FAST_STEP
+	/* run the specialised step if generated for these parameters, and if it agrees with the generic one */
+	self->priv.fastStep = params->fastStep && ikClwindconWTCon_fastStepMatches(params) && fastStepAgrees(params);
+#endif
+	
+	/* record where the references passed on above ended up, for cloning: those held by the sub-blocks of our own */
+	self->priv.nRelocations = 0;
+	self->priv.cloneable = !addRelocation(self, offsetof(ikClwindconWTCon, priv.spectralMonitor.names));
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+	if (self->priv.cloneable) self->priv.cloneable = !addRelocation(self, offsetof(ikClwindconWTCon, priv.tpManager.diag));
+#endif
+	
+	/* and those held by the sub-blocks built on OpenWitcon structures, if they can be told apart */
+	if (self->priv.cloneable) self->priv.cloneable = !addSubBlockRelocations(self, offsetof(ikClwindconWTCon, priv.dtdamper), sizeof(ikConLoop), initLoop,
+					&(params_.drivetrainDamper), sizeof(ikConLoopParams), sizeof(ikConLoopParams), sizeof(double))
+			&& !addSubBlockRelocations(self, offsetof(ikClwindconWTCon, priv.torquecon), sizeof(ikConLoop), initLoop,
+					&(params_.torqueControl), sizeof(ikConLoopParams), offsetof(ikConLoopParams, setpointGenerator.preferredControlAction), sizeof(double))
+			&& !addSubBlockRelocations(self, offsetof(ikClwindconWTCon, priv.colpitchcon), sizeof(ikConLoop), initLoop,
+					&(params_.collectivePitchControl), sizeof(ikConLoopParams), offsetof(ikConLoopParams, linearController.gainShedXVal), sizeof(double))
+			&& !addSubBlockRelocations(self, offsetof(ikClwindconWTCon, priv.powerManager), sizeof(ikPowman), initPowman,
+					&(params_.powerManager), sizeof(ikPowmanParams), offsetof(ikPowmanParams, diagnostics), sizeof(ikPowmanDiagnostics));
 
     return 0;
 }
 
+/* point the references the sub-blocks hold into an instance copied from another address at the copy */
+static void rebase(ikClwindconWTCon *self, const void *original) {
+	int i;
+	
+	for (i = 0; i < self->priv.nRelocations; i++) {
+		char *target;
+		memcpy(&target, (char *) self + self->priv.relocations[i], sizeof(target));
+		target = (char *) self + (target - (const char *) original);
+		memcpy((char *) self + self->priv.relocations[i], &target, sizeof(target));
+	}
+}
+
+int ikClwindconWTCon_clone(ikClwindconWTCon *self, const ikClwindconWTCon *original) {
+	if (!original->priv.cloneable) return -1;
+	if (self == original) return 0;
+	memcpy(self, original, sizeof(ikClwindconWTCon));
+	rebase(self, original);
+	return 0;
+}
+
+int ikClwindconWTCon_restore(ikClwindconWTCon *self, const ikClwindconWTConParams *params) {
+	ikClwindconWTConParams params_ = *params;
+	
+	/* initialise the sub-blocks holding pointers again, those into the instance pointing at this one */
+	passReferences(self, &params_);
+	if (ikConLoop_init(&(self->priv.dtdamper), &(params_.drivetrainDamper))) return -1;
+	if (ikConLoop_init(&(self->priv.torquecon), &(params_.torqueControl))) return -1;
+	if (ikConLoop_init(&(self->priv.colpitchcon), &(params_.collectivePitchControl))) return -1;
+	if (ikTpman_init(&(self->priv.tpManager), &(params_.torquePitchManager))) return -1;
+	if (ikPowman_init(&(self->priv.powerManager), &(params_.powerManager))) return -1;
+	if (ikSpecmon_init(&(self->priv.spectralMonitor), &(params_.spectralMonitor))) return -1;
+	
+	return 0;
+}
+
 void ikClwindconWTCon_initParams(ikClwindconWTConParams *params) {
     /* pass on the member parameters */
     ikConLoop_initParams(&(params->collectivePitchControl));
@@ -63,10 +281,25 @@ void ikClwindconWTCon_initParams(ikClwindconWTConParams *params) {
     ikConLoop_initParams(&(params->torqueControl));
     ikTpman_initParams(&(params->torquePitchManager));
 	ikPowman_initParams(&(params->powerManager));
+	ikSpecmon_initParams(&(params->spectralMonitor));
+	ikCvfnotch_initParams(&(params->torqueSpeedNotch));
+	ikCvfnotch_initParams(&(params->pitchSpeedNotch));
+	ikWsest_initParams(&(params->windSpeedEstimator));
+	
+	/* run the specialised step where available */
+	params->fastStep = 1;
 }
 
 int ikClwindconWTCon_step(ikClwindconWTCon *self) {
 	
+#ifdef OPENDISCON_FAST_STEP
+	/* run the specialised step, if initialised for it */
+	if (self->priv.fastStep) return ikClwindconWTCon_fastStep(self);
+#endif
+	
+	/* run wind speed estimator, on the control actions of the step before */
+	ikWsest_step(&(self->priv.windSpeedEstimator), self->in.generatorSpeed, self->out.torqueDemand, self->priv.collectivePitchDemand);
+	
 	/* run power manager */
 	self->priv.maxTorqueFromPowman = ikPowman_step(&(self->priv.powerManager), self->in.deratingRatio, self->in.maximumSpeed, self->in.generatorSpeed);
 	ikPowman_getOutput(&(self->priv.powerManager), &(self->priv.minPitchFromPowman), "minimum pitch");
@@ -83,26 +316,116 @@ int ikClwindconWTCon_step(ikClwindconWTCon *self) {
     ikTpman_getOutput(&(self->priv.tpManager), &(self->priv.maxPitch), "maximum pitch");
     ikTpman_getOutput(&(self->priv.tpManager), &(self->priv.minTorque), "minimum torque");
 	
+	/* hold the torque and pitch control actions if tracking */
+	if (self->priv.tracking) {
+		self->priv.minTorque = self->priv.trackedTorque;
+		self->priv.maxTorque = self->priv.trackedTorque;
+		self->priv.minPitch = self->priv.trackedPitch;
+		self->priv.maxPitch = self->priv.trackedPitch;
+	}
+	
+	/* run speed notches */
+	self->priv.torqueControlSpeed = ikCvfnotch_step(&(self->priv.torqueSpeedNotch), self->in.generatorSpeed, self->in.generatorSpeed);
+	self->priv.pitchControlSpeed = ikCvfnotch_step(&(self->priv.pitchSpeedNotch), self->in.generatorSpeed, self->in.generatorSpeed);
+	
     /* run drivetrain damper */
     self->priv.torqueFromDtdamper = ikConLoop_step(&(self->priv.dtdamper), 0.0, self->in.generatorSpeed, -(self->in.externalMaximumTorque), self->in.externalMaximumTorque);
 
     /* run torque control */
-    self->priv.torqueFromTorqueCon = ikConLoop_step(&(self->priv.torquecon), self->in.maximumSpeed, self->in.generatorSpeed, self->priv.minTorque, self->priv.maxTorque);
+    self->priv.torqueFromTorqueCon = ikConLoop_step(&(self->priv.torquecon), self->in.maximumSpeed, self->priv.torqueControlSpeed, self->priv.minTorque, self->priv.maxTorque);
 
     /* calculate torque demand */
     self->out.torqueDemand = self->priv.torqueFromDtdamper + self->priv.torqueFromTorqueCon;
 
     /* run collective pitch control */
-    self->priv.collectivePitchDemand = ikConLoop_step(&(self->priv.colpitchcon), self->in.maximumSpeed, self->in.generatorSpeed, self->priv.minPitch, self->priv.maxPitch);
+    self->priv.collectivePitchDemand = ikConLoop_step(&(self->priv.colpitchcon), self->in.maximumSpeed, self->priv.pitchControlSpeed, self->priv.minPitch, self->priv.maxPitch);
     
     /* run IPC */
     self->out.pitchDemandBlade1 = self->priv.collectivePitchDemand;
     self->out.pitchDemandBlade2 = self->priv.collectivePitchDemand;
     self->out.pitchDemandBlade3 = self->priv.collectivePitchDemand;
 
+	/* run spectral monitor */
+	{
+		double monitored[3];
+		monitored[0] = self->in.generatorSpeed;
+		monitored[1] = self->out.torqueDemand;
+		monitored[2] = self->priv.collectivePitchDemand;
+		ikSpecmon_step(&(self->priv.spectralMonitor), monitored);
+	}
+
     return self->priv.tpManState;
 }
 
+int ikClwindconWTCon_track(ikClwindconWTCon *self, double torque, double pitch) {
+	int state;
+	
+	/* step with the control actions held */
+	self->priv.tracking = 1;
+	self->priv.trackedTorque = torque;
+	self->priv.trackedPitch = pitch;
+	state = ikClwindconWTCon_step(self);
+	self->priv.tracking = 0;
+	
+	return state;
+}
+
+int ikClwindconWTCon_trim(ikClwindconWTCon *self, double torque, double pitch, int nSteps) {
+	int state = 0;
+	int i;
+	
+	/* start the feedback signals at the operating point */
+	self->priv.torqueFromTorqueCon = torque;
+	self->priv.collectivePitchDemand = pitch;
+	
+	/* step on constant inputs with the control actions held */
+	for (i = 0; i < nSteps; i++) {
+		state = ikClwindconWTCon_track(self, torque, pitch);
+	}
+	
+	return state;
+}
+
+/* copy a sub-block from another instance, pointing the references it holds into that instance at this one */
+static void copyBlock(ikClwindconWTCon *self, const ikClwindconWTCon *original, size_t offset, size_t size) {
+	int i;
+	
+	memcpy((char *) self + offset, (const char *) original + offset, size);
+	for (i = 0; i < self->priv.nRelocations; i++) {
+		char *target;
+		if (self->priv.relocations[i] < offset || self->priv.relocations[i] >= offset + size) continue;
+		memcpy(&target, (char *) self + self->priv.relocations[i], sizeof(target));
+		target = (char *) self + (target - (const char *) original);
+		memcpy((char *) self + self->priv.relocations[i], &target, sizeof(target));
+	}
+}
+
+#define SAMEPARAMS(member) (!memcmp(&(params->member), &(runningParams->member), sizeof(params->member)))
+#define COPYBLOCK(member) copyBlock(self, running, offsetof(ikClwindconWTCon, priv.member), sizeof(self->priv.member))
+
+int ikClwindconWTCon_seed(ikClwindconWTCon *self, const ikClwindconWTConParams *params, const ikClwindconWTCon *running, const ikClwindconWTConParams *runningParams) {
+	const int cloneable = self->priv.cloneable && running->priv.cloneable;
+	
+	/* take the state of the control loops, if their pointers are known, and speed notches with the same parameters, the others keep their own */
+	if (cloneable && SAMEPARAMS(drivetrainDamper)) COPYBLOCK(dtdamper);
+	if (cloneable && SAMEPARAMS(torqueControl)) COPYBLOCK(torquecon);
+	if (cloneable && SAMEPARAMS(collectivePitchControl)) COPYBLOCK(colpitchcon);
+	if (SAMEPARAMS(torqueSpeedNotch)) COPYBLOCK(torqueSpeedNotch);
+	if (SAMEPARAMS(pitchSpeedNotch)) COPYBLOCK(pitchSpeedNotch);
+	
+	/* take the state of the managers, and of the monitors with the same parameters */
+	COPYBLOCK(tpManager);
+	if (SAMEPARAMS(spectralMonitor)) COPYBLOCK(spectralMonitor);
+	if (SAMEPARAMS(windSpeedEstimator)) COPYBLOCK(windSpeedEstimator);
+	
+	/* carry on from the last step of the running instance */
+	self->in = running->in;
+	memcpy(&(self->priv), &(running->priv), offsetof(ikClwindconWTConPrivate, tracking));
+	self->out = running->out;
+	
+	return 0;
+}
+
 int ikClwindconWTCon_getOutput(const ikClwindconWTCon *self, double *output, const char *name) {
     int err;
     const char *sep;
@@ -173,6 +496,26 @@ int ikClwindconWTCon_getOutput(const ikClwindconWTCon *self, double *output, con
         if (err) return -1;
         else return 0;
     }
+	if (!strncmp(name, "torque speed notch", strlen(name) - strlen(sep))) {
+        err = ikCvfnotch_getOutput(&(self->priv.torqueSpeedNotch), output, sep + 1);
+        if (err) return -1;
+        else return 0;
+    }
+	if (!strncmp(name, "pitch speed notch", strlen(name) - strlen(sep))) {
+        err = ikCvfnotch_getOutput(&(self->priv.pitchSpeedNotch), output, sep + 1);
+        if (err) return -1;
+        else return 0;
+    }
+	if (!strncmp(name, "spectral monitor", strlen(name) - strlen(sep))) {
+        err = ikSpecmon_getOutput(&(self->priv.spectralMonitor), output, sep + 1);
+        if (err) return -1;
+        else return 0;
+    }
+	if (!strncmp(name, "wind speed estimator", strlen(name) - strlen(sep))) {
+        err = ikWsest_getOutput(&(self->priv.windSpeedEstimator), output, sep + 1);
+        if (err) return -1;
+        else return 0;
+    }
 
 
     return -2;
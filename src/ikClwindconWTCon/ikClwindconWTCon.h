@@ -30,9 +30,21 @@ along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include "ikConLoop.h"
 #include "ikTpman.h"
 #include "ikPowman.h"
+#include "ikSpecmon.h"
+#include "ikCvfnotch.h"
+#include "ikWsest.h"
+#include "ikLayout.h"
+
+/* wtcodegen is built from the generic sources, before the specialised step exists */
+#if defined(OPENDISCON_FAST_STEP) && defined(OPENDISCON_WTCODEGEN)
+#undef OPENDISCON_FAST_STEP
+#endif
+
+#define IKCLWINDCONWTCON_MAXRELOCATIONS 16 /**<maximum number of pointers into the instance itself held by sub-blocks, beyond which instances cannot be cloned*/
 
     /**
      * @struct ikClwindconWTConInputs
@@ -61,16 +73,14 @@ extern "C" {
 
     /* @cond */
 
+    typedef struct ikClwindconWTConDiagnostics {
+        ikTpmanDiagnostics tpManager;
+        ikPowmanDiagnostics powerManager;
+    } ikClwindconWTConDiagnostics;
+
     typedef struct ikClwindconWTConPrivate {
-		ikPowman powerManager;
-        ikTpman   tpManager;
-        ikConLoop dtdamper;
-        ikConLoop torquecon;
-        ikConLoop colpitchcon;
         double maxPitch;
         double minPitch;
-        double maxSpeed;
-        int tpManState;
 		double maxTorque;
         double minTorque;
         double torqueFromDtdamper;
@@ -79,6 +89,31 @@ extern "C" {
 		double belowRatedTorque;
 		double minPitchFromPowman;
 		double maxTorqueFromPowman;
+		double trackedTorque;
+		double trackedPitch;
+		double torqueControlSpeed;
+		double pitchControlSpeed;
+        int tpManState;
+		int tracking;
+#ifdef OPENDISCON_FAST_STEP
+		int fastStep;
+#endif
+        ikTpman   tpManager;
+		ikPowman powerManager;
+		ikCvfnotch torqueSpeedNotch;
+		ikCvfnotch pitchSpeedNotch;
+        ikConLoop dtdamper;
+        ikConLoop torquecon;
+        ikConLoop colpitchcon;
+		ikSpecmon spectralMonitor;
+		ikWsest windSpeedEstimator;
+		int nRelocations;
+		int cloneable;
+		size_t relocations[IKCLWINDCONWTCON_MAXRELOCATIONS];
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+		ikClwindconWTConDiagnostics diagnostics;
+#endif
+		ikSpecmonNames spectralMonitorNames;
     } ikClwindconWTConPrivate;
     /* @endcond */
 
@@ -111,6 +146,21 @@ extern "C" {
      * 
      * @image html ikClwindconWTCon_block_diagram.svg
      * 
+     * @par Memory layout
+     * 
+     * Instances are aligned to a cache line. The inputs, outputs and the
+     * signals exchanged between sub-blocks at every step come first, followed
+     * by the torque-pitch manager, the power manager, the speed notches, the
+     * control loops, the spectral monitor and the wind speed estimator. The inputs the
+     * managers keep for
+     * @link ikClwindconWTCon_getOutput @endlink come last, in a diagnostics
+     * block of their own that the managers write through a pointer, see
+     * @link ikLayout.h @endlink, followed by the names of the signals of the
+     * spectral monitor. The build fails if the signals exchanged at
+     * every step outgrow their 4 cache lines, or if anything but the sub-blocks
+     * comes between them and the diagnostics. Allocate instances statically,
+     * or with an aligned allocator.
+     * 
      * @par Public members
      * @li @link in @endlink inputs
      * @li @link out @endlink outputs
@@ -118,12 +168,17 @@ extern "C" {
      * @par Methods
      * @li @link ikClwindconWTCon_initParams @endlink initialise initialisation parameter structure
      * @li @link ikClwindconWTCon_init @endlink initialise an instance
+     * @li @link ikClwindconWTCon_clone @endlink initialise an instance as a copy of another one
+     * @li @link ikClwindconWTCon_restore @endlink fix up a copy of a fresh instance
      * @li @link ikClwindconWTCon_step @endlink execute periodic calculations
+     * @li @link ikClwindconWTCon_track @endlink execute periodic calculations with the control actions held
+     * @li @link ikClwindconWTCon_trim @endlink settle on a steady operating point
+     * @li @link ikClwindconWTCon_seed @endlink take over from a running instance without a bump
      * @li @link ikClwindconWTCon_getOutput @endlink get output value
      * 
      */
     typedef struct ikClwindconWTCon {
-        ikClwindconWTConInputs in; /**<inputs*/
+        IKLAYOUT_ALIGNED ikClwindconWTConInputs in; /**<inputs*/
         ikClwindconWTConOutputs out; /**<outputs*/
         /* @cond */
         ikClwindconWTConPrivate priv;
@@ -140,6 +195,11 @@ extern "C" {
         ikConLoopParams collectivePitchControl; /**<collective pitch control initialisation parameters*/
         ikTpmanParams torquePitchManager; /**<torque-pitch manager inintialisation parameters*/
 		ikPowmanParams powerManager; /**<power manager initialisation parameters*/
+		ikCvfnotchParams torqueSpeedNotch; /**<notch on the generator speed measured by torque control, at a frequency following the generator speed, for instance at 3P. It is disabled by default*/
+		ikCvfnotchParams pitchSpeedNotch; /**<notch on the generator speed measured by collective pitch control, at a frequency following the generator speed, for instance at 3P. It is disabled by default*/
+		ikSpecmonParams spectralMonitor; /**<spectral monitor initialisation parameters. Its signals are set by the controller: generator speed, torque demand and collective pitch demand*/
+		ikWsestParams windSpeedEstimator; /**<rotor effective wind speed estimator initialisation parameters. It is fed the generator speed, and the torque and collective pitch demands of the step before, and does not act on the control. It is disabled by default*/
+		int fastStep; /**<1 to run the specialised step, when built with OPENDISCON_FAST_STEP and generated for these parameters, see @link ikClwindconWTCon_fastStep @endlink, 0 to run the generic one. The default value is 1*/
     } ikClwindconWTConParams;
 
     /**
@@ -153,6 +213,10 @@ extern "C" {
      * @li -3: collective pitch control initialisation failed
      * @li -5: torque-pitch manager initialisation failed
 	 * @li -6: power manager initialisation failed
+	 * @li -7: spectral monitor initialisation failed
+	 * @li -8: torque speed notch initialisation failed
+	 * @li -9: pitch speed notch initialisation failed
+	 * @li -10: wind speed estimator initialisation failed
      */
     int ikClwindconWTCon_init(ikClwindconWTCon *self, const ikClwindconWTConParams *params);
 
@@ -163,7 +227,46 @@ extern "C" {
     void ikClwindconWTCon_initParams(ikClwindconWTConParams *params);
 
     /**
-     * Execute periodic calculations
+     * Initialise an instance as a copy of another one, initialised or cloned
+     * before, state included. This costs a memory copy, plus rewriting the
+     * pointers the sub-blocks hold into the instance itself, which
+     * @link ikClwindconWTCon_init @endlink finds by initialising each
+     * sub-block built on OpenWitcon structures, the control loops and the
+     * power manager, twice more, with the references it passes on at other
+     * addresses, and comparing the copies. If a sub-block holds any other pointer that
+     * differs between the copies, such as to memory of its own, or more than
+     * @link IKCLWINDCONWTCON_MAXRELOCATIONS @endlink of them, the instance
+     * cannot be cloned, and should be initialised instead. Use it to replicate
+     * a template instance instead of initialising every instance.
+     * @param self instance
+     * @param original instance to copy
+     * @return error code:
+     * @li 0: no error
+     * @li -1: original cannot be cloned, self is unchanged
+     */
+    int ikClwindconWTCon_clone(ikClwindconWTCon *self, const ikClwindconWTCon *original);
+
+    /**
+     * Fix up the bytes of an instance freshly initialised with the same
+     * parameters, copied from any address, for instance from a file written
+     * by another process, see @link ikParcache @endlink. Unlike
+     * @link ikClwindconWTCon_clone @endlink, this makes no assumption about
+     * the pointers the sub-blocks hold: those that may hold any, the control
+     * loops, the torque-pitch and power managers and the spectral monitor,
+     * are initialised again, which leaves them as in a fresh instance, and
+     * the rest are taken as they are.
+     * @param self instance, holding the bytes of a fresh instance initialised with params
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: a sub-block initialisation failed
+     */
+    int ikClwindconWTCon_restore(ikClwindconWTCon *self, const ikClwindconWTConParams *params);
+
+    /**
+     * Execute periodic calculations. This runs
+     * @link ikClwindconWTCon_fastStep @endlink instead when the instance was
+     * initialised for it, see @link ikClwindconWTConParams.fastStep @endlink.
      * @param self controller instance
      * @return state
 	 * @li 0: below rated
@@ -171,6 +274,66 @@ extern "C" {
      */
     int ikClwindconWTCon_step(ikClwindconWTCon *self);
 
+    /**
+     * Execute periodic calculations with the torque control and collective
+     * pitch control actions held at given values, by collapsing their
+     * limits onto them. The loop filters and integrators then follow the
+     * given operating point, so that a controller run this way alongside
+     * another one for a while can take over from it without a bump.
+     * @param self controller instance
+     * @param torque torque demand from torque control to hold, in kNm
+     * @param pitch collective pitch demand to hold, in degrees
+     * @return state
+	 * @li 0: below rated
+	 * @li 1: above rated
+     */
+    int ikClwindconWTCon_track(ikClwindconWTCon *self, double torque, double pitch);
+
+    /**
+     * Settle on a steady operating point, so that a simulation started from
+     * it skips the start-up transient. The operating point is given by the
+     * inputs at @link ikClwindconWTCon.in @endlink, generator speed and
+     * derating ratio included, and by the torque and collective pitch it is
+     * held at, for instance as found by @link ikWtPlant_trim @endlink.
+     * The controller is run with @link ikClwindconWTCon_track @endlink for a
+     * number of steps on these constant inputs, which brings the loop filters,
+     * the integrators and the torque-pitch manager state to their steady
+     * values, and the outputs to the given torque and pitch.
+     * @param self controller instance
+     * @param torque steady torque demand, in kNm
+     * @param pitch steady collective pitch demand, in degrees
+     * @param nSteps number of settling steps, enough for the slowest loop filter to settle
+     * @return state
+	 * @li 0: below rated
+	 * @li 1: above rated
+     */
+    int ikClwindconWTCon_trim(ikClwindconWTCon *self, double torque, double pitch, int nSteps);
+
+    /**
+     * Take over from a running instance without a bump, for instance to
+     * adopt a new parameter set, see @link ikHotswap @endlink. The sub-blocks
+     * initialised with the same parameters in both instances take the state
+     * of those of the running one, as does the torque-pitch manager, except
+     * for the control loops if either instance cannot be cloned, see
+     * @link ikClwindconWTCon_clone @endlink. The others keep their own
+     * state, so self should have been settled with
+     * @link ikClwindconWTCon_trim @endlink near the operating point of the
+     * running instance beforehand, as @link ikHotswap @endlink does. The
+     * signals exchanged between the sub-blocks and the outputs are those of
+     * the running instance. The first step after this should be run with
+     * @link ikClwindconWTCon_track @endlink, holding the torque and pitch
+     * control actions of the running instance: the control loops with new
+     * parameters then take up the remaining offset in their integrators,
+     * through their anti-windup, and the control actions carry on from there
+     * without a jump. This costs a copy of the instance state.
+     * @param self controller instance, initialised with params
+     * @param params initialisation parameters of self
+     * @param running running controller instance
+     * @param runningParams initialisation parameters of running
+     * @return 0
+     */
+    int ikClwindconWTCon_seed(ikClwindconWTCon *self, const ikClwindconWTConParams *params, const ikClwindconWTCon *running, const ikClwindconWTConParams *runningParams);
+
     /**
      * Get output value by name. All signals named on the block diagram of
      * @link ikClwindconWTCon @endlink are accessible, except for inputs and outputs,
@@ -180,6 +343,8 @@ extern "C" {
      * signal name. For example:
      * @li to access the torque demand from the drivetrain damper, use "torque demand from drivetrain damper"
      * @li to access the torque control control action, use "torque control>control action"
+     * @li to access the amplitude of the generator speed at the first monitored frequency, use "spectral monitor>generator speed amplitude 1"
+     * @li to access the rotor effective wind speed estimate, use "wind speed estimator>wind speed"
      * 
      * @param self controller instance
      * @param output output value
@@ -191,6 +356,31 @@ extern "C" {
      */
     int ikClwindconWTCon_getOutput(const ikClwindconWTCon *self, double *output, const char *name);
 
+#ifdef OPENDISCON_FAST_STEP
+    /**
+     * Execute periodic calculations, with code specialised by wtcodegen for
+     * the parameter set given by setParams: the power manager tables are
+     * folded into straight-line code, and the disabled sub-blocks dropped.
+     * The control loops are run by OpenWitcon as in the generic step, and
+     * the results are those of the generic step, to rounding.
+     * @link ikClwindconWTCon_step @endlink calls it on instances initialised
+     * for it. Only available when built with OPENDISCON_FAST_STEP.
+     * @param self controller instance, initialised for the specialised step
+     * @return state
+	 * @li 0: below rated
+	 * @li 1: above rated
+     */
+    int ikClwindconWTCon_fastStep(ikClwindconWTCon *self);
+
+    /**
+     * Check whether @link ikClwindconWTCon_fastStep @endlink was generated
+     * for a parameter set. Only available when built with OPENDISCON_FAST_STEP.
+     * @param params initialisation parameters
+     * @return 1 if it was, 0 otherwise
+     */
+    int ikClwindconWTCon_fastStepMatches(const ikClwindconWTConParams *params);
+#endif
+
 
 
 #ifdef __cplusplus
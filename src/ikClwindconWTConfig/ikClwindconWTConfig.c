@@ -23,6 +23,7 @@ along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
  * @brief CL-Windcon wind turbine controller configuration implementation
  */
 
+#include <math.h>
 #include "ikClwindconWTConfig.h"
 
 void setParams(ikClwindconWTConParams *param) {
@@ -40,6 +41,10 @@ void setParams(ikClwindconWTConParams *param) {
 	ikTuneTorqueLowpassFilter(&(param->torqueControl), T);
 	ikTuneTorqueNotches(&(param->torqueControl), T);
 	ikTuneTorquePI(&(param->torqueControl), T);
+	ikTuneTorqueSpeedNotch(&(param->torqueSpeedNotch), T);
+	ikTunePitchSpeedNotch(&(param->pitchSpeedNotch), T);
+	ikTuneSpectralMonitor(&(param->spectralMonitor), T);
+	ikTuneWindSpeedEstimator(&(param->windSpeedEstimator), T);
 
 }
 
@@ -465,3 +470,168 @@ void ikTuneTorquePI(ikConLoopParams *params, double T) {
     params->linearController.postGainTfs.tfParams[0].a[2] = 0.0;
 
 }
+
+void ikTuneTorqueSpeedNotch(ikCvfnotchParams *params, double T) {
+
+	/*! [Torque 3P notch filter] */
+    /*
+	####################################################################
+                    Torque 3P notch filter
+
+    Transfer function:
+    H(s) = (s^2 + 2*dnum*w*s + w^2) / (s^2 + 2*dden*w*s + w^2)
+    with w = n*wg/N, following the generator speed wg.
+
+    The coefficients are tabulated at nw frequencies from wmin to wmax.
+    The sampling time is given by function parameter T.
+
+    Set parameters here:
+	*/
+    int enable = 0; /* [-] */
+    double n = 3.0; /* [-] harmonic of the rotor speed */
+    double N = 50.0; /* [-] gearbox ratio */
+    double wmin = 1.5; /* [rad/s] */
+    double wmax = 3.5; /* [rad/s] */
+    int nw = 16; /* [-] */
+    double dnum = 0.01; /* [-] */
+    double dden = 0.2; /* [-] */
+    /*
+    ####################################################################
+	*/
+	/*! [Torque 3P notch filter] */
+
+    params->enable = enable;
+    params->frequencyGain = n/N;
+    params->minimumFrequency = wmin;
+    params->maximumFrequency = wmax;
+    params->nPoints = nw;
+    params->dampNum = dnum;
+    params->dampDen = dden;
+    params->samplePeriod = T;
+
+}
+
+void ikTunePitchSpeedNotch(ikCvfnotchParams *params, double T) {
+
+	/*! [Pitch 3P notch filter] */
+    /*
+	####################################################################
+                    Pitch 3P notch filter
+
+    Transfer function:
+    H(s) = (s^2 + 2*dnum*w*s + w^2) / (s^2 + 2*dden*w*s + w^2)
+    with w = n*wg/N, following the generator speed wg.
+
+    The coefficients are tabulated at nw frequencies from wmin to wmax.
+    The sampling time is given by function parameter T.
+
+    Set parameters here:
+	*/
+    int enable = 0; /* [-] */
+    double n = 3.0; /* [-] harmonic of the rotor speed */
+    double N = 50.0; /* [-] gearbox ratio */
+    double wmin = 1.5; /* [rad/s] */
+    double wmax = 3.5; /* [rad/s] */
+    int nw = 16; /* [-] */
+    double dnum = 0.01; /* [-] */
+    double dden = 0.2; /* [-] */
+    /*
+    ####################################################################
+	*/
+	/*! [Pitch 3P notch filter] */
+
+    params->enable = enable;
+    params->frequencyGain = n/N;
+    params->minimumFrequency = wmin;
+    params->maximumFrequency = wmax;
+    params->nPoints = nw;
+    params->dampNum = dnum;
+    params->dampDen = dden;
+    params->samplePeriod = T;
+
+}
+
+void ikTuneSpectralMonitor(ikSpecmonParams *params, double T) {
+
+	/*! [Spectral monitor] */
+    /*
+	####################################################################
+                    Spectral monitor
+
+    Amplitudes of generator speed, torque demand and collective pitch
+    demand at the monitored frequencies, averaged over an exponential
+    window of time constant tau. The frequency resolution is about 1/tau.
+
+    The sampling time is given by function parameter T.
+
+    Set parameters here:
+	*/
+    double w1 = 1.59; /* [rad/s] 1st tower mode */
+    double tau = 20.0; /* [s] */
+    /*
+    ####################################################################
+	*/
+	/*! [Spectral monitor] */
+
+    params->nFrequencies = 1;
+    params->frequencies[0] = w1;
+    params->windowTime = tau;
+    params->samplePeriod = T;
+
+}
+
+void ikTuneWindSpeedEstimator(ikWsestParams *params, double T) {
+	int i, j;
+
+	/*! [Wind speed estimator] */
+    /*
+	####################################################################
+                    Wind speed estimator
+
+    Rotor effective wind speed, worked out from the aerodynamic torque
+    given by a drivetrain observer of bandwidth wo and damping ratio dro,
+    and the power coefficient table. The table is that of the analytic
+    approximation used by the simulation plant, at tip speed ratios
+    from 0.5 to 20 and pitch angles from 0 to 30 degrees.
+
+    The sampling time is given by function parameter T.
+
+    Set parameters here:
+	*/
+    int enable = 1; /* [-] */
+    double rho = 1.225; /* [kg/m^3] air density */
+    double R = 89.15; /* [m] rotor radius */
+    double N = 50.0; /* [-] gearbox ratio */
+    double J = 1.5975e8; /* [kg m^2] rotor and generator inertia, on the low speed shaft */
+    double wo = 2.0; /* [rad/s] */
+    double dro = 0.7; /* [-] */
+    /*
+    ####################################################################
+	*/
+	/*! [Wind speed estimator] */
+
+    params->enable = enable;
+    params->samplePeriod = T;
+    params->airDensity = rho;
+    params->rotorRadius = R;
+    params->gearboxRatio = N;
+    params->inertia = J;
+    params->bandwidth = wo;
+    params->damping = dro;
+    params->nLambda = 40;
+    params->lambdaMin = 0.5;
+    params->lambdaStep = 0.5;
+    params->nPitch = 31;
+    params->pitchMin = 0.0;
+    params->pitchStep = 1.0;
+    for (i = 0; i < params->nLambda; i++) {
+        const double lambda = params->lambdaMin + i*params->lambdaStep;
+        for (j = 0; j < params->nPitch; j++) {
+            const double pitch = params->pitchMin + j*params->pitchStep;
+            const double li = 1.0/(1.0/(lambda + 0.08*pitch) - 0.035/(pitch*pitch*pitch + 1.0));
+            const double cp = 0.5176*(116.0/li - 0.4*pitch - 5.0)*exp(-21.0/li) + 0.0068*lambda;
+            params->cp[i][j] = cp > 0.0 ? cp : 0.0;
+        }
+    }
+
+}
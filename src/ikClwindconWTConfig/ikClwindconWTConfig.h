@@ -58,6 +58,14 @@ extern "C" {
 
 	void ikTunePitchPIGainSchedule(ikConLoopParams *params);
 
+	void ikTuneTorqueSpeedNotch(ikCvfnotchParams *params, double T);
+
+	void ikTunePitchSpeedNotch(ikCvfnotchParams *params, double T);
+
+	void ikTuneSpectralMonitor(ikSpecmonParams *params, double T);
+
+	void ikTuneWindSpeedEstimator(ikWsestParams *params, double T);
+
 #ifdef __cplusplus
 }
 #endif
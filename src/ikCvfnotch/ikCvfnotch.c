@@ -0,0 +1,156 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikCvfnotch.c
+ *
+ * @brief Class ikCvfnotch implementation
+ */
+
+/* @cond */
+
+#include <string.h>
+#include <math.h>
+
+#include "ikCvfnotch.h"
+
+/* coefficients b0, b1, b2, a1, a2 of the notch at w, normalised to a0 = 1 */
+static void discretise(double *c, double w, double dnum, double dden, double T) {
+    double k = w/tan(0.5*w*T);
+    double kk = k*k;
+    double ww = w*w;
+    double a0 = kk + 2.0*dden*w*k + ww;
+
+    c[0] = (kk + 2.0*dnum*w*k + ww)/a0;
+    c[1] = 2.0*(ww - kk)/a0;
+    c[2] = (kk - 2.0*dnum*w*k + ww)/a0;
+    c[3] = 2.0*(ww - kk)/a0;
+    c[4] = (kk - 2.0*dden*w*k + ww)/a0;
+}
+
+int ikCvfnotch_init(ikCvfnotch *self, const ikCvfnotchParams *params) {
+    double spacing;
+    int i;
+
+    /* check the parameters */
+    if (params->samplePeriod <= 0.0) return -1;
+    if (params->minimumFrequency <= 0.0 || params->maximumFrequency <= params->minimumFrequency
+            || params->maximumFrequency >= 3.14159265358979/params->samplePeriod
+            || params->nPoints < 2 || params->nPoints > IKCVFNOTCH_MAXPOINTS) return -2;
+    if (params->dampNum < 0.0 || params->dampDen <= 0.0) return -3;
+
+    /* register the parameters */
+    self->enable = params->enable;
+    self->frequencyGain = params->frequencyGain;
+    self->minimumFrequency = params->minimumFrequency;
+    self->maximumFrequency = params->maximumFrequency;
+    self->nPoints = params->nPoints;
+    spacing = (params->maximumFrequency - params->minimumFrequency)/(params->nPoints - 1);
+    self->inverseSpacing = 1.0/spacing;
+
+    /* tabulate the coefficients */
+    for (i = 0; i < self->nPoints; i++) {
+        discretise(self->coefficients[i], params->minimumFrequency + i*spacing, params->dampNum, params->dampDen, params->samplePeriod);
+    }
+
+    /* the state is set by the first input */
+    self->started = 0;
+    self->input = 0.0;
+    self->output = 0.0;
+    self->frequency = params->minimumFrequency;
+    self->x1 = 0.0;
+    self->x2 = 0.0;
+    self->y1 = 0.0;
+    self->y2 = 0.0;
+
+    return 0;
+}
+
+void ikCvfnotch_initParams(ikCvfnotchParams *params) {
+    params->enable = 0;
+    params->frequencyGain = 1.0;
+    params->minimumFrequency = 0.5;
+    params->maximumFrequency = 5.0;
+    params->nPoints = 16;
+    params->dampNum = 0.01;
+    params->dampDen = 0.2;
+    params->samplePeriod = 0.01;
+}
+
+double ikCvfnotch_step(ikCvfnotch *self, double input, double scheduling) {
+    const double *lo;
+    const double *hi;
+    double c[5];
+    double u;
+    int i, j;
+
+    self->input = input;
+    if (!self->enable) {
+        self->output = input;
+        return input;
+    }
+
+    /* start in steady state, with unit gain at zero frequency */
+    if (!self->started) {
+        self->x1 = self->x2 = input;
+        self->y1 = self->y2 = input;
+        self->started = 1;
+    }
+
+    /* interpolate the coefficients at the notch frequency, within the table */
+    self->frequency = self->frequencyGain*scheduling;
+    if (self->frequency < self->minimumFrequency) self->frequency = self->minimumFrequency;
+    if (self->frequency > self->maximumFrequency) self->frequency = self->maximumFrequency;
+    u = (self->frequency - self->minimumFrequency)*self->inverseSpacing;
+    i = (int) u;
+    if (i > self->nPoints - 2) i = self->nPoints - 2;
+    u -= i;
+    lo = self->coefficients[i];
+    hi = self->coefficients[i + 1];
+    for (j = 0; j < 5; j++) c[j] = lo[j] + u*(hi[j] - lo[j]);
+
+    /* filter */
+    self->output = c[0]*input + c[1]*self->x1 + c[2]*self->x2 - c[3]*self->y1 - c[4]*self->y2;
+    self->x2 = self->x1;
+    self->x1 = input;
+    self->y2 = self->y1;
+    self->y1 = self->output;
+
+    return self->output;
+}
+
+int ikCvfnotch_getOutput(const ikCvfnotch *self, double *output, const char *name) {
+    /* pick up the signal names */
+    if (!strcmp(name, "input")) {
+        *output = self->input;
+        return 0;
+    }
+    if (!strcmp(name, "output")) {
+        *output = self->output;
+        return 0;
+    }
+    if (!strcmp(name, "frequency")) {
+        *output = self->frequency;
+        return 0;
+    }
+
+    return -1;
+}
+
+/* @endcond */
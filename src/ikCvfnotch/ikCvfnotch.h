@@ -0,0 +1,151 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikCvfnotch.h
+ *
+ * @brief Class ikCvfnotch interface
+ */
+
+#ifndef IKCVFNOTCH_H
+#define IKCVFNOTCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IKCVFNOTCH_MAXPOINTS 32 /**<maximum number of frequencies in the coefficient table*/
+
+    /**
+     * @struct ikCvfnotch
+     * @brief Variable-frequency notch filter with tabulated coefficients
+     *
+     * This is a notch filter whose frequency follows a scheduling variable,
+     * for instance a 1P or 3P notch following the rotor speed, with the
+     * transfer function
+     * H(s) = (s^2 + 2*dnum*w*s + w^2) / (s^2 + 2*dden*w*s + w^2),
+     * where w is the scheduling variable times a gain, discretised with the
+     * bilinear transform prewarped at w.
+     *
+     * Unlike the ikVfnotch block of OpenWitcon, which recomputes its
+     * coefficients, trigonometric functions included, whenever its frequency
+     * changes, the coefficients are worked out at initialisation for a grid
+     * of evenly spaced frequencies over the operating range, and each step
+     * interpolates them linearly between the two grid frequencies around w.
+     * A step costs about the same as a fixed notch, whatever w does.
+     * Between grid frequencies, the notch is slightly shallower than dnum/dden,
+     * the less so the finer the grid. Frequencies outside the range are
+     * taken at its nearest end.
+     *
+     * The filter starts in steady state at its first input. Disabled, it
+     * passes its input through.
+     *
+     * @par Inputs
+     * @li input: specify via @link ikCvfnotch_step @endlink
+     * @li scheduling variable: specify via @link ikCvfnotch_step @endlink
+     *
+     * @par Outputs
+     * @li output: get via @link ikCvfnotch_step @endlink or @link ikCvfnotch_getOutput @endlink
+     * @li input: get via @link ikCvfnotch_getOutput @endlink
+     * @li frequency: notch frequency in use, in rad/s, get via @link ikCvfnotch_getOutput @endlink
+     *
+     * @par Methods
+     * @li @link ikCvfnotch_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikCvfnotch_init @endlink initialise an instance
+     * @li @link ikCvfnotch_step @endlink execute periodic calculations
+     * @li @link ikCvfnotch_getOutput @endlink get output value
+     */
+    typedef struct ikCvfnotch {
+        /* @cond */
+        int enable;
+        int started;
+        double frequencyGain;
+        double minimumFrequency;
+        double maximumFrequency;
+        double inverseSpacing;
+        int nPoints;
+        double input;
+        double output;
+        double frequency;
+        double x1;
+        double x2;
+        double y1;
+        double y2;
+        double coefficients[IKCVFNOTCH_MAXPOINTS][5];
+        /* @endcond */
+    } ikCvfnotch;
+
+    /**
+     * @struct ikCvfnotchParams
+     * @brief Variable-frequency notch filter with tabulated coefficients initialisation parameters
+     */
+    typedef struct ikCvfnotchParams {
+        int enable; /**<enable flag, 0 to pass the input through, any other value to filter it. The default value is 0*/
+        double frequencyGain; /**<notch frequency per unit of the scheduling variable, in rad/s per unit. The default value is 1.0*/
+        double minimumFrequency; /**<lowest frequency of the coefficient table, in rad/s. It must be positive. The default value is 0.5*/
+        double maximumFrequency; /**<highest frequency of the coefficient table, in rad/s. It must be larger than the lowest and smaller than the Nyquist frequency. The default value is 5.0*/
+        int nPoints; /**<number of frequencies in the coefficient table, between 2 and @link IKCVFNOTCH_MAXPOINTS @endlink. The default value is 16*/
+        double dampNum; /**<numerator damping ratio, non-dimensional. It must not be negative. The default value is 0.01*/
+        double dampDen; /**<denominator damping ratio, non-dimensional. It must be positive. The default value is 0.2*/
+        double samplePeriod; /**<sample period, in s. It must be positive. The default value is 0.01*/
+    } ikCvfnotchParams;
+
+    /**
+     * Initialise an instance
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid sample period
+     * @li -2: invalid frequency range or number of frequencies
+     * @li -3: invalid damping ratios
+     */
+    int ikCvfnotch_init(ikCvfnotch *self, const ikCvfnotchParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikCvfnotch_initParams(ikCvfnotchParams *params);
+
+    /**
+     * Execute periodic calculations
+     * @param self notch filter instance
+     * @param input input
+     * @param scheduling scheduling variable
+     * @return output
+     */
+    double ikCvfnotch_step(ikCvfnotch *self, double input, double scheduling);
+
+    /**
+     * Get output value by name
+     * @param self notch filter instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     */
+    int ikCvfnotch_getOutput(const ikCvfnotch *self, double *output, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKCVFNOTCH_H */
@@ -0,0 +1,438 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikDiscon.c
+ *
+ * @brief Class ikDiscon implementation
+ */
+
+/* @cond */
+
+#define NINT(a) ((a) >= 0.0 ? (int) ((a)+0.5) : (int) ((a)-0.5))
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ikDiscon.h"
+
+/* signals written to the log, named as for ikClwindconWTCon_getOutput */
+#define NLOGSIGNALS 10
+static const char *logNames[NLOGSIGNALS] = {
+    "maximum torque",
+    "minimum torque",
+    "maximum pitch",
+    "minimum pitch",
+    "collective pitch demand",
+    "torque demand from torque control",
+    "torque demand from drivetrain damper",
+    "maximum torque from power manager",
+    "minimum pitch from power manager",
+    "power manager>below rated torque"
+};
+static const char *logUnits[NLOGSIGNALS] = {"kNm", "kNm", "deg", "deg", "deg", "kNm", "kNm", "kNm", "deg", "kNm"};
+
+/* signals kept by the event recorder */
+#define NEVENTSIGNALS 9
+static const char *eventNames[NEVENTSIGNALS] = {
+    "generator speed",
+    "torque demand",
+    "collective pitch demand",
+    "maximum torque",
+    "minimum torque",
+    "maximum pitch",
+    "minimum pitch",
+    "torque-pitch manager state",
+    "torque saturation margin"
+};
+static const char *eventUnits[NEVENTSIGNALS] = {"rad/s", "kNm", "deg", "kNm", "kNm", "deg", "deg", "-", "kNm"};
+
+/* signals served by the live monitor, named as for ikClwindconWTCon_getOutput except for the first two */
+#define NMONITORSIGNALS 12
+static const char *monitorNames[NMONITORSIGNALS] = {
+    "generator speed",
+    "torque-pitch manager state",
+    "maximum torque",
+    "minimum torque",
+    "maximum pitch",
+    "minimum pitch",
+    "torque demand from torque control",
+    "collective pitch demand",
+    "maximum torque from power manager",
+    "minimum pitch from power manager",
+    "torque control>error",
+    "collective pitch control>error"
+};
+
+/* signals counted for fatigue */
+static const char *fatigueNames[IKDISCON_NFATIGUESIGNALS] = {
+    "torque demand",
+    "collective pitch demand",
+    "tower top fore-aft acceleration"
+};
+static const char *fatigueUnits[IKDISCON_NFATIGUESIGNALS] = {"kNm", "deg", "m/s^2"};
+
+/* signals summarised in the statistics, named as for ikClwindconWTCon_getOutput except for the first five and the last */
+#define NSTATISTICSSIGNALS 8
+static const char *statisticsNames[NSTATISTICSSIGNALS] = {
+    "generator speed",
+    "torque demand",
+    "pitch demand blade 1",
+    "pitch demand blade 2",
+    "pitch demand blade 3",
+    "maximum torque from power manager",
+    "minimum pitch from power manager",
+    "torque-pitch manager state"
+};
+static const char *statisticsUnits[NSTATISTICSSIGNALS] = {"rad/s", "kNm", "deg", "deg", "deg", "kNm", "deg", "-"};
+
+static void setFatigueParams(ikRainflowParams *params, double samplePeriod) {
+    int i;
+
+    /*
+    ####################################################################
+                     Fatigue
+
+    Set parameters here, in the order of fatigueNames:
+    */
+    const double maximumRange[IKDISCON_NFATIGUESIGNALS] = {250.0, 30.0, 2.0}; /* kNm, deg, m/s^2 */
+    const double wohlerExponent[IKDISCON_NFATIGUESIGNALS] = {4.0, 3.0, 4.0}; /* - */
+    const double referenceFrequency = 1.0; /* Hz */
+    /*
+    ####################################################################
+    */
+
+    for (i = 0; i < IKDISCON_NFATIGUESIGNALS; i++) {
+        ikRainflow_initParams(&(params[i]));
+        params[i].maximumRange = maximumRange[i];
+        params[i].wohlerExponent = wohlerExponent[i];
+        params[i].referenceFrequency = referenceFrequency;
+        params[i].samplePeriod = samplePeriod;
+    }
+}
+
+static void writeFatigue(const ikDiscon *self) {
+    FILE *f = fopen(self->fatigueFileName, "w");
+    double del, cycles;
+    int i;
+
+    if (NULL == f) return;
+    fprintf(f, "# signal\tunit\tWohler exponent\tdamage equivalent load\tcycles\n");
+    for (i = 0; i < IKDISCON_NFATIGUESIGNALS; i++) {
+        ikRainflow_getOutput(&(self->fatigue[i]), &del, "damage equivalent load");
+        ikRainflow_getOutput(&(self->fatigue[i]), &cycles, "cycles");
+        fprintf(f, "%s\t%s\t%g\t%.9g\t%.9g\n", fatigueNames[i], fatigueUnits[i], self->fatigue[i].exponent, del, cycles);
+    }
+    fclose(f);
+}
+
+static void writeStatistics(const ikDiscon *self) {
+    FILE *f = fopen(self->statisticsFileName, "w");
+    const ikSigstats *stats = &(self->statistics);
+    char name[IKSIGSTATS_MAXNAME + 32];
+    double value;
+    int i, k;
+
+    if (NULL == f) return;
+    ikSigstats_getOutput(stats, &value, "samples");
+    fprintf(f, "# %.0f samples\n# signal\tunit\tmean\tstandard deviation\tminimum\tmaximum", value);
+    for (k = 0; k < stats->nQuantiles; k++) fprintf(f, "\tquantile %g", stats->quantiles[k]);
+    fprintf(f, "\n");
+    for (i = 0; i < NSTATISTICSSIGNALS; i++) {
+        fprintf(f, "%s\t%s", statisticsNames[i], statisticsUnits[i]);
+        sprintf(name, "%s mean", statisticsNames[i]);
+        ikSigstats_getOutput(stats, &value, name);
+        fprintf(f, "\t%.9g", value);
+        sprintf(name, "%s standard deviation", statisticsNames[i]);
+        ikSigstats_getOutput(stats, &value, name);
+        fprintf(f, "\t%.9g", value);
+        sprintf(name, "%s minimum", statisticsNames[i]);
+        ikSigstats_getOutput(stats, &value, name);
+        fprintf(f, "\t%.9g", value);
+        sprintf(name, "%s maximum", statisticsNames[i]);
+        ikSigstats_getOutput(stats, &value, name);
+        fprintf(f, "\t%.9g", value);
+        for (k = 0; k < stats->nQuantiles; k++) {
+            sprintf(name, "%s quantile %d", statisticsNames[i], k + 1);
+            ikSigstats_getOutput(stats, &value, name);
+            fprintf(f, "\t%.9g", value);
+        }
+        fprintf(f, "\n");
+    }
+
+    /* the state occupancy */
+    fprintf(f, "# signal\tstate\toccupancy\n");
+    for (i = 0; i < NSTATISTICSSIGNALS; i++) {
+        for (k = 0; k < stats->signals[i].nStates; k++) {
+            sprintf(name, "%s occupancy %d", statisticsNames[i], k);
+            ikSigstats_getOutput(stats, &value, name);
+            fprintf(f, "%s\t%d\t%.9g\n", statisticsNames[i], k, value);
+        }
+    }
+    fclose(f);
+}
+
+static void setEventRecorderParams(ikTrigrecParams *params, double maximumSpeed) {
+    int i;
+
+    /*
+    ####################################################################
+                     Event recorder
+
+    Set parameters here:
+    */
+    const double preTriggerTime = 10.0; /* s */
+    const double postTriggerTime = 20.0; /* s */
+    const double overspeed = 1.1*maximumSpeed; /* rad/s */
+    /*
+    ####################################################################
+    */
+
+    params->log.nSignals = NEVENTSIGNALS;
+    for (i = 0; i < NEVENTSIGNALS; i++) {
+        params->log.names[i] = eventNames[i];
+        params->log.units[i] = eventUnits[i];
+    }
+    params->preTriggerTime = preTriggerTime;
+    params->postTriggerTime = postTriggerTime;
+
+    /* below/above rated switches */
+    params->triggers[0].enable = 1;
+    params->triggers[0].signal = 7;
+    params->triggers[0].type = IKTRIGREC_CHANGE;
+
+    /* torque control reaching the maximum torque */
+    params->triggers[1].enable = 1;
+    params->triggers[1].signal = 8;
+    params->triggers[1].type = IKTRIGREC_FALLING;
+    params->triggers[1].level = 0.0;
+
+    /* over-speed */
+    params->triggers[2].enable = 1;
+    params->triggers[2].signal = 0;
+    params->triggers[2].type = IKTRIGREC_RISING;
+    params->triggers[2].level = overspeed;
+}
+
+/* override the switches with those named in the file, ignoring any other lines */
+static void readSwitches(ikDiscon *self, const char *INFILE, int length) {
+    char fileName[1024];
+    char line[256];
+    char name[256];
+    int value;
+    int n;
+    FILE *f;
+
+    for (n = 0; n < (int) sizeof(fileName) - 1 && (length <= 0 || n < length) && '\0' != INFILE[n]; n++) fileName[n] = INFILE[n];
+    fileName[n] = '\0';
+    if (0 == n) return;
+    f = fopen(fileName, "r");
+    if (NULL == f) return;
+    while (NULL != fgets(line, sizeof(line), f)) {
+        if (2 != sscanf(line, "%255s %d", name, &value) || (0 != value && 1 != value)) continue;
+        if (!strcmp(name, "parameterCache")) self->parameterCache = value;
+        else if (!strcmp(name, "fullLog")) self->fullLog = value;
+        else if (!strcmp(name, "eventRecording")) self->eventRecording = value;
+        else if (!strcmp(name, "fatigue")) self->fatigueCounting = value;
+        else if (!strcmp(name, "statistics")) self->statisticsKeeping = value;
+        else if (!strcmp(name, "liveMonitor")) self->liveMonitor = value;
+    }
+    fclose(f);
+}
+
+int ikDiscon_init(ikDiscon *self, const ikDisconParams *params) {
+    ikParcacheParams cacheParams;
+
+    /* register the file names */
+    if (NULL == params->filePrefix || strlen(params->filePrefix) >= IKDISCON_MAXPREFIX) return -1;
+    sprintf(self->logFileName, "%slog.bin", params->filePrefix);
+    sprintf(self->eventPrefix, "%sevent", params->filePrefix);
+    sprintf(self->socketPath, "%sopendiscon.sock", params->filePrefix);
+    sprintf(self->fatigueFileName, "%sfatigue.txt", params->filePrefix);
+    sprintf(self->statisticsFileName, "%sstatistics.txt", params->filePrefix);
+    ikParcache_initParams(&cacheParams);
+    cacheParams.fileName = params->cacheFileName;
+    if (ikParcache_init(&(self->cache), &cacheParams)) return -2;
+    self->parameterCache = params->parameterCache;
+    self->fullLog = params->fullLog;
+    self->eventRecording = params->eventRecording;
+    self->fatigueCounting = params->fatigue;
+    self->statisticsKeeping = params->statistics;
+    self->liveMonitor = params->liveMonitor;
+    self->monitoring = 0;
+
+    return 0;
+}
+
+void ikDiscon_initParams(ikDisconParams *params) {
+    params->filePrefix = "";
+    params->cacheFileName = "parcache.bin";
+    params->parameterCache = 0;
+    params->fullLog = 1;
+    params->eventRecording = 0;
+    params->fatigue = 0;
+    params->statistics = 0;
+    params->liveMonitor = 0;
+}
+
+void ikDiscon_step(ikDiscon *self, float *DATA, int FLAG, const char *INFILE, const char *OUTNAME, char *MESSAGE) {
+    ikClwindconWTCon *con = &(self->con);
+    int i;
+    int state;
+    double logValues[NLOGSIGNALS];
+    double eventValues[NEVENTSIGNALS];
+    double monitorValues[NMONITORSIGNALS];
+    double statisticsValues[NSTATISTICSSIGNALS];
+    const double deratingRatio = 0.2; /* later to be got via the supercontroller interface */
+
+    (void) FLAG;
+    (void) OUTNAME;
+    (void) MESSAGE;
+
+    if (NINT(DATA[0]) == 0) {
+        ikClwindconWTConParams param;
+        ikSiglogParams logParams;
+        ikTrigrecParams recorderParams;
+        ikMonitorParams monitorParams;
+        ikRainflowParams fatigueParams[IKDISCON_NFATIGUESIGNALS];
+        ikSigstatsParams statisticsParams;
+        if (NULL != INFILE) readSwitches(self, INFILE, NINT(DATA[49]));
+        memset(&param, 0, sizeof(param)); /* padding included, as the cache is keyed on the parameter bytes */
+        ikClwindconWTCon_initParams(&param);
+        setParams(&param);
+        if (self->parameterCache) ikParcache_initController(&(self->cache), con, &param);
+        else ikClwindconWTCon_init(con, &param);
+
+        ikSiglog_initParams(&logParams);
+        logParams.fileName = self->logFileName;
+        logParams.nSignals = NLOGSIGNALS;
+        for (i = 0; i < NLOGSIGNALS; i++) {
+            logParams.names[i] = logNames[i];
+            logParams.units[i] = logUnits[i];
+        }
+        logParams.samplePeriod = (double) DATA[2]; /* s */
+        logParams.startTime = (double) DATA[1]; /* s */
+        logParams.pyramidLevels = 4; /* min/max/mean over 0.16 s, 2.56 s, 41 s and 11 min at 100 Hz, for browsing */
+        if (self->fullLog) ikSiglog_init(&(self->log), &logParams);
+
+        ikTrigrec_initParams(&recorderParams);
+        recorderParams.filePrefix = self->eventPrefix;
+        recorderParams.log.samplePeriod = (double) DATA[2]; /* s */
+        setEventRecorderParams(&recorderParams, 480.0/30*3.1416);
+        if (self->eventRecording) ikTrigrec_init(&(self->recorder), &recorderParams);
+
+        setFatigueParams(fatigueParams, (double) DATA[2]);
+        for (i = 0; i < IKDISCON_NFATIGUESIGNALS; i++) {
+            if (self->fatigueCounting) ikRainflow_init(&(self->fatigue[i]), &(fatigueParams[i]));
+        }
+
+        ikSigstats_initParams(&statisticsParams);
+        statisticsParams.nSignals = NSTATISTICSSIGNALS;
+        for (i = 0; i < NSTATISTICSSIGNALS; i++) {
+            statisticsParams.names[i] = statisticsNames[i];
+        }
+        statisticsParams.nStates[NSTATISTICSSIGNALS - 1] = 2; /* below and above rated */
+        if (self->statisticsKeeping) ikSigstats_init(&(self->statistics), &statisticsParams);
+
+        ikMonitor_initParams(&monitorParams);
+        monitorParams.socketPath = self->socketPath;
+        monitorParams.nSignals = NMONITORSIGNALS;
+        for (i = 0; i < NMONITORSIGNALS; i++) {
+            monitorParams.names[i] = monitorNames[i];
+        }
+        if (self->liveMonitor) self->monitoring = !ikMonitor_init(&(self->monitor), &monitorParams);
+    }
+//TODO lower maximum torque according to maximum power with derating (it may be time to bring the power manager back)
+    con->in.deratingRatio = deratingRatio;
+    con->in.externalMaximumTorque = 230.0; /* kNm */
+    con->in.externalMinimumTorque = 0.0; /* kNm */
+    con->in.externalMaximumPitch = 90.0; /* deg */
+    con->in.externalMinimumPitch = 0.0; /* deg */
+    con->in.generatorSpeed = (double) DATA[19]; /* rad/s */
+    con->in.maximumSpeed = 480.0/30*3.1416; /* rpm to rad/s */
+
+    state = ikClwindconWTCon_step(con);
+
+    DATA[46] = (float) (con->out.torqueDemand*1.0e3); /* kNm to Nm */
+    DATA[41] = (float) (con->out.pitchDemandBlade1/180.0*3.1416); /* deg to rad */
+    DATA[42] = (float) (con->out.pitchDemandBlade2/180.0*3.1416); /* deg to rad */
+    DATA[43] = (float) (con->out.pitchDemandBlade3/180.0*3.1416); /* deg to rad */
+    DATA[44] = (float) (con->out.pitchDemandBlade1/180.0*3.1416); /* deg to rad (collective pitch angle) */
+
+    if (self->fullLog) {
+        for (i = 0; i < NLOGSIGNALS; i++) {
+            ikClwindconWTCon_getOutput(con, &(logValues[i]), logNames[i]);
+        }
+        ikSiglog_write(&(self->log), logValues);
+    }
+
+    if (self->eventRecording) {
+        eventValues[0] = con->in.generatorSpeed;
+        eventValues[1] = con->out.torqueDemand;
+        eventValues[2] = con->out.pitchDemandBlade1;
+        ikClwindconWTCon_getOutput(con, &(eventValues[3]), "maximum torque");
+        ikClwindconWTCon_getOutput(con, &(eventValues[4]), "minimum torque");
+        ikClwindconWTCon_getOutput(con, &(eventValues[5]), "maximum pitch");
+        ikClwindconWTCon_getOutput(con, &(eventValues[6]), "minimum pitch");
+        eventValues[7] = (double) state;
+        ikClwindconWTCon_getOutput(con, &(eventValues[8]), "torque demand from torque control");
+        eventValues[8] = eventValues[3] - eventValues[8];
+        ikTrigrec_step(&(self->recorder), (double) DATA[1], eventValues);
+    }
+
+    if (self->fatigueCounting) {
+        ikRainflow_step(&(self->fatigue[0]), con->out.torqueDemand);
+        ikRainflow_step(&(self->fatigue[1]), con->out.pitchDemandBlade1);
+        ikRainflow_step(&(self->fatigue[2]), (double) DATA[52]);
+    }
+
+    if (self->statisticsKeeping) {
+        statisticsValues[0] = con->in.generatorSpeed;
+        statisticsValues[1] = con->out.torqueDemand;
+        statisticsValues[2] = con->out.pitchDemandBlade1;
+        statisticsValues[3] = con->out.pitchDemandBlade2;
+        statisticsValues[4] = con->out.pitchDemandBlade3;
+        ikClwindconWTCon_getOutput(con, &(statisticsValues[5]), "maximum torque from power manager");
+        ikClwindconWTCon_getOutput(con, &(statisticsValues[6]), "minimum pitch from power manager");
+        statisticsValues[7] = (double) state;
+        ikSigstats_step(&(self->statistics), statisticsValues);
+    }
+
+    if (self->monitoring) {
+        monitorValues[0] = con->in.generatorSpeed;
+        monitorValues[1] = (double) state;
+        for (i = 2; i < NMONITORSIGNALS; i++) {
+            monitorValues[i] = 0.0;
+            ikClwindconWTCon_getOutput(con, &(monitorValues[i]), monitorNames[i]);
+        }
+        ikMonitor_publish(&(self->monitor), (double) DATA[1], monitorValues);
+    }
+
+    if (NINT(DATA[0]) == -1) {
+        if (self->fullLog) ikSiglog_close(&(self->log));
+        if (self->eventRecording) ikTrigrec_close(&(self->recorder));
+        if (self->fatigueCounting) writeFatigue(self);
+        if (self->statisticsKeeping) writeStatistics(self);
+        if (self->parameterCache) ikParcache_close(&(self->cache));
+        if (self->monitoring) ikMonitor_close(&(self->monitor));
+        self->monitoring = 0;
+    }
+}
+
+/* @endcond */
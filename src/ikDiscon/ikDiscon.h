@@ -0,0 +1,141 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikDiscon.h
+ *
+ * @brief Class ikDiscon interface
+ */
+
+#ifndef IKDISCON_H
+#define IKDISCON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ikClwindconWTConfig.h"
+#include "ikSiglog.h"
+#include "ikTrigrec.h"
+#include "ikMonitor.h"
+#include "ikRainflow.h"
+#include "ikParcache.h"
+#include "ikSigstats.h"
+
+#define IKDISCON_MAXPREFIX 92 /**<maximum length of the file prefix, including the terminating NULL*/
+#define IKDISCON_NFATIGUESIGNALS 3 /**<number of signals counted for fatigue: torque demand, collective pitch demand and tower top fore-aft acceleration*/
+
+    /**
+     * @struct ikDiscon
+     * @brief Controller behind the DISCON interface
+     *
+     * An instance holds everything DISCON keeps between calls: the
+     * controller, the initialised controller cache, the full log, the event
+     * recorder, the rainflow counters of the fatigue signals, the summary
+     * statistics and the live monitor. All but the controller are optional.
+     * The full log is on by default, and the rest off, as they write files
+     * and take most of the time of a step when on. The switches given at
+     * initialisation can be overridden at run time by the file named by
+     * INFILE, see @link ikDiscon_step @endlink. DISCON itself runs a single
+     * instance, and a simulation running several turbines in one process
+     * runs an instance per turbine, each with the file names given their own
+     * prefix.
+     *
+     * @par Inputs and outputs
+     * @li swap array: see @link ikDiscon_step @endlink
+     *
+     * @par Methods
+     * @li @link ikDiscon_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikDiscon_init @endlink initialise an instance
+     * @li @link ikDiscon_step @endlink execute periodic calculations
+     */
+    typedef struct ikDiscon {
+        /* @cond */
+        ikClwindconWTCon con;
+        ikParcache cache;
+        ikSiglog log;
+        ikTrigrec recorder;
+        ikMonitor monitor;
+        ikRainflow fatigue[IKDISCON_NFATIGUESIGNALS];
+        ikSigstats statistics;
+        int parameterCache;
+        int fullLog;
+        int eventRecording;
+        int fatigueCounting;
+        int statisticsKeeping;
+        int liveMonitor;
+        int monitoring;
+        char logFileName[IKSIGLOG_MAXNAME];
+        char eventPrefix[IKSIGLOG_MAXNAME];
+        char socketPath[IKMONITOR_MAXNAME];
+        char fatigueFileName[IKSIGLOG_MAXNAME];
+        char statisticsFileName[IKSIGLOG_MAXNAME];
+        /* @endcond */
+    } ikDiscon;
+
+    /**
+     * @struct ikDisconParams
+     * @brief Controller behind the DISCON interface initialisation parameters
+     */
+    typedef struct ikDisconParams {
+        const char *filePrefix; /**<prefix of the log file, event file, fatigue file, statistics file and monitor socket names, shorter than @link IKDISCON_MAXPREFIX @endlink. It may include a directory. The default value is ""*/
+        const char *cacheFileName; /**<initialised controller cache file name, see @link ikParcache @endlink, not prefixed, so that instances with the same parameters share it. The default value is "parcache.bin"*/
+        int parameterCache; /**<1 to initialise the controller from the cache file when it holds it, and write it otherwise, 0 to always initialise it. The default value is 0*/
+        int fullLog; /**<1 to write every sample of the log signals to the log file, log.bin, with a min/max/mean pyramid. The default value is 1*/
+        int eventRecording; /**<1 to record transients of the event signals to the event files, event_nnnn.bin. The default value is 0*/
+        int fatigue; /**<1 to count the load cycles of the fatigue signals and write their damage-equivalent loads to the fatigue file, fatigue.txt. The default value is 0*/
+        int statistics; /**<1 to keep summary statistics of the statistics signals and write them to the statistics file, statistics.txt. The default value is 0*/
+        int liveMonitor; /**<1 to serve the monitor signals on the Unix-domain socket opendiscon.sock (not on Windows). The default value is 0*/
+    } ikDisconParams;
+
+    /**
+     * Initialise an instance. The controller itself is initialised by the
+     * first call to @link ikDiscon_step @endlink, as required by the
+     * DISCON interface.
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid file prefix
+     * @li -2: invalid cache file name
+     */
+    int ikDiscon_init(ikDiscon *self, const ikDisconParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikDiscon_initParams(ikDisconParams *params);
+
+    /**
+     * Execute periodic calculations, with the arguments of DISCON
+     * @param self instance
+     * @param DATA swap array: status (0 first call, 1 regular call, -1 last call), time in s, sample period in s, generator speed in rad/s and tower top fore-aft acceleration in m/s^2 are read, and the torque demand in Nm and the pitch demands in rad are written
+     * @param FLAG unused
+     * @param INFILE name of a file read at the first call, if not empty, with DATA[49] characters if positive, and NULL terminated otherwise. Its lines "parameterCache N", "fullLog N", "eventRecording N", "fatigue N", "statistics N" and "liveMonitor N", with N 1 or 0, override the switches of @link ikDisconParams @endlink. Other lines are ignored, so that the file may hold other settings too
+     * @param OUTNAME unused
+     * @param MESSAGE unused
+     */
+    void ikDiscon_step(ikDiscon *self, float *DATA, int FLAG, const char *INFILE, const char *OUTNAME, char *MESSAGE);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKDISCON_H */
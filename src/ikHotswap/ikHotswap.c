@@ -0,0 +1,166 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikHotswap.c
+ *
+ * @brief Class ikHotswap implementation
+ */
+
+/* @cond */
+
+#include <string.h>
+
+#include "ikHotswap.h"
+
+/* slot states */
+#define FREE 0
+#define PREPARING 1
+#define PENDING 2
+#define INUSE 3
+
+int ikHotswap_init(ikHotswap *self, const ikHotswapParams *params) {
+    int i;
+
+    /* register the settling time */
+    if (params->settlingSteps < 1) return -1;
+    self->settlingSteps = params->settlingSteps;
+
+    /* initialise the first instance */
+    if (ikClwindconWTCon_init(&(self->slots[0]), &(params->controller))) return -2;
+    self->slotParams[0] = params->controller;
+    self->slotState[0] = INUSE;
+    for (i = 1; i < IKHOTSWAP_NSLOTS; i++) self->slotState[i] = FREE;
+    self->pending = -1;
+    self->steps = 0;
+    self->active = 0;
+    self->swaps = 0;
+    ikAtomic_fence();
+
+    return 0;
+}
+
+void ikHotswap_initParams(ikHotswapParams *params) {
+    ikClwindconWTCon_initParams(&(params->controller));
+    params->settlingSteps = 3000;
+}
+
+/* read the record of a step, returning -1 if the step thread may have overwritten it meanwhile */
+static int readStep(ikHotswap *self, unsigned long k, ikHotswapStep *step) {
+    *step = self->history[k % IKHOTSWAP_NHISTORY];
+    ikAtomic_fence();
+    return (unsigned long) ikAtomic_load(&(self->steps)) - k < IKHOTSWAP_NHISTORY ? 0 : -1;
+}
+
+int ikHotswap_publish(ikHotswap *self, const ikClwindconWTConParams *params) {
+    ikHotswapStep step;
+    unsigned long n;
+    unsigned long k;
+    long previous;
+    int i;
+
+    /* claim a spare instance */
+    for (i = 0; i < IKHOTSWAP_NSLOTS; i++) {
+        if (ikAtomic_compareExchange(&(self->slotState[i]), FREE, PREPARING)) break;
+    }
+    if (IKHOTSWAP_NSLOTS == i) return -1;
+
+    /* initialise it, away from the step thread */
+    if (ikClwindconWTCon_init(&(self->slots[i]), params)) {
+        ikAtomic_store(&(self->slotState[i]), FREE);
+        return -2;
+    }
+    self->slotParams[i] = *params;
+
+    /* settle it on the recorded steps, if any: trim it at the oldest one taken */
+    n = (unsigned long) ikAtomic_load(&(self->steps));
+    if (n > 0) {
+        k = n > IKHOTSWAP_NHISTORY/2 ? n - IKHOTSWAP_NHISTORY/2 : 0;
+        while (readStep(self, k, &step)) k = (unsigned long) ikAtomic_load(&(self->steps)) - 1;
+        self->slots[i].in = step.in;
+        ikClwindconWTCon_trim(&(self->slots[i]), step.torque, step.pitch, self->settlingSteps);
+
+        /* and follow the rest up to the latest, skipping ahead if they are overwritten meanwhile */
+        for (k++; k != (n = (unsigned long) ikAtomic_load(&(self->steps))); k++) {
+            if (readStep(self, k, &step)) {
+                k = n - 1;
+                if (readStep(self, k, &step)) continue;
+            }
+            self->slots[i].in = step.in;
+            ikClwindconWTCon_track(&(self->slots[i]), step.torque, step.pitch);
+        }
+    }
+
+    /* hand it over, releasing any set that has not been picked up yet */
+    ikAtomic_store(&(self->slotState[i]), PENDING);
+    previous = ikAtomic_exchange(&(self->pending), (long) i);
+    if (previous >= 0) ikAtomic_store(&(self->slotState[previous]), FREE);
+
+    return 0;
+}
+
+int ikHotswap_step(ikHotswap *self) {
+    ikClwindconWTCon *con;
+    ikHotswapStep *step;
+    int adopted = 0;
+    int state;
+
+    /* adopt a newly published parameter set, carrying on from the active instance */
+    if (ikAtomic_load(&(self->pending)) >= 0) {
+        long candidate = ikAtomic_exchange(&(self->pending), -1);
+        if (candidate >= 0) {
+            ikAtomic_store(&(self->slotState[candidate]), INUSE);
+            ikClwindconWTCon_seed(&(self->slots[candidate]), &(self->slotParams[candidate]),
+                    &(self->slots[self->active]), &(self->slotParams[self->active]));
+            ikAtomic_store(&(self->slotState[self->active]), FREE);
+            self->active = (int) candidate;
+            self->swaps++;
+            adopted = 1;
+        }
+    }
+
+    /* run the active instance, holding the control actions of the old one if just adopted */
+    con = &(self->slots[self->active]);
+    con->in = self->in;
+    if (adopted) state = ikClwindconWTCon_track(con, con->priv.torqueFromTorqueCon, con->priv.collectivePitchDemand);
+    else state = ikClwindconWTCon_step(con);
+    self->out = con->out;
+
+    /* record the step for the publishing threads, and only then count it */
+    step = &(self->history[(unsigned long) self->steps % IKHOTSWAP_NHISTORY]);
+    step->in = con->in;
+    step->torque = con->priv.torqueFromTorqueCon;
+    step->pitch = con->priv.collectivePitchDemand;
+    ikAtomic_fetchAdd(&(self->steps), 1);
+
+    return state;
+}
+
+int ikHotswap_getOutput(const ikHotswap *self, double *output, const char *name) {
+    /* pick up the signal names */
+    if (!strcmp(name, "swaps")) {
+        *output = self->swaps;
+        return 0;
+    }
+
+    /* pass on to the active instance */
+    return ikClwindconWTCon_getOutput(&(self->slots[self->active]), output, name);
+}
+
+/* @endcond */
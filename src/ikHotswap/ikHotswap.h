@@ -0,0 +1,181 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikHotswap.h
+ *
+ * @brief Class ikHotswap interface
+ */
+
+#ifndef IKHOTSWAP_H
+#define IKHOTSWAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ikClwindconWTCon.h"
+#include "ikAtomic.h"
+
+#define IKHOTSWAP_NSLOTS 3 /**<number of controller instances: the active one, one waiting to be adopted and one being prepared*/
+#define IKHOTSWAP_NHISTORY 1024 /**<number of past steps recorded for new parameter sets to settle on, a power of 2. Those of the older half are taken, so that the step thread does not overwrite them while they are read*/
+
+    /* @cond */
+
+    typedef struct ikHotswapStep {
+        ikClwindconWTConInputs in;
+        double torque;
+        double pitch;
+    } ikHotswapStep;
+
+    /* @endcond */
+
+    /**
+     * @struct ikHotswap
+     * @brief Controller with runtime parameter hot-swap
+     *
+     * This wraps @link ikClwindconWTCon @endlink so that new parameters can
+     * be published from another thread while the controller runs, without
+     * locks and without disturbing the control loop.
+     *
+     * The step thread records the inputs and the torque and pitch control
+     * actions of its last @link IKHOTSWAP_NHISTORY @endlink steps, and the
+     * publishing thread initialises a spare controller instance with the
+     * new parameters and settles it on them: it is trimmed, with
+     * @link ikClwindconWTCon_trim @endlink, at the operating point of the
+     * oldest step it takes, and then follows the rest of them up to the
+     * latest with @link ikClwindconWTCon_track @endlink, holding the control
+     * actions the active instance took. This is where the parameter copy,
+     * the settling steps and any other initialisation cost go, and it leaves
+     * the filters of the new instance where those of the active one are.
+     * The records are read without locking, checking afterwards against a
+     * step counter that the step thread had not overwritten them meanwhile.
+     * The new instance is then handed over to the step thread with a single
+     * atomic exchange. At its next step, the step thread seeds the new
+     * instance from the active one with @link ikClwindconWTCon_seed @endlink,
+     * and steps it as the active one straight away, holding the control
+     * actions of the old one once more, so that the integrators of the
+     * control loops with new parameters take up any remaining offset and
+     * the transfer is bumpless. The old instance is handed back for reuse.
+     *
+     * The step thread never waits: a step costs one controller step, plus an
+     * atomic load and the record of the step, and the step adopting a
+     * parameter set a copy of the instance state besides. If a
+     * parameter set is published while another one is still waiting to be
+     * adopted, the newer one replaces it.
+     *
+     * @par Inputs
+     * @li as for @link ikClwindconWTCon @endlink, specify via @link ikClwindconWTConInputs @endlink at @link in @endlink
+     *
+     * @par Outputs
+     * @li as for @link ikClwindconWTCon @endlink, get via @link ikClwindconWTConOutputs @endlink at @link out @endlink
+     * @li swaps: number of parameter sets adopted, get via @link ikHotswap_getOutput @endlink
+     *
+     * @par Public members
+     * @li @link in @endlink inputs
+     * @li @link out @endlink outputs
+     *
+     * @par Methods
+     * @li @link ikHotswap_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikHotswap_init @endlink initialise an instance
+     * @li @link ikHotswap_publish @endlink publish a new parameter set, from any thread
+     * @li @link ikHotswap_step @endlink execute periodic calculations
+     * @li @link ikHotswap_getOutput @endlink get output value
+     */
+    typedef struct ikHotswap {
+        ikClwindconWTConInputs in; /**<inputs*/
+        ikClwindconWTConOutputs out; /**<outputs*/
+        /* @cond */
+        ikClwindconWTCon slots[IKHOTSWAP_NSLOTS];
+        ikClwindconWTConParams slotParams[IKHOTSWAP_NSLOTS];
+        ikAtomicInt slotState[IKHOTSWAP_NSLOTS];
+        ikAtomicInt pending;
+        ikHotswapStep history[IKHOTSWAP_NHISTORY];
+        ikAtomicInt steps;
+        int active;
+        int settlingSteps;
+        int swaps;
+        /* @endcond */
+    } ikHotswap;
+
+    /**
+     * @struct ikHotswapParams
+     * @brief Controller with runtime parameter hot-swap initialisation parameters
+     */
+    typedef struct ikHotswapParams {
+        ikClwindconWTConParams controller; /**<initial controller parameters*/
+        int settlingSteps; /**<number of steps a new parameter set is trimmed over, at the operating point of the oldest recorded step it settles on, at the cost of as many controller steps in @link ikHotswap_publish @endlink, at least 1. The default value is 3000*/
+    } ikHotswapParams;
+
+    /**
+     * Initialise an instance
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid number of settling steps, it must be positive
+     * @li -2: controller initialisation failed
+     */
+    int ikHotswap_init(ikHotswap *self, const ikHotswapParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikHotswap_initParams(ikHotswapParams *params);
+
+    /**
+     * Publish a new parameter set. This may be called from any thread.
+     * @param self instance
+     * @param params new controller parameters
+     * @return error code:
+     * @li 0: no error, the parameter set will be adopted from the next step
+     * @li -1: busy, all spare instances are in use by earlier parameter sets, try again later
+     * @li -2: controller initialisation failed, the parameter set is discarded
+     */
+    int ikHotswap_publish(ikHotswap *self, const ikClwindconWTConParams *params);
+
+    /**
+     * Execute periodic calculations
+     * @param self instance
+     * @return state
+     * @li 0: below rated
+     * @li 1: above rated
+     */
+    int ikHotswap_step(ikHotswap *self);
+
+    /**
+     * Get output value by name. Besides "swaps", all the
+     * signals of @link ikClwindconWTCon_getOutput @endlink are available,
+     * from the active controller instance.
+     * @param self instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     * @li -2: invalid block name
+     */
+    int ikHotswap_getOutput(const ikHotswap *self, double *output, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKHOTSWAP_H */
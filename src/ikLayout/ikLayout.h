@@ -0,0 +1,53 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikLayout.h
+ *
+ * @brief Memory layout of the controller state
+ *
+ * The state of each class is ordered so that the members read and written
+ * at every step come first, packed together. The members kept only for
+ * @link ikClwindconWTCon_getOutput @endlink are kept apart, in a single
+ * diagnostics block at the end of the controller instance, which the
+ * sub-blocks write through a pointer given at initialisation. Building with
+ * OPENDISCON_NO_DIAGNOSTICS defined compiles the diagnostics block out, along
+ * with the signals it provides.
+ * @li IKLAYOUT_CACHELINE: cache line size, in bytes
+ * @li IKLAYOUT_ALIGNED: placed before a member declaration, aligns it, and the structure holding it, to a cache line
+ * @li IKLAYOUT_CACHELINES(size): number of cache lines taken by size bytes
+ * @li IKLAYOUT_ASSERT(name, condition): at file scope, fails to compile unless the constant condition holds, declaring a type called name
+ */
+
+#ifndef IKLAYOUT_H
+#define IKLAYOUT_H
+
+#define IKLAYOUT_CACHELINE 64
+
+#if defined(_MSC_VER)
+#define IKLAYOUT_ALIGNED __declspec(align(64))
+#else
+#define IKLAYOUT_ALIGNED __attribute__((aligned(64)))
+#endif
+
+#define IKLAYOUT_CACHELINES(size) (((size) + IKLAYOUT_CACHELINE - 1)/IKLAYOUT_CACHELINE)
+
+#define IKLAYOUT_ASSERT(name, condition) typedef char name[(condition) ? 1 : -1]
+
+#endif /* IKLAYOUT_H */
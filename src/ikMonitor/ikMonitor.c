@@ -0,0 +1,266 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikMonitor.c
+ *
+ * @brief Class ikMonitor implementation
+ */
+
+/* @cond */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ikMonitor.h"
+
+#ifndef _WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static void copySnapshot(ikMonitor *self, double *time, double *values) {
+    long before;
+    long after = -1;
+
+    /* retry while the step thread is writing, or has written meanwhile */
+    do {
+        before = ikAtomic_load(&(self->sequence));
+        if (before & 1) continue;
+        *time = self->time;
+        memcpy(values, self->values, self->nSignals*sizeof(double));
+        ikAtomic_fence();
+        after = ikAtomic_load(&(self->sequence));
+    } while ((before & 1) || before != after);
+}
+
+static int formatFrame(const ikMonitor *self, char *frame, double time, const double *values) {
+    int len;
+    int i;
+
+    if (IKMONITOR_BINARY == self->format) {
+        memcpy(frame, &time, sizeof(double));
+        memcpy(frame + sizeof(double), values, self->nSignals*sizeof(double));
+        return (int) ((self->nSignals + 1)*sizeof(double));
+    }
+
+    len = sprintf(frame, "%.9g", time);
+    for (i = 0; i < self->nSignals; i++) len += sprintf(frame + len, "\t%.9g", values[i]);
+    frame[len++] = '\n';
+    return len;
+}
+
+static void closeClient(ikMonitorClient *client) {
+    close(client->fd);
+    client->fd = -1;
+}
+
+static void flushClient(ikMonitorClient *client) {
+    ssize_t sent;
+
+    /* send what fits in the socket buffer, keep the rest for later */
+    while (client->pendingBytes > 0) {
+        sent = send(client->fd, client->pending + client->pendingOffset, client->pendingBytes, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno) closeClient(client);
+            return;
+        }
+        client->pendingOffset += (int) sent;
+        client->pendingBytes -= (int) sent;
+    }
+}
+
+static void acceptClient(ikMonitor *self) {
+    ikMonitorClient *client = NULL;
+    int fd;
+    int i;
+
+    fd = accept(self->listenFd, NULL, NULL);
+    if (fd < 0) return;
+    for (i = 0; i < IKMONITOR_MAXCLIENTS; i++) {
+        if (self->clients[i].fd < 0) {
+            client = &(self->clients[i]);
+            break;
+        }
+    }
+    if (NULL == client) {
+        close(fd);
+        return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    client->fd = fd;
+
+    /* start with the header line */
+    client->pendingOffset = 0;
+    client->pendingBytes = sprintf(client->pending, "# time");
+    for (i = 0; i < self->nSignals; i++) {
+        client->pendingBytes += sprintf(client->pending + client->pendingBytes, "\t%s", self->names[i]);
+    }
+    client->pending[client->pendingBytes++] = '\n';
+    flushClient(client);
+}
+
+static void *serve(void *arg) {
+    ikMonitor *self = (ikMonitor *) arg;
+    char frame[sizeof(self->clients[0].pending)];
+    double values[IKMONITOR_MAXSIGNALS];
+    double time;
+    struct pollfd listener;
+    long lastSequence = -1;
+    long sequence;
+    int len;
+    int i;
+
+    listener.fd = self->listenFd;
+    listener.events = POLLIN;
+    while (!ikAtomic_load(&(self->stop))) {
+        /* wait for the next frame, accepting clients meanwhile */
+        if (poll(&listener, 1, (int) (self->servePeriod*1.0e3)) > 0) {
+            acceptClient(self);
+            continue;
+        }
+
+        /* send the snapshot if it is new */
+        sequence = ikAtomic_load(&(self->sequence));
+        if (sequence == lastSequence) continue;
+        copySnapshot(self, &time, values);
+        lastSequence = sequence;
+        len = formatFrame(self, frame, time, values);
+        for (i = 0; i < IKMONITOR_MAXCLIENTS; i++) {
+            ikMonitorClient *client = &(self->clients[i]);
+            if (client->fd < 0) continue;
+
+            /* a client still busy with an earlier frame misses this one */
+            flushClient(client);
+            if (client->fd < 0 || client->pendingBytes > 0) continue;
+            memcpy(client->pending, frame, len);
+            client->pendingOffset = 0;
+            client->pendingBytes = len;
+            flushClient(client);
+        }
+    }
+
+    return NULL;
+}
+
+#endif
+
+int ikMonitor_init(ikMonitor *self, const ikMonitorParams *params) {
+#ifdef _WIN32
+    return -4;
+#else
+    struct sockaddr_un address;
+    int i;
+
+    self->running = 0;
+
+    /* register the signals */
+    if (params->nSignals < 1 || params->nSignals > IKMONITOR_MAXSIGNALS) return -1;
+    self->nSignals = params->nSignals;
+    for (i = 0; i < self->nSignals; i++) {
+        if (NULL == params->names[i] || strlen(params->names[i]) >= IKMONITOR_MAXNAME) return -1;
+        strcpy(self->names[i], params->names[i]);
+        self->values[i] = 0.0;
+    }
+
+    /* register the serving settings */
+    if (NULL == params->socketPath || strlen(params->socketPath) >= IKMONITOR_MAXNAME) return -2;
+    if (strlen(params->socketPath) >= sizeof(address.sun_path)) return -2;
+    strcpy(self->socketPath, params->socketPath);
+    if (IKMONITOR_TEXT != params->format && IKMONITOR_BINARY != params->format) return -2;
+    self->format = params->format;
+    if (params->servePeriod <= 0.0) return -2;
+    self->servePeriod = params->servePeriod;
+
+    /* create the socket */
+    self->listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (self->listenFd < 0) return -3;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, self->socketPath);
+    unlink(self->socketPath);
+    if (bind(self->listenFd, (struct sockaddr *) &address, sizeof(address)) || listen(self->listenFd, IKMONITOR_MAXCLIENTS)) {
+        close(self->listenFd);
+        return -3;
+    }
+    fcntl(self->listenFd, F_SETFL, fcntl(self->listenFd, F_GETFL) | O_NONBLOCK);
+
+    /* start serving */
+    for (i = 0; i < IKMONITOR_MAXCLIENTS; i++) self->clients[i].fd = -1;
+    self->sequence = 0;
+    self->time = 0.0;
+    self->stop = 0;
+    ikAtomic_fence();
+    if (pthread_create(&(self->thread), NULL, serve, self)) {
+        close(self->listenFd);
+        unlink(self->socketPath);
+        return -4;
+    }
+    self->running = 1;
+
+    return 0;
+#endif
+}
+
+void ikMonitor_initParams(ikMonitorParams *params) {
+    int i;
+
+    params->socketPath = "opendiscon.sock";
+    params->nSignals = 0;
+    for (i = 0; i < IKMONITOR_MAXSIGNALS; i++) params->names[i] = NULL;
+    params->format = IKMONITOR_TEXT;
+    params->servePeriod = 0.1;
+}
+
+void ikMonitor_publish(ikMonitor *self, double time, const double *values) {
+    long sequence = self->sequence;
+
+    /* an odd sequence number marks the snapshot as being written */
+    ikAtomic_store(&(self->sequence), sequence + 1);
+    ikAtomic_fence();
+    self->time = time;
+    memcpy(self->values, values, self->nSignals*sizeof(double));
+    ikAtomic_store(&(self->sequence), sequence + 2);
+}
+
+void ikMonitor_close(ikMonitor *self) {
+#ifndef _WIN32
+    int i;
+
+    if (!self->running) return;
+    ikAtomic_store(&(self->stop), 1);
+    pthread_join(self->thread, NULL);
+    self->running = 0;
+    for (i = 0; i < IKMONITOR_MAXCLIENTS; i++) {
+        if (self->clients[i].fd >= 0) closeClient(&(self->clients[i]));
+    }
+    close(self->listenFd);
+    unlink(self->socketPath);
+#endif
+}
+
+/* @endcond */
@@ -0,0 +1,156 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikMonitor.h
+ *
+ * @brief Class ikMonitor interface
+ */
+
+#ifndef IKMONITOR_H
+#define IKMONITOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "ikAtomic.h"
+
+#define IKMONITOR_MAXSIGNALS 32 /**<maximum number of monitored signals*/
+#define IKMONITOR_MAXCLIENTS 8 /**<maximum number of simultaneous clients*/
+#define IKMONITOR_MAXNAME 108 /**<maximum length of the socket path and of signal names, including the terminating NULL*/
+
+#define IKMONITOR_TEXT 0 /**<frames are lines of text*/
+#define IKMONITOR_BINARY 1 /**<frames are arrays of doubles*/
+
+    /* @cond */
+    typedef struct ikMonitorClient {
+        int fd;
+        int pendingBytes;
+        int pendingOffset;
+        char pending[8 + IKMONITOR_MAXSIGNALS*(IKMONITOR_MAXNAME + 1)];
+    } ikMonitorClient;
+    /* @endcond */
+
+    /**
+     * @struct ikMonitor
+     * @brief Live signal monitor
+     *
+     * The monitor serves a set of signals over a Unix-domain socket, for
+     * watching a running controller without writing logs.
+     *
+     * The step thread publishes the signal values with
+     * @link ikMonitor_publish @endlink, into a snapshot protected by a
+     * sequence lock: it copies the values between two increments of a
+     * sequence counter, and never waits. A background thread accepts
+     * clients, and at the serve period takes a consistent copy of the
+     * snapshot, retrying if the step thread was writing it, and sends it to
+     * every client whose socket has room for it. A slow client misses frames
+     * but blocks neither the server thread nor the step thread.
+     *
+     * On connection, clients get a text header line with the signal names,
+     * "# time", followed by the names, separated by tabs. Each frame is then
+     * either a text line with the time and the values separated by tabs, or,
+     * in binary format, the time and the values as doubles in host byte
+     * order.
+     *
+     * The monitor is not available on Windows, where
+     * @link ikMonitor_init @endlink fails.
+     *
+     * @par Methods
+     * @li @link ikMonitor_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikMonitor_init @endlink initialise an instance and start serving
+     * @li @link ikMonitor_publish @endlink publish the current signal values
+     * @li @link ikMonitor_close @endlink stop serving
+     */
+    typedef struct ikMonitor {
+        /* @cond */
+        int nSignals;
+        char names[IKMONITOR_MAXSIGNALS][IKMONITOR_MAXNAME];
+        char socketPath[IKMONITOR_MAXNAME];
+        int format;
+        double servePeriod;
+        ikAtomicInt sequence;
+        double time;
+        double values[IKMONITOR_MAXSIGNALS];
+        ikAtomicInt stop;
+        int listenFd;
+        ikMonitorClient clients[IKMONITOR_MAXCLIENTS];
+        int running;
+#ifndef _WIN32
+        pthread_t thread;
+#endif
+        /* @endcond */
+    } ikMonitor;
+
+    /**
+     * @struct ikMonitorParams
+     * @brief Live signal monitor initialisation parameters
+     */
+    typedef struct ikMonitorParams {
+        const char *socketPath; /**<path of the Unix-domain socket, shorter than @link IKMONITOR_MAXNAME @endlink. An existing socket file at this path is replaced. The default value is "opendiscon.sock"*/
+        int nSignals; /**<number of signals, between 1 and @link IKMONITOR_MAXSIGNALS @endlink. The default value is 0*/
+        const char *names[IKMONITOR_MAXSIGNALS]; /**<signal names, without tabs. The default value is {NULL, NULL, ...}*/
+        int format; /**<frame format: @link IKMONITOR_TEXT @endlink or @link IKMONITOR_BINARY @endlink. The default value is @link IKMONITOR_TEXT @endlink*/
+        double servePeriod; /**<time between frames sent to clients, in s of wall clock time. The default value is 0.1*/
+    } ikMonitorParams;
+
+    /**
+     * Initialise an instance, create the socket and start the server thread
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signals
+     * @li -2: invalid socket path, format or serve period
+     * @li -3: unable to create the socket
+     * @li -4: unable to start the server thread, or not available on this platform
+     */
+    int ikMonitor_init(ikMonitor *self, const ikMonitorParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikMonitor_initParams(ikMonitorParams *params);
+
+    /**
+     * Publish the current signal values. This is the only call meant for
+     * the step thread, and costs a copy of the values.
+     * @param self monitor instance
+     * @param time current time, in s
+     * @param values signal values, in the order given at initialisation
+     */
+    void ikMonitor_publish(ikMonitor *self, double time, const double *values);
+
+    /**
+     * Stop the server thread, disconnect the clients and remove the socket
+     * @param self monitor instance
+     */
+    void ikMonitor_close(ikMonitor *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKMONITOR_H */
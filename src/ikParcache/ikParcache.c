@@ -0,0 +1,223 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikParcache.c
+ *
+ * @brief Class ikParcache implementation
+ */
+
+/* @cond */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "ikParcache.h"
+#include "OpenDisconBuildId.h"
+
+static const char magic[8] = {'O', 'D', 'P', 'C', 'A', 'C', 'H', 'E'};
+
+typedef struct header {
+    char magic[8];
+    uint32_t version;
+    uint32_t instanceSize;
+    uint32_t paramsSize;
+    uint32_t reserved;
+    uint64_t key;
+    uint64_t checksum;
+} header;
+
+/* 64-bit FNV-1a, taking 8 bytes at a time */
+static uint64_t hash(const void *data, size_t n, uint64_t h) {
+    const unsigned char *p = (const unsigned char *) data;
+    uint64_t word;
+    size_t i;
+
+    for (i = 0; i + sizeof(word) <= n; i += sizeof(word)) {
+        memcpy(&word, p + i, sizeof(word));
+        h ^= word;
+        h *= 1099511628211ULL;
+    }
+    for (; i < n; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* the build identity first, so that files written by other builds do not match */
+static uint64_t keyOf(const ikClwindconWTConParams *params) {
+    const uint64_t buildId = OPENDISCON_BUILD_ID;
+    return hash(params, sizeof(ikClwindconWTConParams), hash(&buildId, sizeof(buildId), 14695981039346656037ULL));
+}
+
+static const unsigned char *mapCache(const char *fileName, size_t *size) {
+#ifndef _WIN32
+    struct stat st;
+    void *memory;
+    int fd = open(fileName, O_RDONLY);
+
+    if (fd < 0) return NULL;
+    if (fstat(fd, &st) || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    memory = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == memory) return NULL;
+    *size = (size_t) st.st_size;
+    return (const unsigned char *) memory;
+#else
+    unsigned char *memory;
+    long n;
+    FILE *f = fopen(fileName, "rb");
+
+    if (NULL == f) return NULL;
+    if (fseek(f, 0, SEEK_END) || (n = ftell(f)) <= 0 || fseek(f, 0, SEEK_SET)) {
+        fclose(f);
+        return NULL;
+    }
+    memory = (unsigned char *) malloc((size_t) n);
+    if (NULL != memory && fread(memory, 1, (size_t) n, f) != (size_t) n) {
+        free(memory);
+        memory = NULL;
+    }
+    fclose(f);
+    *size = (size_t) n;
+    return memory;
+#endif
+}
+
+static void unmapCache(const unsigned char *file, size_t size) {
+#ifndef _WIN32
+    munmap((void *) file, size);
+#else
+    free((void *) file);
+#endif
+}
+
+/* check a cache file against the parameters, and its contents against the checksum */
+static int fileMatches(const unsigned char *file, size_t size, uint64_t key) {
+    header h;
+
+    if (size != sizeof(header) + sizeof(ikClwindconWTCon)) return 0;
+    memcpy(&h, file, sizeof(header));
+    if (memcmp(h.magic, magic, sizeof(magic)) || IKPARCACHE_VERSION != h.version) return 0;
+    if (sizeof(ikClwindconWTCon) != h.instanceSize || sizeof(ikClwindconWTConParams) != h.paramsSize) return 0;
+    if (key != h.key) return 0;
+    return h.checksum == hash(file + sizeof(header), sizeof(ikClwindconWTCon), 14695981039346656037ULL);
+}
+
+static int copyFromFile(const ikParcache *self, ikClwindconWTCon *con, const ikClwindconWTConParams *params) {
+    memcpy(con, self->file + sizeof(header), sizeof(ikClwindconWTCon));
+    return ikClwindconWTCon_restore(con, params);
+}
+
+static int writeFile(const char *fileName, const ikClwindconWTCon *con, uint64_t key) {
+    char temporary[IKPARCACHE_MAXNAME + 64];
+    header h;
+    FILE *f;
+    int err;
+
+    memset(&h, 0, sizeof(header));
+    memcpy(h.magic, magic, sizeof(magic));
+    h.version = IKPARCACHE_VERSION;
+    h.instanceSize = (uint32_t) sizeof(ikClwindconWTCon);
+    h.paramsSize = (uint32_t) sizeof(ikClwindconWTConParams);
+    h.key = key;
+    h.checksum = hash(con, sizeof(ikClwindconWTCon), 14695981039346656037ULL);
+
+    /* write aside and rename, so that no reader sees a partial file */
+#ifndef _WIN32
+    sprintf(temporary, "%s.%ld.%p", fileName, (long) getpid(), (const void *) con);
+#else
+    sprintf(temporary, "%s.%p", fileName, (const void *) con);
+#endif
+    f = fopen(temporary, "wb");
+    if (NULL == f) return -1;
+    err = fwrite(&h, sizeof(header), 1, f) != 1 || fwrite(con, sizeof(ikClwindconWTCon), 1, f) != 1;
+    err = fclose(f) || err;
+#ifdef _WIN32
+    if (!err) remove(fileName);
+#endif
+    if (!err) err = rename(temporary, fileName);
+    if (err) {
+        remove(temporary);
+        return -1;
+    }
+    return 0;
+}
+
+int ikParcache_init(ikParcache *self, const ikParcacheParams *params) {
+    if (NULL == params->fileName || !strlen(params->fileName) || strlen(params->fileName) >= IKPARCACHE_MAXNAME) return -1;
+    strcpy(self->fileName, params->fileName);
+    self->file = NULL;
+    self->fileSize = 0;
+    self->key = 0;
+
+    return 0;
+}
+
+void ikParcache_initParams(ikParcacheParams *params) {
+    params->fileName = "parcache.bin";
+}
+
+int ikParcache_initController(ikParcache *self, ikClwindconWTCon *con, const ikClwindconWTConParams *params) {
+    const uint64_t key = keyOf(params);
+
+    /* copy from the file kept, if it is for these parameters */
+    if (NULL != self->file && key == self->key && !copyFromFile(self, con, params)) return 2;
+    ikParcache_close(self);
+
+    /* then try the file as it is now */
+    self->file = mapCache(self->fileName, &(self->fileSize));
+    if (NULL != self->file) {
+        if (fileMatches(self->file, self->fileSize, key) && !copyFromFile(self, con, params)) {
+            self->key = key;
+            return 1;
+        }
+        ikParcache_close(self);
+    }
+
+    /* otherwise initialise, and cache the result for next time */
+    if (ikClwindconWTCon_init(con, params)) return -1;
+    if (!writeFile(self->fileName, con, key)) {
+        self->file = mapCache(self->fileName, &(self->fileSize));
+        if (NULL != self->file && !fileMatches(self->file, self->fileSize, key)) ikParcache_close(self);
+        self->key = key;
+    }
+
+    return 0;
+}
+
+void ikParcache_close(ikParcache *self) {
+    if (NULL != self->file) unmapCache(self->file, self->fileSize);
+    self->file = NULL;
+    self->fileSize = 0;
+}
+
+/* @endcond */
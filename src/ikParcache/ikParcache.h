@@ -0,0 +1,138 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikParcache.h
+ *
+ * @brief Class ikParcache interface
+ */
+
+#ifndef IKPARCACHE_H
+#define IKPARCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ikClwindconWTCon.h"
+
+#define IKPARCACHE_VERSION 2 /**<file format version*/
+#define IKPARCACHE_MAXNAME 128 /**<maximum length of the file name, including the terminating NULL*/
+
+    /**
+     * @struct ikParcache
+     * @brief Initialised controller cache
+     *
+     * Initialising a controller derives everything its sub-blocks need from
+     * the parameters, discretised filters and lookup tables included. The
+     * cache keeps the result, the bytes of a freshly initialised
+     * @link ikClwindconWTCon @endlink instance, in a file, so that later
+     * initialisations with the same parameters, in this process or any other,
+     * copy them instead. Only the sub-blocks that may hold pointers, whose
+     * layout is OpenWitcon's business for the control loops, are initialised
+     * again, see @link ikClwindconWTCon_restore @endlink, so that no pointer
+     * is taken from the file.
+     *
+     * The file holds a header and the instance. The header holds the format
+     * version, the instance and parameter structure sizes, a key, a 64-bit
+     * FNV-1a hash, by 8-byte words, of the build identity and the bytes of
+     * the parameter structure, and the same hash of the instance as a
+     * checksum. A file that does not
+     * match in all of these, including a file written for other parameters
+     * or by another build, is ignored, and the controller is then initialised
+     * as usual and the file rewritten. The file is written to a temporary
+     * file first and renamed, so that several processes may share it. It is
+     * mapped into memory where supported, and kept, so that further instances
+     * with the same parameters are copied straight from it.
+     *
+     * The build identity, OPENDISCON_BUILD_ID, is a hash of the OpenDiscon
+     * and OpenWitcon sources and headers, the compiler and the compilation
+     * flags, worked out by the build, so that a file written before a change
+     * of the controller code is not taken for the new one. The parameter
+     * bytes are hashed as they are: zero the parameter structure before
+     * filling it in, so that its padding bytes do not change from a run to
+     * the next.
+     *
+     * @par Methods
+     * @li @link ikParcache_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikParcache_init @endlink initialise an instance
+     * @li @link ikParcache_initController @endlink initialise a controller, from the cache if possible
+     * @li @link ikParcache_close @endlink release the cache file
+     */
+    typedef struct ikParcache {
+        /* @cond */
+        char fileName[IKPARCACHE_MAXNAME];
+        const unsigned char *file;
+        size_t fileSize;
+        uint64_t key;
+        /* @endcond */
+    } ikParcache;
+
+    /**
+     * @struct ikParcacheParams
+     * @brief Initialised controller cache initialisation parameters
+     */
+    typedef struct ikParcacheParams {
+        const char *fileName; /**<cache file name, shorter than @link IKPARCACHE_MAXNAME @endlink. The default value is "parcache.bin"*/
+    } ikParcacheParams;
+
+    /**
+     * Initialise an instance. The file is not read until needed.
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid file name
+     */
+    int ikParcache_init(ikParcache *self, const ikParcacheParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikParcache_initParams(ikParcacheParams *params);
+
+    /**
+     * Initialise a controller instance, as @link ikClwindconWTCon_init @endlink
+     * would, from the cache if it holds the controller for these parameters,
+     * and otherwise by initialising it and writing it to the cache file.
+     * @param self cache instance
+     * @param con controller instance
+     * @param params controller initialisation parameters
+     * @return where the controller came from:
+     * @li 2: the cache file, kept from a previous call
+     * @li 1: the cache file, read now
+     * @li 0: initialisation, with the cache file written if possible
+     * @li -1: initialisation, which failed
+     */
+    int ikParcache_initController(ikParcache *self, ikClwindconWTCon *con, const ikClwindconWTConParams *params);
+
+    /**
+     * Release the cache file kept in memory, if any
+     * @param self cache instance
+     */
+    void ikParcache_close(ikParcache *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKPARCACHE_H */
@@ -25,6 +25,8 @@ along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
 
 /* @cond */
 
+#include <stdlib.h>
+#include <string.h>
 #include "ikPowman.h"
 
 int ikPowman_init(ikPowman *self, const ikPowmanParams *params) {
@@ -46,6 +48,11 @@ int ikPowman_init(ikPowman *self, const ikPowmanParams *params) {
 	err = ikLutbl_setPoints(&(self->lutblPitch), params->minimumPitchTableN, params->minimumPitchTableX, params->minimumPitchTableY);
 	if (err) return -3;
 	
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+	/* register where to keep the inputs */
+	self->diag = params->diagnostics;
+#endif
+	
 	return 0;
 }
 
@@ -65,22 +72,35 @@ void ikPowman_initParams(ikPowmanParams *params) {
 	params->minimumPitchTableN = 1;
 	params->minimumPitchTableX[0] = 0.0;
 	params->minimumPitchTableY[0] = 0.0;
+	
+	/* keep no inputs */
+	params->diagnostics = NULL;
 }
 
 double ikPowman_step(ikPowman *self, double deratingRatio, double maxSpeed, double measuredSpeed) {
+	/* evaluate the look-up tables */
+	return ikPowman_stepGains(self, deratingRatio, maxSpeed, measuredSpeed,
+			ikLutbl_eval(&(self->lutblKopt), deratingRatio), ikLutbl_eval(&(self->lutblPitch), deratingRatio));
+}
+
+double ikPowman_stepGains(ikPowman *self, double deratingRatio, double maxSpeed, double measuredSpeed, double belowRatedTorqueGain, double minimumPitch) {
+#ifndef OPENDISCON_NO_DIAGNOSTICS
 	/* register inputs */
-	self->deratingRatio = deratingRatio;
-	self->maxSpeed = maxSpeed;
-	self->measuredSpeed = measuredSpeed;
+	if (NULL != self->diag) {
+		self->diag->deratingRatio = deratingRatio;
+		self->diag->maxSpeed = maxSpeed;
+		self->diag->measuredSpeed = measuredSpeed;
+	}
+#endif
 	
 	/* calculate maximum torque */	
 	self->maximumTorque = (1-deratingRatio)*self->ratedPower/maxSpeed/self->efficiency;
 	
 	/* calculate below rated torque */
-	self->belowRatedTorque = ikLutbl_eval(&(self->lutblKopt), deratingRatio)*measuredSpeed*measuredSpeed;
+	self->belowRatedTorque = belowRatedTorqueGain*measuredSpeed*measuredSpeed;
 	
 	/* calculate minimum pitch */
-	self->minimumPitch = ikLutbl_eval(&(self->lutblPitch), deratingRatio);
+	self->minimumPitch = minimumPitch;
 	
 	/* return the maximum torque */
 	return self->maximumTorque;
@@ -88,18 +108,20 @@ double ikPowman_step(ikPowman *self, double deratingRatio, double maxSpeed, doub
 
 int ikPowman_getOutput(const ikPowman *self, double *output, const char *name) {
 	/* pick up the signal names */
-    if (!strcmp(name, "derating ratio")) {
-        *output = self->deratingRatio;
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+    if (NULL != self->diag && !strcmp(name, "derating ratio")) {
+        *output = self->diag->deratingRatio;
         return 0;
     }
-    if (!strcmp(name, "maximum speed")) {
-        *output = self->maxSpeed;
+    if (NULL != self->diag && !strcmp(name, "maximum speed")) {
+        *output = self->diag->maxSpeed;
         return 0;
     }
-    if (!strcmp(name, "measured speed")) {
-        *output = self->measuredSpeed;
+    if (NULL != self->diag && !strcmp(name, "measured speed")) {
+        *output = self->diag->measuredSpeed;
         return 0;
     }
+#endif
     if (!strcmp(name, "maximum torque")) {
         *output = self->maximumTorque;
         return 0;
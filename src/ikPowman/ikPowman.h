@@ -32,6 +32,14 @@ extern "C" {
     
 #include "ikLutbl.h"
     
+    /* @cond */
+    typedef struct ikPowmanDiagnostics {
+		double deratingRatio;
+		double maxSpeed;
+		double measuredSpeed;
+    } ikPowmanDiagnostics;
+    /* @endcond */
+    
     /**
      * @struct ikPowman
      * @brief Power manager
@@ -60,6 +68,7 @@ extern "C" {
      * @li @link ikPowman_initParams @endlink initialise initialisation parameter structure
      * @li @link ikPowman_init @endlink initialise an instance
      * @li @link ikPowman_step @endlink execute periodic calculations
+     * @li @link ikPowman_stepGains @endlink execute periodic calculations on look-up table values evaluated elsewhere
      * @li @link ikPowman_getOutput @endlink get output value
      */
     typedef struct ikPowman {
@@ -67,16 +76,16 @@ extern "C" {
          * Private members
          */
         /* @cond */
+		double maximumTorque;
+		double belowRatedTorque;
+		double minimumPitch;
 		double ratedPower;
 		double efficiency;
 		ikLutbl lutblKopt;
 		ikLutbl lutblPitch;
-		double deratingRatio;
-		double maxSpeed;
-		double measuredSpeed;
-		double maximumTorque;
-		double belowRatedTorque;
-		double minimumPitch;
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+		ikPowmanDiagnostics *diag;
+#endif
         /* @endcond */
     } ikPowman;
     
@@ -99,6 +108,7 @@ extern "C" {
                                                                                      The default value is {0.0, 0.0, ...}*/
         double              minimumPitchTableY			[IKLUTBL_MAXPOINTS];/**<pitch angles defining the minimum pitch table, in degrees.
                                                                                      The default value is {0.0, 0.0, ...}*/
+		ikPowmanDiagnostics *diagnostics; /**<where to keep the inputs for @link ikPowman_getOutput @endlink, typically in the cold part of the instance holding the manager, see @link ikLayout.h @endlink, or NULL not to keep them. The default value is NULL*/
     } ikPowmanParams;
     
     /**
@@ -129,9 +139,25 @@ extern "C" {
      */
     double ikPowman_step(ikPowman *self, double deratingRatio, double maxSpeed, double measuredSpeed);
     
+    /**
+     * Execute periodic calculations, with the look-up tables evaluated by
+     * the caller, for instance by code generated for a given parameter set.
+     * @link ikPowman_step @endlink evaluates them and calls this.
+     * @param self power manager instance
+     * @param deratingRatio derating ratio (non-dimensional)
+     * @param maxSpeed maximum speed, in rad/s
+	 * @param measuredSpeed measured speed, in rad/s
+	 * @param belowRatedTorqueGain below rated torque gain table value at the derating ratio, in kNm*s^2/rad^2
+	 * @param minimumPitch minimum pitch table value at the derating ratio, in degrees
+     * @return maximum torque, in kNm
+     */
+    double ikPowman_stepGains(ikPowman *self, double deratingRatio, double maxSpeed, double measuredSpeed, double belowRatedTorqueGain, double minimumPitch);
+    
     /**
      * Get output value by name. All signals named on the block diagram of
-     * @link ikPowman @endlink are accessible.
+     * @link ikPowman @endlink are accessible. The inputs are only available
+     * when kept, see @link ikPowmanParams.diagnostics @endlink, and when built
+     * without OPENDISCON_NO_DIAGNOSTICS.
      * @param self power manager instance
      * @param output output value
      * @param name output name
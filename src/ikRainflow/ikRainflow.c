@@ -0,0 +1,165 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikRainflow.c
+ *
+ * @brief Class ikRainflow implementation
+ */
+
+/* @cond */
+
+#include <string.h>
+#include <math.h>
+
+#include "ikRainflow.h"
+
+static void countCycle(ikRainflow *self, double range, double weight) {
+    int bin = (int) (range/self->binWidth);
+
+    if (bin >= self->nBins) bin = self->nBins - 1;
+    self->counts[bin] += weight;
+    self->cycles += weight;
+    self->damage += weight*pow(range, self->exponent);
+}
+
+static void addTurningPoint(ikRainflow *self, double point) {
+    double *r = self->residue;
+
+    /* make room by counting out the oldest turning point */
+    if (IKRAINFLOW_MAXRESIDUE == self->nResidue) {
+        countCycle(self, fabs(r[1] - r[0]), 0.5);
+        memmove(r, r + 1, (IKRAINFLOW_MAXRESIDUE - 1)*sizeof(double));
+        self->nResidue--;
+    }
+    r[self->nResidue++] = point;
+
+    /* four-point method: take off inner cycles, ranges no larger than those on either side */
+    while (self->nResidue >= 4) {
+        int n = self->nResidue;
+        double inner = fabs(r[n-2] - r[n-3]);
+        if (inner > fabs(r[n-3] - r[n-4]) || inner > fabs(r[n-1] - r[n-2])) break;
+        countCycle(self, inner, 1.0);
+        r[n-3] = r[n-1];
+        self->nResidue -= 2;
+    }
+}
+
+int ikRainflow_init(ikRainflow *self, const ikRainflowParams *params) {
+    int i;
+
+    /* register the bins */
+    if (params->nBins < 1 || params->nBins > IKRAINFLOW_MAXBINS || params->maximumRange <= 0.0) return -1;
+    self->nBins = params->nBins;
+    self->binWidth = params->maximumRange/params->nBins;
+
+    /* register the damage settings */
+    if (params->wohlerExponent <= 0.0 || params->referenceFrequency <= 0.0 || params->samplePeriod <= 0.0) return -2;
+    self->exponent = params->wohlerExponent;
+    self->referenceFrequency = params->referenceFrequency;
+    self->samplePeriod = params->samplePeriod;
+
+    /* start with nothing counted */
+    self->nSamples = 0;
+    self->direction = 0;
+    self->extreme = 0.0;
+    self->nResidue = 0;
+    self->cycles = 0.0;
+    self->damage = 0.0;
+    for (i = 0; i < self->nBins; i++) self->counts[i] = 0.0;
+
+    return 0;
+}
+
+void ikRainflow_initParams(ikRainflowParams *params) {
+    params->nBins = 64;
+    params->maximumRange = 1.0;
+    params->wohlerExponent = 4.0;
+    params->referenceFrequency = 1.0;
+    params->samplePeriod = 0.01;
+}
+
+void ikRainflow_step(ikRainflow *self, double value) {
+    /* the first sample starts the residue */
+    if (0 == self->nSamples++) {
+        self->residue[0] = value;
+        self->nResidue = 1;
+        self->extreme = value;
+        return;
+    }
+
+    /* follow the signal to its next reversal by at least a bin width */
+    switch (self->direction) {
+        case 0:
+            if (fabs(value - self->residue[self->nResidue - 1]) >= self->binWidth) {
+                self->direction = value > self->residue[self->nResidue - 1] ? 1 : -1;
+                self->extreme = value;
+            }
+            break;
+        case 1:
+            if (value > self->extreme) {
+                self->extreme = value;
+            } else if (self->extreme - value >= self->binWidth) {
+                addTurningPoint(self, self->extreme);
+                self->direction = -1;
+                self->extreme = value;
+            }
+            break;
+        default:
+            if (value < self->extreme) {
+                self->extreme = value;
+            } else if (value - self->extreme >= self->binWidth) {
+                addTurningPoint(self, self->extreme);
+                self->direction = 1;
+                self->extreme = value;
+            }
+            break;
+    }
+}
+
+int ikRainflow_getOutput(const ikRainflow *self, double *output, const char *name) {
+    /* pick up the signal names */
+    if (!strcmp(name, "damage equivalent load")) {
+        double damage = self->damage;
+        double time = self->nSamples*self->samplePeriod;
+        int i;
+
+        /* count the residue, up to the last extreme, as half cycles */
+        for (i = 1; i < self->nResidue; i++) damage += 0.5*pow(fabs(self->residue[i] - self->residue[i-1]), self->exponent);
+        if (self->direction && self->nResidue > 0) damage += 0.5*pow(fabs(self->extreme - self->residue[self->nResidue - 1]), self->exponent);
+        *output = time > 0.0 ? pow(damage/(self->referenceFrequency*time), 1.0/self->exponent) : 0.0;
+        return 0;
+    }
+    if (!strcmp(name, "cycles")) {
+        *output = self->cycles;
+        return 0;
+    }
+    if (!strcmp(name, "residue")) {
+        *output = self->nResidue;
+        return 0;
+    }
+
+    return -1;
+}
+
+void ikRainflow_getHistogram(const ikRainflow *self, double *counts) {
+    memcpy(counts, self->counts, self->nBins*sizeof(double));
+}
+
+/* @endcond */
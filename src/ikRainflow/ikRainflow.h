@@ -0,0 +1,154 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikRainflow.h
+ *
+ * @brief Class ikRainflow interface
+ */
+
+#ifndef IKRAINFLOW_H
+#define IKRAINFLOW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IKRAINFLOW_MAXBINS 256 /**<maximum number of range bins*/
+#define IKRAINFLOW_MAXRESIDUE 512 /**<maximum number of turning points kept in the residue*/
+
+    /**
+     * @struct ikRainflow
+     * @brief Streaming rainflow counter
+     *
+     * The counter takes one sample of a signal per step and counts its load
+     * cycles as it goes, without keeping the time series, so that the
+     * damage-equivalent load of the signal can be had at any time.
+     *
+     * Turning points are picked up as soon as the signal reverses by at
+     * least one bin width, which filters out reversals too small to be
+     * binned. Each new turning point goes onto a residue stack, and closed
+     * cycles are taken off its top by the four-point method, so that a
+     * step costs amortised constant time. A closed cycle is added to a
+     * histogram of cycle ranges, with ranges beyond the last bin counted in
+     * it, and its damage, its range to the power of the Wohler exponent, to
+     * a running sum. If the residue ever fills up, its oldest turning point
+     * is counted out as a half cycle.
+     *
+     * The damage-equivalent load is the range of the constant-amplitude
+     * load which, applied at the reference frequency over the elapsed time,
+     * does the same damage as the counted cycles, with the residue counted
+     * as half cycles:
+     * DEL = (sum(n_i*S_i^m)/(f_ref*T))^(1/m)
+     *
+     * @par Inputs
+     * @li signal value: specify via @link ikRainflow_step @endlink
+     *
+     * @par Outputs
+     * @li damage equivalent load: in signal units, get via @link ikRainflow_getOutput @endlink
+     * @li cycles: number of closed cycles, get via @link ikRainflow_getOutput @endlink
+     * @li residue: number of turning points in the residue, get via @link ikRainflow_getOutput @endlink
+     * @li range histogram: number of closed cycles per range bin, get via @link ikRainflow_getHistogram @endlink
+     *
+     * @par Methods
+     * @li @link ikRainflow_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikRainflow_init @endlink initialise an instance
+     * @li @link ikRainflow_step @endlink execute periodic calculations
+     * @li @link ikRainflow_getOutput @endlink get output value
+     * @li @link ikRainflow_getHistogram @endlink get the range histogram
+     */
+    typedef struct ikRainflow {
+        /* @cond */
+        int nBins;
+        double binWidth;
+        double exponent;
+        double referenceFrequency;
+        double samplePeriod;
+        long nSamples;
+        int direction;
+        double extreme;
+        int nResidue;
+        double residue[IKRAINFLOW_MAXRESIDUE];
+        double cycles;
+        double damage;
+        double counts[IKRAINFLOW_MAXBINS];
+        /* @endcond */
+    } ikRainflow;
+
+    /**
+     * @struct ikRainflowParams
+     * @brief Streaming rainflow counter initialisation parameters
+     */
+    typedef struct ikRainflowParams {
+        int nBins; /**<number of range bins, between 1 and @link IKRAINFLOW_MAXBINS @endlink. The default value is 64*/
+        double maximumRange; /**<upper end of the last range bin, in signal units. It must be positive. The default value is 1.0*/
+        double wohlerExponent; /**<slope of the S-N curve, non-dimensional, typically 3 to 5 for steel and 10 for composites. It must be positive. The default value is 4.0*/
+        double referenceFrequency; /**<frequency of the damage-equivalent load cycles, in Hz. It must be positive. The default value is 1.0*/
+        double samplePeriod; /**<sample period, in s. It must be positive. The default value is 0.01*/
+    } ikRainflowParams;
+
+    /**
+     * Initialise an instance, with no cycles counted
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid number of bins or maximum range
+     * @li -2: invalid Wohler exponent, reference frequency or sample period
+     */
+    int ikRainflow_init(ikRainflow *self, const ikRainflowParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikRainflow_initParams(ikRainflowParams *params);
+
+    /**
+     * Execute periodic calculations
+     * @param self rainflow counter instance
+     * @param value signal value, in signal units
+     */
+    void ikRainflow_step(ikRainflow *self, double value);
+
+    /**
+     * Get output value by name. All outputs are available at any time.
+     * @param self rainflow counter instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     */
+    int ikRainflow_getOutput(const ikRainflow *self, double *output, const char *name);
+
+    /**
+     * Get the range histogram. Bin i holds the closed cycles with ranges
+     * from i to i + 1 bin widths, the last bin also those with larger
+     * ranges.
+     * @param self rainflow counter instance
+     * @param counts number of closed cycles per bin, an array with as many elements as bins
+     */
+    void ikRainflow_getHistogram(const ikRainflow *self, double *counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKRAINFLOW_H */
@@ -0,0 +1,910 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikSiglog.c
+ *
+ * @brief Class ikSiglog implementation
+ */
+
+/* @cond */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ikSiglog.h"
+
+static const char headerMagic[8] = {'I', 'K', 'S', 'I', 'G', 'L', 'O', 'G'};
+static const char trailerMagic[8] = {'I', 'K', 'S', 'I', 'G', 'E', 'N', 'D'};
+static const char chunkTag[4] = {'C', 'H', 'N', 'K'};
+static const char indexTag[4] = {'I', 'N', 'D', 'X'};
+static const char pyramidTag[4] = {'P', 'Y', 'R', 'M'};
+
+#define PYRAMID_HEADER 24 /* tag, number of entries, level, reserved and first entry */
+
+/* little-endian serialisation */
+
+static void putU16(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char) v;
+    p[1] = (unsigned char) (v >> 8);
+}
+
+static void putU32(unsigned char *p, uint32_t v) {
+    int i;
+    for (i = 0; i < 4; i++) p[i] = (unsigned char) (v >> (8*i));
+}
+
+static void putU64(unsigned char *p, uint64_t v) {
+    int i;
+    for (i = 0; i < 8; i++) p[i] = (unsigned char) (v >> (8*i));
+}
+
+static uint32_t getU16(const unsigned char *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8);
+}
+
+static uint32_t getU32(const unsigned char *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static uint64_t getU64(const unsigned char *p) {
+    return (uint64_t) getU32(p) | ((uint64_t) getU32(p + 4) << 32);
+}
+
+static uint64_t doubleBits(double x) {
+    uint64_t b;
+    memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+static double bitsDouble(uint64_t b) {
+    double x;
+    memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+static int leadingZeros(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & ((uint64_t) 1 << 63))) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static int trailingZeros(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* bit streams, most significant bit first */
+
+typedef struct ikBitStream {
+    unsigned char *wbuf;
+    const unsigned char *rbuf;
+    size_t pos;
+    size_t end;
+    int overrun;
+} ikBitStream;
+
+static void putBits(ikBitStream *s, uint64_t value, int nbits) {
+    while (nbits > 0) {
+        int room = 8 - (int) (s->pos & 7);
+        int take = nbits < room ? nbits : room;
+        unsigned int bits = (unsigned int) ((value >> (nbits - take)) & ((1u << take) - 1));
+        s->wbuf[s->pos >> 3] |= (unsigned char) (bits << (room - take));
+        s->pos += take;
+        nbits -= take;
+    }
+}
+
+static uint64_t getBits(ikBitStream *s, int nbits) {
+    uint64_t value = 0;
+    if (s->pos + nbits > s->end) {
+        s->overrun = 1;
+        return 0;
+    }
+    while (nbits > 0) {
+        int avail = 8 - (int) (s->pos & 7);
+        int take = nbits < avail ? nbits : avail;
+        unsigned int bits = ((unsigned int) s->rbuf[s->pos >> 3] >> (avail - take)) & ((1u << take) - 1);
+        value = (value << take) | bits;
+        s->pos += take;
+        nbits -= take;
+    }
+    return value;
+}
+
+/* XOR codec */
+
+static size_t worstColumnSize(int n) {
+    /* mode byte, first value and a full-length XOR for every other value */
+    return 1 + (64 + (size_t) (n - 1)*(2 + 5 + 6 + 64) + 7)/8;
+}
+
+static uint64_t predict(int mode, uint64_t prev, uint64_t prevprev, int i) {
+    if (1 == mode && i > 1) return 2*prev - prevprev;
+    return prev;
+}
+
+static size_t encodeColumn(unsigned char *out, const double *v, int n, int mode) {
+    ikBitStream s;
+    uint64_t prev, prevprev = 0;
+    int prevLz = -1;
+    int prevTz = 0;
+    int i;
+
+    memset(out, 0, worstColumnSize(n));
+    out[0] = (unsigned char) mode;
+    s.wbuf = out + 1;
+    s.pos = 0;
+
+    prev = doubleBits(v[0]);
+    putBits(&s, prev, 64);
+    for (i = 1; i < n; i++) {
+        uint64_t cur = doubleBits(v[i]);
+        uint64_t x = cur ^ predict(mode, prev, prevprev, i);
+        if (0 == x) {
+            putBits(&s, 0, 1);
+        } else {
+            int lz = leadingZeros(x);
+            int tz = trailingZeros(x);
+            if (lz > 31) lz = 31;
+            if (prevLz >= 0 && lz >= prevLz && tz >= prevTz) {
+                putBits(&s, 2, 2);
+                putBits(&s, x >> prevTz, 64 - prevLz - prevTz);
+            } else {
+                int len = 64 - lz - tz;
+                putBits(&s, 3, 2);
+                putBits(&s, (uint64_t) lz, 5);
+                putBits(&s, (uint64_t) (len - 1), 6);
+                putBits(&s, x >> tz, len);
+                prevLz = lz;
+                prevTz = tz;
+            }
+        }
+        prevprev = prev;
+        prev = cur;
+    }
+
+    return 1 + (s.pos + 7)/8;
+}
+
+static int decodeColumn(const unsigned char *in, size_t size, double *v, int n) {
+    ikBitStream s;
+    uint64_t prev, prevprev = 0;
+    int prevLz = -1;
+    int prevTz = 0;
+    int mode;
+    int i;
+
+    if (size < 1 || n < 1) return -1;
+    mode = in[0];
+    if (mode > 1) return -1;
+    s.rbuf = in + 1;
+    s.pos = 0;
+    s.end = 8*(size - 1);
+    s.overrun = 0;
+
+    prev = getBits(&s, 64);
+    v[0] = bitsDouble(prev);
+    for (i = 1; i < n; i++) {
+        uint64_t x = 0;
+        uint64_t cur;
+        if (getBits(&s, 1)) {
+            if (!getBits(&s, 1)) {
+                if (prevLz < 0) return -1;
+                x = getBits(&s, 64 - prevLz - prevTz) << prevTz;
+            } else {
+                int lz = (int) getBits(&s, 5);
+                int len = (int) getBits(&s, 6) + 1;
+                int tz = 64 - lz - len;
+                if (tz < 0) return -1;
+                x = getBits(&s, len) << tz;
+                prevLz = lz;
+                prevTz = tz;
+            }
+        }
+        if (s.overrun) return -1;
+        cur = x ^ predict(mode, prev, prevprev, i);
+        v[i] = bitsDouble(cur);
+        prevprev = prev;
+        prev = cur;
+    }
+
+    return 0;
+}
+
+/* writer */
+
+void ikSiglog_initParams(ikSiglogParams *params) {
+    int i;
+
+    params->fileName = "log.bin";
+    params->nSignals = 0;
+    for (i = 0; i < IKSIGLOG_MAXSIGNALS; i++) {
+        params->names[i] = NULL;
+        params->units[i] = NULL;
+    }
+    params->samplePeriod = 0.01;
+    params->startTime = 0.0;
+    params->chunkSize = 4096;
+    params->pyramidLevels = 0;
+    params->pyramidFactor = 16;
+}
+
+static int writeBytes(ikSiglog *self, const void *bytes, size_t n) {
+    if (fwrite(bytes, 1, n, self->file) != n) return -1;
+    self->offset += n;
+    return 0;
+}
+
+static void freeWriter(ikSiglog *self) {
+    free(self->buffer);
+    free(self->packed);
+    free(self->chunkOffsets);
+    free(self->chunkSamples);
+    free(self->chunkLevels);
+    free(self->accumulators);
+    free(self->pyramid);
+    self->buffer = NULL;
+    self->packed = NULL;
+    self->chunkOffsets = NULL;
+    self->chunkSamples = NULL;
+    self->chunkLevels = NULL;
+    self->accumulators = NULL;
+    self->pyramid = NULL;
+}
+
+int ikSiglog_init(ikSiglog *self, const ikSiglogParams *params) {
+    unsigned char fixed[40];
+    unsigned char len[2];
+    int i;
+
+    memset(self, 0, sizeof(*self));
+
+    /* check parameters */
+    if (params->nSignals < 1 || params->nSignals > IKSIGLOG_MAXSIGNALS) return -1;
+    if (params->chunkSize < 1 || !(params->samplePeriod > 0.0)) return -1;
+    if (params->pyramidLevels < 0 || params->pyramidLevels > IKSIGLOG_MAXLEVELS) return -1;
+    if (params->pyramidLevels > 0 && (params->pyramidFactor < 2 || params->pyramidFactor > 65535)) return -1;
+    for (i = 0; i < params->nSignals; i++) {
+        if (NULL == params->names[i] || !params->names[i][0] || strlen(params->names[i]) >= IKSIGLOG_MAXNAME) return -2;
+        if (NULL != params->units[i] && strlen(params->units[i]) >= IKSIGLOG_MAXNAME) return -2;
+    }
+
+    /* allocate the sample buffer and room for a packed chunk or pyramid block, plus scratch for the second codec mode */
+    self->nSignals = params->nSignals;
+    self->chunkSize = params->chunkSize;
+    self->nLevels = params->pyramidLevels;
+    self->pyramidFactor = params->pyramidFactor;
+    self->packedCapacity = 8 + 4*(size_t) self->nSignals + (size_t) (self->nSignals + 1)*worstColumnSize(self->chunkSize);
+    if (self->nLevels > 0) {
+        size_t blockCapacity = PYRAMID_HEADER + 12*(size_t) self->nSignals + (size_t) (3*self->nSignals + 1)*worstColumnSize(IKSIGLOG_PYRAMIDBLOCK);
+        if (blockCapacity > self->packedCapacity) self->packedCapacity = blockCapacity;
+        self->accumulators = (double *) malloc(sizeof(double)*3*self->nLevels*self->nSignals);
+        self->pyramid = (double *) malloc(sizeof(double)*3*self->nLevels*self->nSignals*IKSIGLOG_PYRAMIDBLOCK);
+    }
+    self->buffer = (double *) malloc(sizeof(double)*self->nSignals*self->chunkSize);
+    self->packed = (unsigned char *) malloc(self->packedCapacity);
+    self->chunkCapacity = 64;
+    self->chunkOffsets = (uint64_t *) malloc(sizeof(uint64_t)*self->chunkCapacity);
+    self->chunkSamples = (uint32_t *) malloc(sizeof(uint32_t)*self->chunkCapacity);
+    self->chunkLevels = (uint32_t *) malloc(sizeof(uint32_t)*self->chunkCapacity);
+    if (NULL == self->buffer || NULL == self->packed || NULL == self->chunkOffsets || NULL == self->chunkSamples
+            || NULL == self->chunkLevels || (self->nLevels > 0 && (NULL == self->accumulators || NULL == self->pyramid))) {
+        freeWriter(self);
+        return -3;
+    }
+
+    self->file = fopen(params->fileName, "wb");
+    if (NULL == self->file) {
+        freeWriter(self);
+        return -4;
+    }
+
+    /* write header */
+    memcpy(fixed, headerMagic, 8);
+    putU32(fixed + 8, IKSIGLOG_VERSION);
+    putU32(fixed + 12, (uint32_t) self->nSignals);
+    putU32(fixed + 16, (uint32_t) self->chunkSize);
+    putU32(fixed + 20, self->nLevels > 0 ? (uint32_t) self->pyramidFactor | ((uint32_t) self->nLevels << 16) : 0);
+    putU64(fixed + 24, doubleBits(params->samplePeriod));
+    putU64(fixed + 32, doubleBits(params->startTime));
+    writeBytes(self, fixed, sizeof(fixed));
+    for (i = 0; i < self->nSignals; i++) {
+        const char *unit = NULL == params->units[i] ? "" : params->units[i];
+        putU16(len, (uint32_t) strlen(params->names[i]));
+        writeBytes(self, len, 2);
+        writeBytes(self, params->names[i], strlen(params->names[i]));
+        putU16(len, (uint32_t) strlen(unit));
+        writeBytes(self, len, 2);
+        writeBytes(self, unit, strlen(unit));
+    }
+
+    return ferror(self->file) ? -4 : 0;
+}
+
+/* list a chunk, or a pyramid block of a level from 1 up, in the chunk index */
+static int addIndexEntry(ikSiglog *self, uint64_t offset, uint32_t n, uint32_t level) {
+    if (self->nChunks == self->chunkCapacity) {
+        long capacity = 2*self->chunkCapacity;
+        uint64_t *offsets = (uint64_t *) realloc(self->chunkOffsets, sizeof(uint64_t)*capacity);
+        uint32_t *samples;
+        uint32_t *levels;
+        if (NULL == offsets) return -2;
+        self->chunkOffsets = offsets;
+        samples = (uint32_t *) realloc(self->chunkSamples, sizeof(uint32_t)*capacity);
+        if (NULL == samples) return -2;
+        self->chunkSamples = samples;
+        levels = (uint32_t *) realloc(self->chunkLevels, sizeof(uint32_t)*capacity);
+        if (NULL == levels) return -2;
+        self->chunkLevels = levels;
+        self->chunkCapacity = capacity;
+    }
+    self->chunkOffsets[self->nChunks] = offset;
+    self->chunkSamples[self->nChunks] = n;
+    self->chunkLevels[self->nChunks] = level;
+    self->nChunks++;
+    return 0;
+}
+
+/* pack columns with both predictors, keeping the shorter, and note their sizes */
+static size_t packColumns(ikSiglog *self, size_t pos, size_t sizes, const double *columns, int nColumns, int stride, int n) {
+    size_t worst = worstColumnSize(n);
+    int i;
+
+    for (i = 0; i < nColumns; i++) {
+        const double *column = columns + (size_t) i*stride;
+        size_t size0 = encodeColumn(self->packed + pos, column, n, 0);
+        size_t size1 = encodeColumn(self->packed + pos + worst, column, n, 1);
+        if (size1 < size0) {
+            memmove(self->packed + pos, self->packed + pos + worst, size1);
+            size0 = size1;
+        }
+        putU32(self->packed + sizes + 4*i, (uint32_t) size0);
+        pos += size0;
+    }
+    return pos;
+}
+
+static int flushChunk(ikSiglog *self) {
+    size_t pos;
+
+    if (!self->nBuffered) return 0;
+    if (addIndexEntry(self, self->offset, (uint32_t) self->nBuffered, 0)) return -2;
+
+    memcpy(self->packed, chunkTag, 4);
+    putU32(self->packed + 4, (uint32_t) self->nBuffered);
+    pos = packColumns(self, 8 + 4*(size_t) self->nSignals, 8, self->buffer, self->nSignals, self->chunkSize, self->nBuffered);
+    self->nBuffered = 0;
+
+    return writeBytes(self, self->packed, pos) ? -2 : 0;
+}
+
+/* pyramid: level l, from 0 here for level 1 in the file, accumulates the
+   minimum, maximum and sum of the samples of its current entry, in
+   accumulators[l][0..2][signal], and buffers its finished entries in
+   pyramid[l][0..2][signal][entry], as minimum, maximum and mean */
+
+static double *accumulator(const ikSiglog *self, int level, int statistic) {
+    return self->accumulators + (size_t) (3*level + statistic)*self->nSignals;
+}
+
+static double *pyramidColumn(const ikSiglog *self, int level, int statistic, int signal) {
+    return self->pyramid + ((size_t) (3*level + statistic)*self->nSignals + signal)*IKSIGLOG_PYRAMIDBLOCK;
+}
+
+static int flushLevel(ikSiglog *self, int level) {
+    const int n = self->nPyramidBuffered[level];
+    size_t pos;
+
+    if (!n) return 0;
+    if (addIndexEntry(self, self->offset, (uint32_t) n, (uint32_t) level + 1)) return -2;
+
+    memcpy(self->packed, pyramidTag, 4);
+    putU32(self->packed + 4, (uint32_t) n);
+    putU32(self->packed + 8, (uint32_t) level + 1);
+    putU32(self->packed + 12, 0);
+    putU64(self->packed + 16, self->pyramidFirst[level]);
+    pos = packColumns(self, PYRAMID_HEADER + 12*(size_t) self->nSignals, PYRAMID_HEADER,
+            pyramidColumn(self, level, 0, 0), 3*self->nSignals, IKSIGLOG_PYRAMIDBLOCK, n);
+    self->pyramidFirst[level] += n;
+    self->nPyramidBuffered[level] = 0;
+
+    return writeBytes(self, self->packed, pos) ? -2 : 0;
+}
+
+static int accumulate(ikSiglog *self, int level, const double *minimum, const double *maximum, const double *sum, long nSamples);
+
+/* finish the current entry of a level and pass it on to the next */
+static int finishEntry(ikSiglog *self, int level) {
+    double minimum[IKSIGLOG_MAXSIGNALS];
+    double maximum[IKSIGLOG_MAXSIGNALS];
+    double sum[IKSIGLOG_MAXSIGNALS];
+    const long nSamples = self->accumulatedSamples[level];
+    const int entry = self->nPyramidBuffered[level];
+    int i;
+
+    for (i = 0; i < self->nSignals; i++) {
+        minimum[i] = accumulator(self, level, 0)[i];
+        maximum[i] = accumulator(self, level, 1)[i];
+        sum[i] = accumulator(self, level, 2)[i];
+        pyramidColumn(self, level, 0, i)[entry] = minimum[i];
+        pyramidColumn(self, level, 1, i)[entry] = maximum[i];
+        pyramidColumn(self, level, 2, i)[entry] = sum[i]/nSamples;
+    }
+    self->nPyramidBuffered[level]++;
+    self->accumulatedEntries[level] = 0;
+    self->accumulatedSamples[level] = 0;
+
+    if (IKSIGLOG_PYRAMIDBLOCK == self->nPyramidBuffered[level] && flushLevel(self, level)) return -2;
+    if (level + 1 < self->nLevels) return accumulate(self, level + 1, minimum, maximum, sum, nSamples);
+    return 0;
+}
+
+static int accumulate(ikSiglog *self, int level, const double *minimum, const double *maximum, const double *sum, long nSamples) {
+    double *accMinimum = accumulator(self, level, 0);
+    double *accMaximum = accumulator(self, level, 1);
+    double *accSum = accumulator(self, level, 2);
+    int i;
+
+    if (!self->accumulatedEntries[level]) {
+        for (i = 0; i < self->nSignals; i++) {
+            accMinimum[i] = minimum[i];
+            accMaximum[i] = maximum[i];
+            accSum[i] = sum[i];
+        }
+    } else {
+        for (i = 0; i < self->nSignals; i++) {
+            if (minimum[i] < accMinimum[i]) accMinimum[i] = minimum[i];
+            if (maximum[i] > accMaximum[i]) accMaximum[i] = maximum[i];
+            accSum[i] += sum[i];
+        }
+    }
+    self->accumulatedSamples[level] += nSamples;
+    if (++(self->accumulatedEntries[level]) == self->pyramidFactor) return finishEntry(self, level);
+    return 0;
+}
+
+
+int ikSiglog_write(ikSiglog *self, const double *values) {
+    int i;
+
+    if (NULL == self->file) return -1;
+
+    for (i = 0; i < self->nSignals; i++) {
+        self->buffer[(size_t) i*self->chunkSize + self->nBuffered] = values[i];
+    }
+    self->nBuffered++;
+
+    /* the pyramid follows the chunks, so that a truncated file holds no entries for lost samples */
+    if (self->nBuffered == self->chunkSize && flushChunk(self)) return -2;
+    if (self->nLevels > 0) return accumulate(self, 0, values, values, values, 1);
+    return 0;
+}
+
+int ikSiglog_close(ikSiglog *self) {
+    unsigned char entry[16];
+    uint64_t indexOffset;
+    int err = 0;
+    int level;
+    long i;
+
+    if (NULL == self->file) return -1;
+
+    if (flushChunk(self)) err = -2;
+
+    /* finish the last entries of the pyramid, partial as they may be, from the finest level up */
+    for (level = 0; level < self->nLevels; level++) {
+        if (self->accumulatedEntries[level] && finishEntry(self, level)) err = -2;
+        if (flushLevel(self, level)) err = -2;
+    }
+
+    /* write chunk index and trailer */
+    indexOffset = self->offset;
+    memcpy(entry, indexTag, 4);
+    putU32(entry + 4, (uint32_t) self->nChunks);
+    if (writeBytes(self, entry, 8)) err = -2;
+    for (i = 0; i < self->nChunks; i++) {
+        putU64(entry, self->chunkOffsets[i]);
+        putU32(entry + 8, self->chunkSamples[i]);
+        putU32(entry + 12, self->chunkLevels[i]);
+        if (writeBytes(self, entry, 16)) err = -2;
+    }
+    putU64(entry, indexOffset);
+    memcpy(entry + 8, trailerMagic, 8);
+    if (writeBytes(self, entry, 16)) err = -2;
+
+    if (fclose(self->file)) err = -2;
+    self->file = NULL;
+    freeWriter(self);
+
+    return err;
+}
+
+/* reader */
+
+static int mapFile(ikSiglogReader *self, const char *fileName) {
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE map;
+    LARGE_INTEGER size;
+
+    file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (INVALID_HANDLE_VALUE == file) return -1;
+    if (!GetFileSizeEx(file, &size) || 0 == size.QuadPart) {
+        CloseHandle(file);
+        return -1;
+    }
+    map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (NULL == map) return -1;
+    self->data = (const unsigned char *) MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    if (NULL == self->data) {
+        CloseHandle(map);
+        return -1;
+    }
+    self->mapHandle = map;
+    self->size = (size_t) size.QuadPart;
+#else
+    struct stat st;
+    void *p;
+    int fd;
+
+    fd = open(fileName, O_RDONLY);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) || 0 == st.st_size) {
+        close(fd);
+        return -1;
+    }
+    p = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == p) return -1;
+    self->data = (const unsigned char *) p;
+    self->size = (size_t) st.st_size;
+    self->mapHandle = NULL;
+#endif
+    return 0;
+}
+
+static void unmapFile(ikSiglogReader *self) {
+    if (NULL == self->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(self->data);
+    CloseHandle((HANDLE) self->mapHandle);
+#else
+    munmap((void *) self->data, self->size);
+#endif
+    self->data = NULL;
+}
+
+static int addChunk(ikSiglogReader *self, long *capacity, uint64_t offset, uint32_t nSamples) {
+    if (self->nChunks == *capacity) {
+        long newCapacity = *capacity ? 2*(*capacity) : 64;
+        uint64_t *offsets = (uint64_t *) realloc(self->chunkOffsets, sizeof(uint64_t)*newCapacity);
+        uint32_t *samples;
+        long *firsts;
+        if (NULL == offsets) return -4;
+        self->chunkOffsets = offsets;
+        samples = (uint32_t *) realloc(self->chunkSamples, sizeof(uint32_t)*newCapacity);
+        if (NULL == samples) return -4;
+        self->chunkSamples = samples;
+        firsts = (long *) realloc(self->chunkFirst, sizeof(long)*newCapacity);
+        if (NULL == firsts) return -4;
+        self->chunkFirst = firsts;
+        *capacity = newCapacity;
+    }
+    self->chunkOffsets[self->nChunks] = offset;
+    self->chunkSamples[self->nChunks] = nSamples;
+    self->chunkFirst[self->nChunks] = self->nSamples;
+    self->nChunks++;
+    self->nSamples += nSamples;
+    self->nEntries[0] = self->nSamples;
+    return 0;
+}
+
+static int addBlock(ikSiglogReader *self, long *capacity, uint64_t offset) {
+    const unsigned char *p = self->data + offset;
+
+    if (self->nBlocks == *capacity) {
+        long newCapacity = *capacity ? 2*(*capacity) : 64;
+        uint64_t *offsets = (uint64_t *) realloc(self->blockOffsets, sizeof(uint64_t)*newCapacity);
+        long *firsts;
+        int *levels;
+        if (NULL == offsets) return -4;
+        self->blockOffsets = offsets;
+        firsts = (long *) realloc(self->blockFirst, sizeof(long)*newCapacity);
+        if (NULL == firsts) return -4;
+        self->blockFirst = firsts;
+        levels = (int *) realloc(self->blockLevels, sizeof(int)*newCapacity);
+        if (NULL == levels) return -4;
+        self->blockLevels = levels;
+        *capacity = newCapacity;
+    }
+    self->blockOffsets[self->nBlocks] = offset;
+    self->blockFirst[self->nBlocks] = (long) getU64(p + 16);
+    self->blockLevels[self->nBlocks] = (int) getU32(p + 8);
+    if (self->nEntries[self->blockLevels[self->nBlocks]] < self->blockFirst[self->nBlocks] + (long) getU32(p + 4)) {
+        self->nEntries[self->blockLevels[self->nBlocks]] = self->blockFirst[self->nBlocks] + (long) getU32(p + 4);
+    }
+    self->nBlocks++;
+    return 0;
+}
+
+/* size of the chunk at offset, or 0 if it is not a complete chunk */
+static size_t chunkBytes(const ikSiglogReader *self, uint64_t offset) {
+    const unsigned char *p = self->data + offset;
+    size_t headerSize = 8 + 4*(size_t) self->nSignals;
+    size_t size = headerSize;
+    uint32_t nSamples;
+    int i;
+
+    if (offset + headerSize > self->size || memcmp(p, chunkTag, 4)) return 0;
+    nSamples = getU32(p + 4);
+    if (nSamples < 1 || nSamples > (uint32_t) self->chunkSize) return 0;
+    for (i = 0; i < self->nSignals; i++) size += getU32(p + 8 + 4*i);
+    if (offset + size > self->size) return 0;
+    return size;
+}
+
+/* size of the pyramid block at offset, or 0 if it is not a complete block */
+static size_t blockBytes(const ikSiglogReader *self, uint64_t offset) {
+    const unsigned char *p = self->data + offset;
+    size_t headerSize = PYRAMID_HEADER + 12*(size_t) self->nSignals;
+    size_t size = headerSize;
+    uint32_t nEntries, level;
+    int i;
+
+    if (offset + headerSize > self->size || memcmp(p, pyramidTag, 4)) return 0;
+    nEntries = getU32(p + 4);
+    level = getU32(p + 8);
+    if (nEntries < 1 || nEntries > IKSIGLOG_PYRAMIDBLOCK || level < 1 || level > (uint32_t) self->nLevels) return 0;
+    for (i = 0; i < 3*self->nSignals; i++) size += getU32(p + PYRAMID_HEADER + 4*i);
+    if (offset + size > self->size) return 0;
+    return size;
+}
+
+static int readIndex(ikSiglogReader *self, size_t headerEnd) {
+    long capacity = 0;
+    long blockCapacity = 0;
+    uint64_t pos;
+    int err;
+
+    /* use the chunk index if the file was closed properly */
+    if (self->size >= headerEnd + 24 && !memcmp(self->data + self->size - 8, trailerMagic, 8)) {
+        uint64_t indexOffset = getU64(self->data + self->size - 16);
+        if (indexOffset >= headerEnd && indexOffset + 8 <= self->size - 16 && !memcmp(self->data + indexOffset, indexTag, 4)) {
+            uint32_t n = getU32(self->data + indexOffset + 4);
+            uint32_t i;
+            if (indexOffset + 8 + 16*(uint64_t) n > self->size - 16) return -3;
+            for (i = 0; i < n; i++) {
+                const unsigned char *entry = self->data + indexOffset + 8 + 16*i;
+                uint64_t offset = getU64(entry);
+                uint32_t nEntries = getU32(entry + 8);
+                uint32_t level = getU32(entry + 12);
+                if (offset < headerEnd || offset >= self->size) return -3;
+                /* the counts size the decode buffer, so they must agree with the chunk they index */
+                if (level) {
+                    if (nEntries < 1 || nEntries > IKSIGLOG_PYRAMIDBLOCK) return -3;
+                    if (!blockBytes(self, offset) || getU32(self->data + offset + 4) != nEntries
+                            || getU32(self->data + offset + 8) != level) return -3;
+                    err = addBlock(self, &blockCapacity, offset);
+                } else {
+                    if (nEntries < 1 || nEntries > (uint32_t) self->chunkSize) return -3;
+                    if (!chunkBytes(self, offset) || getU32(self->data + offset + 4) != nEntries) return -3;
+                    err = addChunk(self, &capacity, offset, nEntries);
+                }
+                if (err) return err;
+            }
+            return 0;
+        }
+    }
+
+    /* otherwise scan the complete chunks and pyramid blocks */
+    pos = headerEnd;
+    for (;;) {
+        size_t size = chunkBytes(self, pos);
+        if (size) {
+            err = addChunk(self, &capacity, pos, getU32(self->data + pos + 4));
+        } else {
+            size = blockBytes(self, pos);
+            if (!size) break;
+            err = addBlock(self, &blockCapacity, pos);
+        }
+        if (err) return err;
+        pos += size;
+    }
+    return 0;
+}
+
+int ikSiglogReader_open(ikSiglogReader *self, const char *fileName) {
+    size_t pos;
+    int err;
+    int i;
+
+    memset(self, 0, sizeof(*self));
+    if (mapFile(self, fileName)) return -1;
+
+    /* parse header, of this version or the first */
+    if (self->size < 40 || memcmp(self->data, headerMagic, 8) || getU32(self->data + 8) < 1 || getU32(self->data + 8) > IKSIGLOG_VERSION) {
+        ikSiglogReader_close(self);
+        return -2;
+    }
+    self->nSignals = (int) getU32(self->data + 12);
+    self->chunkSize = (int) getU32(self->data + 16);
+    self->pyramidFactor = (int) (getU32(self->data + 20) & 0xFFFF);
+    self->nLevels = (int) (getU32(self->data + 20) >> 16);
+    self->samplePeriod = bitsDouble(getU64(self->data + 24));
+    self->startTime = bitsDouble(getU64(self->data + 32));
+    if (self->nSignals < 1 || self->nSignals > IKSIGLOG_MAXSIGNALS || self->chunkSize < 1
+            || self->nLevels > IKSIGLOG_MAXLEVELS || (self->nLevels > 0 && self->pyramidFactor < 2)) {
+        ikSiglogReader_close(self);
+        return -3;
+    }
+    pos = 40;
+    for (i = 0; i < 2*self->nSignals; i++) {
+        char *dest = i & 1 ? self->units[i/2] : self->names[i/2];
+        size_t len;
+        if (pos + 2 > self->size) break;
+        len = getU16(self->data + pos);
+        if (len >= IKSIGLOG_MAXNAME || pos + 2 + len > self->size) break;
+        memcpy(dest, self->data + pos + 2, len);
+        dest[len] = '\0';
+        pos += 2 + len;
+    }
+    if (i < 2*self->nSignals) {
+        ikSiglogReader_close(self);
+        return -3;
+    }
+
+    /* locate the chunks */
+    err = readIndex(self, pos);
+    if (!err) {
+        self->scratch = (double *) malloc(sizeof(double)*(self->chunkSize > IKSIGLOG_PYRAMIDBLOCK ? self->chunkSize : IKSIGLOG_PYRAMIDBLOCK));
+        if (NULL == self->scratch) err = -4;
+    }
+    if (err) {
+        ikSiglogReader_close(self);
+        return err;
+    }
+
+    return 0;
+}
+
+int ikSiglogReader_findSignal(const ikSiglogReader *self, const char *name) {
+    int i;
+    for (i = 0; i < self->nSignals; i++) {
+        if (!strcmp(self->names[i], name)) return i;
+    }
+    return -1;
+}
+
+long ikSiglogReader_readColumn(ikSiglogReader *self, int signal, double *output, long first, long n) {
+    long done = 0;
+    long c, lo, hi;
+
+    if (signal < 0 || signal >= self->nSignals || first < 0 || n < 0) return -1;
+
+    /* find the last chunk starting at or before the first sample */
+    lo = 0;
+    hi = self->nChunks;
+    while (hi - lo > 1) {
+        long mid = (lo + hi)/2;
+        if (self->chunkFirst[mid] <= first) lo = mid;
+        else hi = mid;
+    }
+
+    for (c = lo; c < self->nChunks && done < n; c++) {
+        long chunkFirst = self->chunkFirst[c];
+        long chunkN = (long) self->chunkSamples[c];
+        if (first + done < chunkFirst + chunkN) {
+            const unsigned char *chunk = self->data + self->chunkOffsets[c];
+            size_t columnOffset = 8 + 4*(size_t) self->nSignals;
+            long from = first + done - chunkFirst;
+            long count = chunkN - from < n - done ? chunkN - from : n - done;
+            int i;
+            for (i = 0; i < signal; i++) columnOffset += getU32(chunk + 8 + 4*i);
+            if (decodeColumn(chunk + columnOffset, getU32(chunk + 8 + 4*signal), self->scratch, (int) chunkN)) return -1;
+            memcpy(output + done, self->scratch + from, sizeof(double)*count);
+            done += count;
+        }
+    }
+
+    return done;
+}
+
+long ikSiglogReader_readPyramid(ikSiglogReader *self, int signal, int level, double *minimum, double *maximum, double *mean, long first, long n) {
+    double *outputs[3];
+    long done = 0;
+    long b;
+
+    if (signal < 0 || signal >= self->nSignals || level < 1 || level > self->nLevels || first < 0 || n < 0) return -1;
+    outputs[0] = minimum;
+    outputs[1] = maximum;
+    outputs[2] = mean;
+
+    /* the blocks of a level are in order of their first entry */
+    for (b = 0; b < self->nBlocks && done < n; b++) {
+        const unsigned char *block = self->data + self->blockOffsets[b];
+        long blockFirst = self->blockFirst[b];
+        long blockN = (long) getU32(block + 4);
+        if (self->blockLevels[b] != level || first + done < blockFirst || first + done >= blockFirst + blockN) continue;
+        {
+            long from = first + done - blockFirst;
+            long count = blockN - from < n - done ? blockN - from : n - done;
+            int statistic;
+            for (statistic = 0; statistic < 3; statistic++) {
+                const int column = statistic*self->nSignals + signal;
+                size_t columnOffset = PYRAMID_HEADER + 12*(size_t) self->nSignals;
+                int i;
+                if (NULL == outputs[statistic]) continue;
+                for (i = 0; i < column; i++) columnOffset += getU32(block + PYRAMID_HEADER + 4*i);
+                if (decodeColumn(block + columnOffset, getU32(block + PYRAMID_HEADER + 4*column), self->scratch, (int) blockN)) return -1;
+                memcpy(outputs[statistic] + done, self->scratch + from, sizeof(double)*count);
+            }
+            done += count;
+        }
+    }
+
+    return done;
+}
+
+void ikSiglogReader_close(ikSiglogReader *self) {
+    unmapFile(self);
+    free(self->chunkOffsets);
+    free(self->chunkSamples);
+    free(self->chunkFirst);
+    free(self->blockOffsets);
+    free(self->blockFirst);
+    free(self->blockLevels);
+    free(self->scratch);
+    self->chunkOffsets = NULL;
+    self->chunkSamples = NULL;
+    self->chunkFirst = NULL;
+    self->blockOffsets = NULL;
+    self->blockFirst = NULL;
+    self->blockLevels = NULL;
+    self->scratch = NULL;
+    self->nChunks = 0;
+    self->nBlocks = 0;
+}
+
+/* @endcond */
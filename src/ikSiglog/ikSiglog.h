@@ -0,0 +1,273 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikSiglog.h
+ *
+ * @brief Class ikSiglog interface
+ */
+
+#ifndef IKSIGLOG_H
+#define IKSIGLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define IKSIGLOG_MAXSIGNALS 64 /**<maximum number of signals in a log*/
+#define IKSIGLOG_MAXNAME 128 /**<maximum length of signal names and units, including the terminating NULL*/
+#define IKSIGLOG_VERSION 2 /**<file format version. Version 1 files, which have no pyramid, are read too*/
+#define IKSIGLOG_MAXLEVELS 8 /**<maximum number of pyramid levels*/
+#define IKSIGLOG_PYRAMIDBLOCK 256 /**<number of pyramid entries per pyramid block*/
+
+    /**
+     * @struct ikSiglog
+     * @brief Compressed columnar signal log writer
+     *
+     * Signal logs are self-describing binary files. The file starts with a
+     * header holding the format version, the sample period, the start time
+     * and the name and unit of every signal. Samples follow in chunks of
+     * a fixed number of samples, and within each chunk every signal is
+     * stored as a separately compressed column, so that a reader can decode
+     * a single signal without touching the others. The file ends with a
+     * chunk index, which @link ikSiglogReader @endlink uses to locate the
+     * chunks; if the file was not closed properly the index is missing and
+     * the reader falls back to scanning the chunks.
+     *
+     * Optionally, the log also holds a pyramid of decimated levels, for
+     * browsing long logs without decoding them: level l has an entry per
+     * factor^l consecutive samples of every signal, holding their minimum,
+     * maximum and mean. Entries are kept in blocks of
+     * @link IKSIGLOG_PYRAMIDBLOCK @endlink, written between the chunks as
+     * they fill up, each signal and statistic a column compressed as the
+     * samples are, and listed in the chunk index along with the chunks. A
+     * reader can thus get an overview of a signal over a whole multi-hour
+     * log from a coarse level, a few kilobytes, and then decode only the
+     * chunks of the stretch it is after. Keeping the pyramid costs a few
+     * comparisons and an addition per signal and sample.
+     *
+     * Columns are compressed losslessly with an XOR codec: every value is
+     * predicted from the previous ones, the prediction is XOR'ed with the
+     * actual bit pattern and only the meaningful bits of the result are
+     * stored. Two predictors are tried for each column and chunk, the
+     * previous value and a linear extrapolation of the integer bit patterns
+     * (a delta predictor), and the one giving the shorter column is kept.
+     * Constant signals cost 1 bit per sample, and slowly varying ones a small
+     * fraction of the 64 bits of a raw double.
+     *
+     * All integers and doubles are stored little-endian.
+     *
+     * @par Methods
+     * @li @link ikSiglog_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikSiglog_init @endlink open a new log file
+     * @li @link ikSiglog_write @endlink append a sample of every signal
+     * @li @link ikSiglog_close @endlink flush and close the log file
+     */
+    typedef struct ikSiglog {
+        /* @cond */
+        FILE *file;
+        int nSignals;
+        int chunkSize;
+        int nBuffered;
+        double *buffer;
+        unsigned char *packed;
+        size_t packedCapacity;
+        uint64_t offset;
+        uint64_t *chunkOffsets;
+        uint32_t *chunkSamples;
+        uint32_t *chunkLevels;
+        long nChunks;
+        long chunkCapacity;
+        int pyramidFactor;
+        int nLevels;
+        double *accumulators;
+        long accumulatedSamples[IKSIGLOG_MAXLEVELS];
+        int accumulatedEntries[IKSIGLOG_MAXLEVELS];
+        double *pyramid;
+        int nPyramidBuffered[IKSIGLOG_MAXLEVELS];
+        uint64_t pyramidFirst[IKSIGLOG_MAXLEVELS];
+        /* @endcond */
+    } ikSiglog;
+
+    /**
+     * @struct ikSiglogParams
+     * @brief Signal log initialisation parameters
+     */
+    typedef struct ikSiglogParams {
+        const char *fileName; /**<name of the file to be written. The default value is "log.bin"*/
+        int nSignals; /**<number of signals, between 1 and @link IKSIGLOG_MAXSIGNALS @endlink. The default value is 0*/
+        const char *names[IKSIGLOG_MAXSIGNALS]; /**<signal names, typically as given to the getOutput method of the logged block. The default value is {NULL, NULL, ...}*/
+        const char *units[IKSIGLOG_MAXSIGNALS]; /**<signal units. NULL means non-dimensional. The default value is {NULL, NULL, ...}*/
+        double samplePeriod; /**<sample period, in s. The default value is 0.01*/
+        double startTime; /**<time of the first sample, in s. The default value is 0.0*/
+        int chunkSize; /**<number of samples per chunk. The default value is 4096*/
+        int pyramidLevels; /**<number of pyramid levels, between 0, for no pyramid, and @link IKSIGLOG_MAXLEVELS @endlink. The default value is 0*/
+        int pyramidFactor; /**<decimation factor between consecutive pyramid levels, between 2 and 65535. The default value is 16*/
+    } ikSiglogParams;
+
+    /**
+     * @struct ikSiglogReader
+     * @brief Signal log reader
+     *
+     * The log file is memory-mapped, and signals are decoded column by column
+     * on request, so that reading one signal of a long multi-signal log only
+     * touches the pages holding that signal.
+     *
+     * @par Methods
+     * @li @link ikSiglogReader_open @endlink open a log file
+     * @li @link ikSiglogReader_findSignal @endlink look up a signal by name
+     * @li @link ikSiglogReader_readColumn @endlink decode samples of a signal
+     * @li @link ikSiglogReader_readPyramid @endlink decode pyramid entries of a signal
+     * @li @link ikSiglogReader_close @endlink release the log file
+     */
+    typedef struct ikSiglogReader {
+        int nSignals; /**<number of signals*/
+        char names[IKSIGLOG_MAXSIGNALS][IKSIGLOG_MAXNAME]; /**<signal names*/
+        char units[IKSIGLOG_MAXSIGNALS][IKSIGLOG_MAXNAME]; /**<signal units*/
+        double samplePeriod; /**<sample period, in s*/
+        double startTime; /**<time of the first sample, in s*/
+        long nSamples; /**<number of samples per signal*/
+        int nLevels; /**<number of pyramid levels, 0 if there is no pyramid*/
+        int pyramidFactor; /**<decimation factor between consecutive pyramid levels*/
+        long nEntries[IKSIGLOG_MAXLEVELS + 1]; /**<number of entries of pyramid level l, at index l, with the samples as level 0*/
+        /* @cond */
+        const unsigned char *data;
+        size_t size;
+        void *mapHandle;
+        int chunkSize;
+        long nChunks;
+        uint64_t *chunkOffsets;
+        uint32_t *chunkSamples;
+        long *chunkFirst;
+        long nBlocks;
+        uint64_t *blockOffsets;
+        long *blockFirst;
+        int *blockLevels;
+        double *scratch;
+        /* @endcond */
+    } ikSiglogReader;
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikSiglog_initParams(ikSiglogParams *params);
+
+    /**
+     * Open a new log file and write its header
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid number of signals, chunk size or sample period
+     * @li -2: invalid signal name or unit, they must be non-empty and shorter than @link IKSIGLOG_MAXNAME @endlink
+     * @li -3: unable to allocate memory
+     * @li -4: unable to open the file
+     */
+    int ikSiglog_init(ikSiglog *self, const ikSiglogParams *params);
+
+    /**
+     * Append a sample of every signal
+     * @param self instance
+     * @param values signal values, in the order given at initialisation
+     * @return error code:
+     * @li 0: no error
+     * @li -1: log not open
+     * @li -2: write error
+     */
+    int ikSiglog_write(ikSiglog *self, const double *values);
+
+    /**
+     * Flush the remaining samples, write the chunk index and close the file
+     * @param self instance
+     * @return error code:
+     * @li 0: no error
+     * @li -1: log not open
+     * @li -2: write error
+     */
+    int ikSiglog_close(ikSiglog *self);
+
+    /**
+     * Open a log file for reading
+     * @param self instance
+     * @param fileName log file name
+     * @return error code:
+     * @li 0: no error
+     * @li -1: unable to open or map the file
+     * @li -2: not a signal log, or unsupported version
+     * @li -3: corrupt header or chunk
+     * @li -4: unable to allocate memory
+     */
+    int ikSiglogReader_open(ikSiglogReader *self, const char *fileName);
+
+    /**
+     * Look up a signal by name
+     * @param self instance
+     * @param name signal name
+     * @return signal index, or -1 if there is no such signal
+     */
+    int ikSiglogReader_findSignal(const ikSiglogReader *self, const char *name);
+
+    /**
+     * Decode samples of a signal. Only the chunks overlapping the requested
+     * range are decoded, and the first of them is found by bisection of the
+     * chunk index.
+     * @param self instance
+     * @param signal signal index
+     * @param output decoded values, room for n values
+     * @param first index of the first sample to decode
+     * @param n number of samples to decode
+     * @return number of samples decoded, which is less than n if the log
+     * ends before, or -1 for an invalid signal index or a corrupt chunk
+     */
+    long ikSiglogReader_readColumn(ikSiglogReader *self, int signal, double *output, long first, long n);
+
+    /**
+     * Decode pyramid entries of a signal. Entry i of level l covers samples
+     * i*factor^l to (i + 1)*factor^l - 1, fewer for the last one. Only the
+     * blocks overlapping the requested range are decoded, and only the
+     * columns asked for.
+     * @param self instance
+     * @param signal signal index
+     * @param level pyramid level, from 1 to the number of levels
+     * @param minimum decoded minima, room for n values, or NULL if not needed
+     * @param maximum decoded maxima, room for n values, or NULL if not needed
+     * @param mean decoded means, room for n values, or NULL if not needed
+     * @param first index of the first entry to decode
+     * @param n number of entries to decode
+     * @return number of entries decoded, which is less than n if the level
+     * ends before, or -1 for an invalid signal index or level or a corrupt
+     * block
+     */
+    long ikSiglogReader_readPyramid(ikSiglogReader *self, int signal, int level, double *minimum, double *maximum, double *mean, long first, long n);
+
+    /**
+     * Release the log file
+     * @param self instance
+     */
+    void ikSiglogReader_close(ikSiglogReader *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKSIGLOG_H */
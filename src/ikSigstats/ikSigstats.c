@@ -0,0 +1,244 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikSigstats.c
+ *
+ * @brief Class ikSigstats implementation
+ */
+
+/* @cond */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "ikSigstats.h"
+
+int ikSigstats_init(ikSigstats *self, const ikSigstatsParams *params) {
+    int i, j, k;
+
+    /* register the signals */
+    if (params->nSignals < 0 || params->nSignals > IKSIGSTATS_MAXSIGNALS) return -1;
+    self->nSignals = params->nSignals;
+    for (i = 0; i < self->nSignals; i++) {
+        if (NULL == params->names[i] || strlen(params->names[i]) >= IKSIGSTATS_MAXNAME) return -1;
+        strcpy(self->names[i], params->names[i]);
+        if (params->nStates[i] < 0 || params->nStates[i] > IKSIGSTATS_MAXSTATES) return -3;
+    }
+
+    /* register the quantiles, and the probabilities of the markers: the
+       minimum, each quantile and the points halfway between them, and the maximum */
+    if (params->nQuantiles < 0 || params->nQuantiles > IKSIGSTATS_MAXQUANTILES) return -2;
+    self->nQuantiles = params->nQuantiles;
+    self->nMarkers = self->nQuantiles > 0 ? 2*self->nQuantiles + 3 : 0;
+    for (k = 0; k < self->nQuantiles; k++) {
+        const double previous = k > 0 ? params->quantiles[k - 1] : 0.0;
+        if (params->quantiles[k] <= previous || params->quantiles[k] >= 1.0) return -2;
+        self->quantiles[k] = params->quantiles[k];
+        self->increments[2*k + 1] = 0.5*(previous + params->quantiles[k]);
+        self->increments[2*k + 2] = params->quantiles[k];
+    }
+    if (self->nMarkers > 0) {
+        self->increments[0] = 0.0;
+        self->increments[self->nMarkers - 2] = 0.5*(self->quantiles[self->nQuantiles - 1] + 1.0);
+        self->increments[self->nMarkers - 1] = 1.0;
+    }
+
+    /* start from nothing */
+    for (i = 0; i < self->nSignals; i++) {
+        ikSigstatsSignal *s = &(self->signals[i]);
+        s->n = 0;
+        s->mean = 0.0;
+        s->m2 = 0.0;
+        s->minimum = 0.0;
+        s->maximum = 0.0;
+        for (j = 0; j < IKSIGSTATS_MAXMARKERS; j++) {
+            s->heights[j] = 0.0;
+            s->positions[j] = 0.0;
+            s->desired[j] = 0.0;
+        }
+        s->nStates = params->nStates[i];
+        for (j = 0; j < IKSIGSTATS_MAXSTATES; j++) s->occupancy[j] = 0;
+    }
+
+    return 0;
+}
+
+void ikSigstats_initParams(ikSigstatsParams *params) {
+    int i;
+
+    params->nSignals = 0;
+    for (i = 0; i < IKSIGSTATS_MAXSIGNALS; i++) {
+        params->names[i] = NULL;
+        params->nStates[i] = 0;
+    }
+    params->nQuantiles = 5;
+    for (i = 0; i < IKSIGSTATS_MAXQUANTILES; i++) params->quantiles[i] = 0.0;
+    params->quantiles[0] = 0.01;
+    params->quantiles[1] = 0.05;
+    params->quantiles[2] = 0.5;
+    params->quantiles[3] = 0.95;
+    params->quantiles[4] = 0.99;
+}
+
+/* extended P-square update of the markers of a signal */
+static void updateMarkers(const ikSigstats *self, ikSigstatsSignal *s, double x) {
+    double *h = s->heights;
+    double *n = s->positions;
+    const int last = self->nMarkers - 1;
+    int i, k;
+
+    /* keep the first samples, sorted, and place the markers on them */
+    if (s->n <= self->nMarkers) {
+        for (i = (int) s->n - 1; i > 0 && h[i - 1] > x; i--) h[i] = h[i - 1];
+        h[i] = x;
+        if (s->n == self->nMarkers) {
+            for (i = 0; i <= last; i++) {
+                n[i] = i + 1.0;
+                s->desired[i] = 1.0 + last*self->increments[i];
+            }
+        }
+        return;
+    }
+
+    /* find the cell of the sample, stretching the ends to it if needed */
+    if (x < h[0]) {
+        h[0] = x;
+        k = 0;
+    } else if (x >= h[last]) {
+        h[last] = x;
+        k = last - 1;
+    } else {
+        for (k = 0; x >= h[k + 1]; k++);
+    }
+
+    /* shift the markers above it, and the desired positions of all */
+    for (i = k + 1; i <= last; i++) n[i] += 1.0;
+    for (i = 0; i <= last; i++) s->desired[i] += self->increments[i];
+
+    /* move the inner markers that have drifted by a place or more */
+    for (i = 1; i < last; i++) {
+        const double d = s->desired[i] - n[i];
+        if ((d >= 1.0 && n[i + 1] - n[i] > 1.0) || (d <= -1.0 && n[i - 1] - n[i] < -1.0)) {
+            const double sign = d > 0.0 ? 1.0 : -1.0;
+            const int j = d > 0.0 ? i + 1 : i - 1;
+            double candidate = h[i] + sign/(n[i + 1] - n[i - 1])*((n[i] - n[i - 1] + sign)*(h[i + 1] - h[i])/(n[i + 1] - n[i])
+                    + (n[i + 1] - n[i] - sign)*(h[i] - h[i - 1])/(n[i] - n[i - 1]));
+            if (candidate <= h[i - 1] || candidate >= h[i + 1]) candidate = h[i] + sign*(h[j] - h[i])/(n[j] - n[i]);
+            h[i] = candidate;
+            n[i] += sign;
+        }
+    }
+}
+
+void ikSigstats_step(ikSigstats *self, const double *values) {
+    int i;
+
+    for (i = 0; i < self->nSignals; i++) {
+        ikSigstatsSignal *s = &(self->signals[i]);
+        const double x = values[i];
+        double delta;
+
+        /* Welford's running mean and sum of squared deviations */
+        s->n++;
+        delta = x - s->mean;
+        s->mean += delta/s->n;
+        s->m2 += delta*(x - s->mean);
+        if (1 == s->n || x < s->minimum) s->minimum = x;
+        if (1 == s->n || x > s->maximum) s->maximum = x;
+
+        if (s->nStates > 0) {
+            const double state = floor(x + 0.5);
+            if (state >= 0.0 && state < s->nStates) s->occupancy[(int) state]++;
+        }
+        if (self->nMarkers > 0) updateMarkers(self, s, x);
+    }
+}
+
+/* quantile k of a signal, interpolated from the samples kept while there are few */
+static double quantile(const ikSigstats *self, const ikSigstatsSignal *s, int k) {
+    double position;
+    int i;
+
+    if (s->n < 1) return 0.0;
+    if (s->n > self->nMarkers) return s->heights[2*k + 2];
+    position = self->quantiles[k]*(s->n - 1);
+    i = (int) position;
+    if (i >= s->n - 1) return s->heights[s->n - 1];
+    return s->heights[i] + (position - i)*(s->heights[i + 1] - s->heights[i]);
+}
+
+int ikSigstats_getOutput(const ikSigstats *self, double *output, const char *name) {
+    char candidate[IKSIGSTATS_MAXNAME + 32];
+    int i, k;
+
+    /* pick up the signal names */
+    if (!strcmp(name, "samples")) {
+        *output = self->nSignals > 0 ? (double) self->signals[0].n : 0.0;
+        return 0;
+    }
+    for (k = 0; k < self->nQuantiles; k++) {
+        sprintf(candidate, "quantile %d", k + 1);
+        if (!strcmp(name, candidate)) {
+            *output = self->quantiles[k];
+            return 0;
+        }
+    }
+    for (i = 0; i < self->nSignals; i++) {
+        const ikSigstatsSignal *s = &(self->signals[i]);
+        const size_t length = strlen(self->names[i]);
+
+        if (strncmp(name, self->names[i], length) || ' ' != name[length]) continue;
+        if (!strcmp(name + length + 1, "mean")) {
+            *output = s->mean;
+            return 0;
+        }
+        if (!strcmp(name + length + 1, "standard deviation")) {
+            *output = s->n > 1 ? sqrt(s->m2/(s->n - 1)) : 0.0;
+            return 0;
+        }
+        if (!strcmp(name + length + 1, "minimum")) {
+            *output = s->minimum;
+            return 0;
+        }
+        if (!strcmp(name + length + 1, "maximum")) {
+            *output = s->maximum;
+            return 0;
+        }
+        for (k = 0; k < self->nQuantiles; k++) {
+            sprintf(candidate, "quantile %d", k + 1);
+            if (!strcmp(name + length + 1, candidate)) {
+                *output = quantile(self, s, k);
+                return 0;
+            }
+        }
+        for (k = 0; k < s->nStates; k++) {
+            sprintf(candidate, "occupancy %d", k);
+            if (!strcmp(name + length + 1, candidate)) {
+                *output = s->n > 0 ? (double) s->occupancy[k]/s->n : 0.0;
+                return 0;
+            }
+        }
+    }
+
+    return -1;
+}
+
+/* @endcond */
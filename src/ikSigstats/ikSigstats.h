@@ -0,0 +1,160 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikSigstats.h
+ *
+ * @brief Class ikSigstats interface
+ */
+
+#ifndef IKSIGSTATS_H
+#define IKSIGSTATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IKSIGSTATS_MAXSIGNALS 16 /**<maximum number of signals*/
+#define IKSIGSTATS_MAXQUANTILES 8 /**<maximum number of estimated quantiles*/
+#define IKSIGSTATS_MAXMARKERS (2*IKSIGSTATS_MAXQUANTILES + 3) /**<maximum number of quantile markers per signal*/
+#define IKSIGSTATS_MAXSTATES 8 /**<maximum number of states of a discrete signal*/
+#define IKSIGSTATS_MAXNAME 64 /**<maximum length of signal names, including the terminating NULL*/
+
+    /* @cond */
+    typedef struct ikSigstatsSignal {
+        long n;
+        double mean;
+        double m2;
+        double minimum;
+        double maximum;
+        double heights[IKSIGSTATS_MAXMARKERS];
+        double positions[IKSIGSTATS_MAXMARKERS];
+        double desired[IKSIGSTATS_MAXMARKERS];
+        int nStates;
+        long occupancy[IKSIGSTATS_MAXSTATES];
+    } ikSigstatsSignal;
+    /* @endcond */
+
+    /**
+     * @struct ikSigstats
+     * @brief Streaming summary statistics
+     *
+     * The collector takes one sample of each of a set of signals per step
+     * and keeps their summary statistics over the run, so that these may be
+     * had without logging the time series.
+     *
+     * The mean and standard deviation are kept by Welford's method, as the
+     * running mean and sum of squared deviations from it, which does not
+     * lose precision over long runs as plain sums of squares do. The
+     * quantiles are estimated by the extended P-square algorithm: for m
+     * quantiles, 2m + 3 markers track the minimum, the quantiles, the points
+     * halfway between them and the maximum, and each step moves the markers
+     * whose position in the sorted samples has drifted from the desired one
+     * by one place, adjusting their heights by piecewise-parabolic
+     * interpolation. Memory stays fixed whatever the length of the run, and
+     * a step costs a pass over the markers of each signal. Until there are
+     * more samples than markers, the quantiles are exact.
+     *
+     * A discrete signal, such as a state machine state, also has its
+     * occupancy kept: the fraction of the samples in which its value, rounded
+     * to the nearest integer, was each of its states. Values outside the
+     * states are not counted in any.
+     *
+     * @par Inputs
+     * @li signal values: specify via @link ikSigstats_step @endlink
+     *
+     * @par Outputs
+     * @li samples: number of samples taken, get via @link ikSigstats_getOutput @endlink
+     * @li quantile probabilities: get via @link ikSigstats_getOutput @endlink as "quantile <k>", with k from 1 to the number of quantiles
+     * @li mean, standard deviation, minimum and maximum of each signal: in signal units, get via @link ikSigstats_getOutput @endlink as "<signal name> mean", "<signal name> standard deviation", "<signal name> minimum" and "<signal name> maximum"
+     * @li quantiles of each signal: in signal units, get via @link ikSigstats_getOutput @endlink as "<signal name> quantile <k>"
+     * @li occupancy of each state of a discrete signal: non-dimensional, get via @link ikSigstats_getOutput @endlink as "<signal name> occupancy <s>", with s from 0 to the number of states less 1
+     *
+     * @par Methods
+     * @li @link ikSigstats_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikSigstats_init @endlink initialise an instance
+     * @li @link ikSigstats_step @endlink execute periodic calculations
+     * @li @link ikSigstats_getOutput @endlink get output value
+     */
+    typedef struct ikSigstats {
+        /* @cond */
+        int nSignals;
+        int nQuantiles;
+        int nMarkers;
+        double quantiles[IKSIGSTATS_MAXQUANTILES];
+        double increments[IKSIGSTATS_MAXMARKERS];
+        ikSigstatsSignal signals[IKSIGSTATS_MAXSIGNALS];
+        char names[IKSIGSTATS_MAXSIGNALS][IKSIGSTATS_MAXNAME];
+        /* @endcond */
+    } ikSigstats;
+
+    /**
+     * @struct ikSigstatsParams
+     * @brief Streaming summary statistics initialisation parameters
+     */
+    typedef struct ikSigstatsParams {
+        int nSignals; /**<number of signals, between 0 and @link IKSIGSTATS_MAXSIGNALS @endlink. The default value is 0*/
+        const char *names[IKSIGSTATS_MAXSIGNALS]; /**<signal names, shorter than @link IKSIGSTATS_MAXNAME @endlink. The default value is {NULL, NULL, ...}*/
+        int nStates[IKSIGSTATS_MAXSIGNALS]; /**<number of states of each signal, between 0, for a continuous signal, and @link IKSIGSTATS_MAXSTATES @endlink. The default value is {0, 0, ...}*/
+        int nQuantiles; /**<number of estimated quantiles, between 0 and @link IKSIGSTATS_MAXQUANTILES @endlink. The default value is 5*/
+        double quantiles[IKSIGSTATS_MAXQUANTILES]; /**<probabilities of the estimated quantiles, in increasing order, between 0 and 1, exclusive. The default value is {0.01, 0.05, 0.5, 0.95, 0.99, 0.0, ...}*/
+    } ikSigstatsParams;
+
+    /**
+     * Initialise an instance, with no samples taken
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signals
+     * @li -2: invalid quantiles
+     * @li -3: invalid number of states
+     */
+    int ikSigstats_init(ikSigstats *self, const ikSigstatsParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikSigstats_initParams(ikSigstatsParams *params);
+
+    /**
+     * Execute periodic calculations
+     * @param self statistics instance
+     * @param values signal values, in the order given at initialisation
+     */
+    void ikSigstats_step(ikSigstats *self, const double *values);
+
+    /**
+     * Get output value by name. All outputs are available at any time, and
+     * are 0 until a sample has been taken.
+     * @param self statistics instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     */
+    int ikSigstats_getOutput(const ikSigstats *self, double *output, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKSIGSTATS_H */
@@ -0,0 +1,130 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikSpecmon.c
+ *
+ * @brief Class ikSpecmon implementation
+ */
+
+/* @cond */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "ikSpecmon.h"
+
+int ikSpecmon_init(ikSpecmon *self, const ikSpecmonParams *params) {
+    double nyquist;
+    int i, k;
+
+    /* register the signals */
+    if (params->nSignals < 0 || params->nSignals > IKSPECMON_MAXSIGNALS) return -1;
+    if (params->nSignals > 0 && NULL == params->nameStore) return -1;
+    self->nSignals = params->nSignals;
+    self->names = params->nameStore;
+    for (i = 0; i < self->nSignals; i++) {
+        if (NULL == params->names[i] || strlen(params->names[i]) >= IKSPECMON_MAXNAME) return -1;
+        strcpy(self->names->names[i], params->names[i]);
+    }
+
+    /* register the window */
+    if (params->windowTime <= 0.0 || params->samplePeriod <= 0.0) return -3;
+    self->decay = exp(-params->samplePeriod/params->windowTime);
+
+    /* register the frequencies, as rotations per sample */
+    if (params->nFrequencies < 0 || params->nFrequencies > IKSPECMON_MAXFREQUENCIES) return -2;
+    self->nFrequencies = params->nFrequencies;
+    nyquist = 3.14159265358979/params->samplePeriod;
+    for (k = 0; k < self->nFrequencies; k++) {
+        if (params->frequencies[k] <= 0.0 || params->frequencies[k] >= nyquist) return -2;
+        self->frequencies[k] = params->frequencies[k];
+        self->rotationRe[k] = self->decay*cos(params->frequencies[k]*params->samplePeriod);
+        self->rotationIm[k] = self->decay*sin(params->frequencies[k]*params->samplePeriod);
+    }
+
+    /* start from nothing */
+    for (i = 0; i < self->nSignals; i++) {
+        self->mean[i] = 0.0;
+        for (k = 0; k < self->nFrequencies; k++) {
+            self->sumRe[i][k] = 0.0;
+            self->sumIm[i][k] = 0.0;
+        }
+    }
+
+    return 0;
+}
+
+void ikSpecmon_initParams(ikSpecmonParams *params) {
+    int i;
+
+    params->nSignals = 0;
+    for (i = 0; i < IKSPECMON_MAXSIGNALS; i++) params->names[i] = NULL;
+    params->nameStore = NULL;
+    params->nFrequencies = 0;
+    for (i = 0; i < IKSPECMON_MAXFREQUENCIES; i++) params->frequencies[i] = 0.0;
+    params->windowTime = 20.0;
+    params->samplePeriod = 0.01;
+}
+
+void ikSpecmon_step(ikSpecmon *self, const double *values) {
+    int i, k;
+
+    for (i = 0; i < self->nSignals && self->nFrequencies > 0; i++) {
+        double x;
+
+        /* take out the running mean, which would leak into low frequencies */
+        self->mean[i] += (1.0 - self->decay)*(values[i] - self->mean[i]);
+        x = values[i] - self->mean[i];
+
+        /* rotate and decay the sums, and add the new sample */
+        for (k = 0; k < self->nFrequencies; k++) {
+            double re = self->sumRe[i][k];
+            double im = self->sumIm[i][k];
+            self->sumRe[i][k] = self->rotationRe[k]*re - self->rotationIm[k]*im + x;
+            self->sumIm[i][k] = self->rotationIm[k]*re + self->rotationRe[k]*im;
+        }
+    }
+}
+
+int ikSpecmon_getOutput(const ikSpecmon *self, double *output, const char *name) {
+    char candidate[IKSPECMON_MAXNAME + 32];
+    int i, k;
+
+    /* pick up the signal names */
+    for (k = 0; k < self->nFrequencies; k++) {
+        sprintf(candidate, "frequency %d", k + 1);
+        if (!strcmp(name, candidate)) {
+            *output = self->frequencies[k];
+            return 0;
+        }
+        for (i = 0; i < self->nSignals; i++) {
+            sprintf(candidate, "%s amplitude %d", self->names->names[i], k + 1);
+            if (!strcmp(name, candidate)) {
+                *output = 2.0*(1.0 - self->decay)*sqrt(self->sumRe[i][k]*self->sumRe[i][k] + self->sumIm[i][k]*self->sumIm[i][k]);
+                return 0;
+            }
+        }
+    }
+
+    return -1;
+}
+
+/* @endcond */
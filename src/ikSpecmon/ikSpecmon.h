@@ -0,0 +1,152 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikSpecmon.h
+ *
+ * @brief Class ikSpecmon interface
+ */
+
+#ifndef IKSPECMON_H
+#define IKSPECMON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IKSPECMON_MAXSIGNALS 4 /**<maximum number of monitored signals*/
+#define IKSPECMON_MAXFREQUENCIES 8 /**<maximum number of monitored frequencies*/
+#define IKSPECMON_MAXNAME 64 /**<maximum length of signal names, including the terminating NULL*/
+
+    /**
+     * @struct ikSpecmonNames
+     * @brief Streaming spectral monitor signal names
+     */
+    typedef struct ikSpecmonNames {
+        char names[IKSPECMON_MAXSIGNALS][IKSPECMON_MAXNAME]; /**<signal names*/
+    } ikSpecmonNames;
+
+    /**
+     * @struct ikSpecmon
+     * @brief Streaming spectral monitor
+     *
+     * The monitor tracks the amplitude of a set of signals at a set of
+     * frequencies, for instance to check the effect of notch filters on a
+     * structural mode without logging the signals for later analysis.
+     *
+     * Each signal, less its running mean, drives a damped complex resonator
+     * per frequency,
+     * S(n) = r*exp(j*w*T)*S(n-1) + x(n),
+     * which accumulates the discrete Fourier transform of the signal at
+     * frequency w over an exponentially decaying window, of time constant
+     * tau = -T/ln(r). The amplitude of the signal at w is then
+     * 2*(1 - r)*|S|, and its resolution in frequency about 1/tau. This is
+     * not a sliding Goertzel filter over the last N samples, which would
+     * keep N samples of history per signal: a step costs a complex
+     * multiplication per signal and frequency, with no sample history kept,
+     * at the price of older samples fading out gradually instead of
+     * dropping out of a window of fixed length.
+     *
+     * The signal names are kept apart, in a @link ikSpecmonNames @endlink
+     * block given at initialisation, as they are only read by
+     * @link ikSpecmon_getOutput @endlink, see @link ikLayout.h @endlink.
+     *
+     * @par Inputs
+     * @li signal values: specify via @link ikSpecmon_step @endlink
+     *
+     * @par Outputs
+     * @li amplitude of each signal at each frequency: in signal units, get via @link ikSpecmon_getOutput @endlink as "<signal name> amplitude <i>", with i from 1 to the number of frequencies
+     * @li frequencies: in rad/s, get via @link ikSpecmon_getOutput @endlink as "frequency <i>"
+     *
+     * @par Methods
+     * @li @link ikSpecmon_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikSpecmon_init @endlink initialise an instance
+     * @li @link ikSpecmon_step @endlink execute periodic calculations
+     * @li @link ikSpecmon_getOutput @endlink get output value
+     */
+    typedef struct ikSpecmon {
+        /* @cond */
+        int nSignals;
+        int nFrequencies;
+        double decay;
+        double rotationRe[IKSPECMON_MAXFREQUENCIES];
+        double rotationIm[IKSPECMON_MAXFREQUENCIES];
+        double mean[IKSPECMON_MAXSIGNALS];
+        double sumRe[IKSPECMON_MAXSIGNALS][IKSPECMON_MAXFREQUENCIES];
+        double sumIm[IKSPECMON_MAXSIGNALS][IKSPECMON_MAXFREQUENCIES];
+        double frequencies[IKSPECMON_MAXFREQUENCIES];
+        ikSpecmonNames *names;
+        /* @endcond */
+    } ikSpecmon;
+
+    /**
+     * @struct ikSpecmonParams
+     * @brief Streaming spectral monitor initialisation parameters
+     */
+    typedef struct ikSpecmonParams {
+        int nSignals; /**<number of signals, between 0 and @link IKSPECMON_MAXSIGNALS @endlink. The default value is 0*/
+        const char *names[IKSPECMON_MAXSIGNALS]; /**<signal names, shorter than @link IKSPECMON_MAXNAME @endlink. The default value is {NULL, NULL, ...}*/
+        ikSpecmonNames *nameStore; /**<where to keep the signal names for @link ikSpecmon_getOutput @endlink, typically in the cold part of the instance holding the monitor, see @link ikLayout.h @endlink. It is needed if there are signals. The default value is NULL*/
+        int nFrequencies; /**<number of frequencies, between 0 and @link IKSPECMON_MAXFREQUENCIES @endlink. With no frequencies, the monitor does nothing. The default value is 0*/
+        double frequencies[IKSPECMON_MAXFREQUENCIES]; /**<frequencies, in rad/s, between 0 and the Nyquist frequency, exclusive. The default value is {0.0, 0.0, ...}*/
+        double windowTime; /**<time constant of the exponential window, in s. It must be positive. The default value is 20.0*/
+        double samplePeriod; /**<sample period, in s. It must be positive. The default value is 0.01*/
+    } ikSpecmonParams;
+
+    /**
+     * Initialise an instance
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signals, or no name store for them
+     * @li -2: invalid frequencies
+     * @li -3: invalid window time or sample period
+     */
+    int ikSpecmon_init(ikSpecmon *self, const ikSpecmonParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikSpecmon_initParams(ikSpecmonParams *params);
+
+    /**
+     * Execute periodic calculations
+     * @param self spectral monitor instance
+     * @param values signal values, in the order given at initialisation
+     */
+    void ikSpecmon_step(ikSpecmon *self, const double *values);
+
+    /**
+     * Get output value by name
+     * @param self spectral monitor instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     */
+    int ikSpecmon_getOutput(const ikSpecmon *self, double *output, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKSPECMON_H */
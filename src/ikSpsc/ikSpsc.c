@@ -0,0 +1,81 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikSpsc.c
+ *
+ * @brief Class ikSpsc implementation
+ */
+
+/* @cond */
+
+#include "ikSpsc.h"
+
+int ikSpsc_init(ikSpsc *self, const ikSpscParams *params) {
+    /* register the size */
+    if (params->size < 2 || params->size > IKSPSC_MAXSIZE || (params->size & (params->size - 1))) return -1;
+    self->mask = params->size - 1;
+
+    /* start empty */
+    self->head = 0;
+    self->cachedTail = 0;
+    self->tail = 0;
+    self->cachedHead = 0;
+    ikAtomic_fence();
+
+    return 0;
+}
+
+void ikSpsc_initParams(ikSpscParams *params) {
+    params->size = 64;
+}
+
+int ikSpsc_push(ikSpsc *self, void *item) {
+    long tail = self->tail;
+
+    /* look at the consumer's position only when the queue seems full */
+    if (tail - self->cachedHead > self->mask) {
+        self->cachedHead = ikAtomic_load(&(self->head));
+        if (tail - self->cachedHead > self->mask) return -1;
+    }
+
+    /* publish the item with the new position */
+    self->slots[tail & self->mask] = item;
+    ikAtomic_store(&(self->tail), tail + 1);
+
+    return 0;
+}
+
+int ikSpsc_pop(ikSpsc *self, void **item) {
+    long head = self->head;
+
+    /* look at the producer's position only when the queue seems empty */
+    if (head == self->cachedTail) {
+        self->cachedTail = ikAtomic_load(&(self->tail));
+        if (head == self->cachedTail) return -1;
+    }
+
+    /* take the item before handing its slot back */
+    *item = self->slots[head & self->mask];
+    ikAtomic_store(&(self->head), head + 1);
+
+    return 0;
+}
+
+/* @endcond */
@@ -0,0 +1,118 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikSpsc.h
+ *
+ * @brief Class ikSpsc interface
+ */
+
+#ifndef IKSPSC_H
+#define IKSPSC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ikAtomic.h"
+#include "ikLayout.h"
+
+#define IKSPSC_MAXSIZE 1024 /**<maximum number of queued items*/
+
+    /**
+     * @struct ikSpsc
+     * @brief Lock-free single-producer/single-consumer queue
+     *
+     * A bounded ring of pointers, for handing items from one thread to
+     * another without locks. Exactly one thread may push and exactly one
+     * thread may pop. Neither ever waits: pushing to a full queue and
+     * popping from an empty one fail instead.
+     *
+     * The read and write positions are on cache lines of their own, each
+     * next to the copy of the other position its thread last read, so that
+     * the two threads only share a cache line when the queue looks full or
+     * empty to one of them. A pushed item, and whatever it points to, is
+     * visible to the popping thread once it pops it.
+     *
+     * @par Methods
+     * @li @link ikSpsc_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikSpsc_init @endlink initialise an instance
+     * @li @link ikSpsc_push @endlink push an item, from the producer thread
+     * @li @link ikSpsc_pop @endlink pop an item, from the consumer thread
+     */
+    typedef struct ikSpsc {
+        /* @cond */
+        IKLAYOUT_ALIGNED ikAtomicInt head;
+        long cachedTail;
+        IKLAYOUT_ALIGNED ikAtomicInt tail;
+        long cachedHead;
+        IKLAYOUT_ALIGNED long mask;
+        void *slots[IKSPSC_MAXSIZE];
+        /* @endcond */
+    } ikSpsc;
+
+    /**
+     * @struct ikSpscParams
+     * @brief Lock-free single-producer/single-consumer queue initialisation parameters
+     */
+    typedef struct ikSpscParams {
+        int size; /**<queue capacity, a power of 2 between 2 and @link IKSPSC_MAXSIZE @endlink. The default value is 64*/
+    } ikSpscParams;
+
+    /**
+     * Initialise an instance, empty
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid size
+     */
+    int ikSpsc_init(ikSpsc *self, const ikSpscParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikSpsc_initParams(ikSpscParams *params);
+
+    /**
+     * Push an item
+     * @param self instance
+     * @param item item
+     * @return error code:
+     * @li 0: no error
+     * @li -1: the queue is full
+     */
+    int ikSpsc_push(ikSpsc *self, void *item);
+
+    /**
+     * Pop the oldest item
+     * @param self instance
+     * @param item popped item
+     * @return error code:
+     * @li 0: no error
+     * @li -1: the queue is empty
+     */
+    int ikSpsc_pop(ikSpsc *self, void **item);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKSPSC_H */
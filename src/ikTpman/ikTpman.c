@@ -34,28 +34,39 @@ int ikTpman_init(ikTpman *self, const ikTpmanParams *params) {
     /* set state to 0 */
     self->state = 0;
 
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+    /* register where to keep the inputs */
+    self->diag = params->diagnostics;
+#endif
+
     return 0;
 }
 
 void ikTpman_initParams(ikTpmanParams *params) {
+    /* keep no inputs */
+    params->diagnostics = NULL;
 }
 
 int ikTpman_step(ikTpman *self, double torque, double maxTorque, double minTorqueExt, double pitch, double maxPitchExt, double minPitchExt) {
+#ifndef OPENDISCON_NO_DIAGNOSTICS
     /* save inputs */
-    self->maxPitchExt = maxPitchExt;
-    self->minPitchExt = minPitchExt;
-    self->torque = torque;
-    self->pitch = pitch;
-    self->minTorqueExt = minTorqueExt;
-    self->maxTorque = maxTorque;
+    if (NULL != self->diag) {
+        self->diag->maxPitchExt = maxPitchExt;
+        self->diag->minPitchExt = minPitchExt;
+        self->diag->torque = torque;
+        self->diag->pitch = pitch;
+        self->diag->minTorqueExt = minTorqueExt;
+        self->diag->maxTorque = maxTorque;
+    }
+#endif
 
     /* transition between states if necessary */
     switch (self->state) {
         case 0:
-            if ((torque >= maxTorque) || (pitch > self->minPitchExt)) self->state = 1;
+            if ((torque >= maxTorque) || (pitch > minPitchExt)) self->state = 1;
             break;
         case 1:
-            if (pitch <= self->minPitchExt) self->state = 0;
+            if (pitch <= minPitchExt) self->state = 0;
             break;
     }
 
@@ -64,7 +75,7 @@ int ikTpman_step(ikTpman *self, double torque, double maxTorque, double minTorqu
         case 0:
             self->maxPitch = pitch;
             self->maxPitch = self->maxPitch < maxPitchExt ? self->maxPitch : maxPitchExt;
-            self->maxPitch = self->maxPitch > self->minPitchExt ? self->maxPitch : self->minPitchExt;
+            self->maxPitch = self->maxPitch > minPitchExt ? self->maxPitch : minPitchExt;
             self->minTorque = minTorqueExt;
             break;
         case 1:
@@ -90,30 +101,32 @@ int ikTpman_getOutput(const ikTpman *self, double *output, const char *name) {
         *output = self->minTorque;
         return 0;
     }
-    if (!strcmp(name, "external maximum pitch")) {
-        *output = self->maxPitchExt;
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+    if (NULL != self->diag && !strcmp(name, "external maximum pitch")) {
+        *output = self->diag->maxPitchExt;
         return 0;
     }
-    if (!strcmp(name, "external minimum pitch")) {
-        *output = self->minPitchExt;
+    if (NULL != self->diag && !strcmp(name, "external minimum pitch")) {
+        *output = self->diag->minPitchExt;
         return 0;
     }
-    if (!strcmp(name, "torque")) {
-        *output = self->torque;
+    if (NULL != self->diag && !strcmp(name, "torque")) {
+        *output = self->diag->torque;
         return 0;
     }
-    if (!strcmp(name, "pitch")) {
-        *output = self->pitch;
+    if (NULL != self->diag && !strcmp(name, "pitch")) {
+        *output = self->diag->pitch;
         return 0;
     }
-    if (!strcmp(name, "external minimum torque")) {
-        *output = self->minTorqueExt;
+    if (NULL != self->diag && !strcmp(name, "external minimum torque")) {
+        *output = self->diag->minTorqueExt;
         return 0;
     }
-    if (!strcmp(name, "maximum torque")) {
-        *output = self->maxTorque;
+    if (NULL != self->diag && !strcmp(name, "maximum torque")) {
+        *output = self->diag->maxTorque;
         return 0;
     }
+#endif
 
     /* pick up the block names */
     sep = strstr(name, ">");
@@ -30,7 +30,16 @@ along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
 extern "C" {
 #endif
     
-#include "ikLutbl.h"
+    /* @cond */
+    typedef struct ikTpmanDiagnostics {
+        double maxPitchExt;
+        double minPitchExt;
+        double torque;
+        double pitch;
+        double minTorqueExt;
+        double maxTorque;
+    } ikTpmanDiagnostics;
+    /* @endcond */
     
     /**
      * @struct ikTpman
@@ -76,13 +85,9 @@ extern "C" {
         int state;
         double minTorque;
         double maxPitch;
-        ikLutbl * minPitchTbl;
-        double maxPitchExt;
-        double minPitchExt;
-        double torque;
-        double pitch;
-        double minTorqueExt;
-        double maxTorque;
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+        ikTpmanDiagnostics *diag;
+#endif
         /* @endcond */
     } ikTpman;
     
@@ -91,9 +96,7 @@ extern "C" {
      * @brief Torque-pitch manager initialisation parameters
      */
     typedef struct ikTpmanParams {
-		/* @cond */
-		int foo;
-		/* @endcond */
+		ikTpmanDiagnostics *diagnostics; /**<where to keep the inputs for @link ikTpman_getOutput @endlink, typically in the cold part of the instance holding the manager, see @link ikLayout.h @endlink, or NULL not to keep them. The default value is NULL*/
     } ikTpmanParams;
     
     /**
@@ -128,7 +131,9 @@ extern "C" {
     
     /**
      * Get output value by name. All signals named on the block diagram of
-     * @link ikTpman @endlink are accessible.
+     * @link ikTpman @endlink are accessible. The inputs are only available
+     * when kept, see @link ikTpmanParams.diagnostics @endlink, and when built
+     * without OPENDISCON_NO_DIAGNOSTICS.
      * @param self torque-pitch manager instance
      * @param output output value
      * @param name output name
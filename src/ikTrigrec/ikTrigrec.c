@@ -0,0 +1,231 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikTrigrec.c
+ *
+ * @brief Class ikTrigrec implementation
+ */
+
+/* @cond */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ikTrigrec.h"
+
+int ikTrigrec_init(ikTrigrec *self, const ikTrigrecParams *params) {
+    int nPre;
+    int i;
+
+    memset(self, 0, sizeof(*self));
+
+    /* check the signals */
+    if (params->log.nSignals < 1 || params->log.nSignals > IKSIGLOG_MAXSIGNALS) return -1;
+    if (params->log.chunkSize < 1 || !(params->log.samplePeriod > 0.0)) return -1;
+    for (i = 0; i < params->log.nSignals; i++) {
+        if (NULL == params->log.names[i] || !params->log.names[i][0]) return -1;
+    }
+    if (NULL == params->filePrefix || strlen(params->filePrefix) + 10 >= IKSIGLOG_MAXNAME) return -1;
+    self->logParams = params->log;
+    strcpy(self->filePrefix, params->filePrefix);
+
+    /* register the window length */
+    if (params->preTriggerTime < 0.0 || params->postTriggerTime < 0.0) return -2;
+    nPre = (int) (params->preTriggerTime/params->log.samplePeriod + 0.5);
+    self->nPost = (int) (params->postTriggerTime/params->log.samplePeriod + 0.5);
+    self->capacity = nPre + 1 + self->nPost;
+
+    /* register the trigger conditions */
+    for (i = 0; i < IKTRIGREC_MAXTRIGGERS; i++) {
+        const ikTrigrecTriggerParams *trigger = &(params->triggers[i]);
+        if (!trigger->enable) continue;
+        if (trigger->signal < 0 || trigger->signal >= params->log.nSignals) return -3;
+        if (trigger->type < IKTRIGREC_CHANGE || trigger->type > IKTRIGREC_ABSRISING) return -3;
+        self->triggerSignal[self->nTriggers] = trigger->signal;
+        self->triggerType[self->nTriggers] = trigger->type;
+        self->triggerLevel[self->nTriggers] = trigger->level;
+        self->nTriggers++;
+    }
+
+    /* allocate the ring buffer, one row per sample */
+    self->ring = (double *) malloc(sizeof(double)*self->capacity*params->log.nSignals);
+    self->times = (double *) malloc(sizeof(double)*self->capacity);
+    self->previous = (double *) malloc(sizeof(double)*params->log.nSignals);
+    if (NULL == self->ring || NULL == self->times || NULL == self->previous) {
+        ikTrigrec_close(self);
+        return -4;
+    }
+
+    self->lastTrigger = -1;
+
+    return 0;
+}
+
+void ikTrigrec_initParams(ikTrigrecParams *params) {
+    int i;
+
+    ikSiglog_initParams(&(params->log));
+    params->filePrefix = "event";
+    params->preTriggerTime = 10.0;
+    params->postTriggerTime = 20.0;
+    for (i = 0; i < IKTRIGREC_MAXTRIGGERS; i++) {
+        params->triggers[i].enable = 0;
+        params->triggers[i].signal = 0;
+        params->triggers[i].type = IKTRIGREC_CHANGE;
+        params->triggers[i].level = 0.0;
+    }
+}
+
+static int isTriggered(const ikTrigrec *self, int i, const double *values) {
+    double now = values[self->triggerSignal[i]];
+    double before = self->previous[self->triggerSignal[i]];
+    double level = self->triggerLevel[i];
+
+    switch (self->triggerType[i]) {
+        case IKTRIGREC_CHANGE:
+            return now != before;
+        case IKTRIGREC_RISING:
+            return now >= level && before < level;
+        case IKTRIGREC_FALLING:
+            return now <= level && before > level;
+        case IKTRIGREC_ABSRISING:
+            return fabs(now) >= level && fabs(before) < level;
+    }
+    return 0;
+}
+
+static int writeWindow(ikTrigrec *self) {
+    ikSiglog log;
+    char fileName[IKSIGLOG_MAXNAME];
+    int first = (self->head - self->count + self->capacity) % self->capacity;
+    int err;
+    int i;
+
+    /* take the next number with no file, so that earlier runs are kept */
+    for (;;) {
+        FILE *f;
+        int len = snprintf(fileName, sizeof(fileName), "%s_%04d.bin", self->filePrefix, self->fileNumber);
+        if (len < 0 || len >= (int) sizeof(fileName)) return -1;
+        f = fopen(fileName, "rb");
+        if (NULL == f) break;
+        fclose(f);
+        self->fileNumber++;
+    }
+    self->fileNumber++;
+    self->logParams.fileName = fileName;
+    self->logParams.startTime = self->times[first];
+    err = ikSiglog_init(&log, &(self->logParams));
+    self->logParams.fileName = NULL;
+    if (err) return -1;
+
+    for (i = 0; i < self->count; i++) {
+        err = ikSiglog_write(&log, self->ring + (size_t) ((first + i) % self->capacity)*self->logParams.nSignals);
+        if (err) break;
+    }
+    if (ikSiglog_close(&log)) err = -1;
+
+    self->events++;
+    return err ? -1 : 0;
+}
+
+int ikTrigrec_step(ikTrigrec *self, double time, const double *values) {
+    int n = self->logParams.nSignals;
+    int err = 0;
+    int i;
+
+    /* push the sample into the ring */
+    memcpy(self->ring + (size_t) self->head*n, values, sizeof(double)*n);
+    self->times[self->head] = time;
+    self->head = (self->head + 1) % self->capacity;
+    if (self->count < self->capacity) self->count++;
+
+    /* check the trigger conditions */
+    if (self->started) {
+        for (i = 0; i < self->nTriggers; i++) {
+            if (!isTriggered(self, i, values)) continue;
+            if (self->state) {
+                self->suppressed++;
+            } else {
+                self->state = 1;
+                self->postCountdown = self->nPost;
+                self->lastTrigger = i;
+            }
+        }
+    }
+    memcpy(self->previous, values, sizeof(double)*n);
+    self->started = 1;
+
+    /* write the window once the post-trigger time is over */
+    if (self->state) {
+        if (self->postCountdown) {
+            self->postCountdown--;
+        } else {
+            err = writeWindow(self);
+            self->state = 0;
+        }
+    }
+
+    return err ? -1 : self->state;
+}
+
+int ikTrigrec_getOutput(const ikTrigrec *self, double *output, const char *name) {
+    /* pick up the signal names */
+    if (!strcmp(name, "state")) {
+        *output = self->state;
+        return 0;
+    }
+    if (!strcmp(name, "events")) {
+        *output = self->events;
+        return 0;
+    }
+    if (!strcmp(name, "suppressed triggers")) {
+        *output = self->suppressed;
+        return 0;
+    }
+    if (!strcmp(name, "last trigger")) {
+        *output = self->lastTrigger;
+        return 0;
+    }
+
+    return -1;
+}
+
+int ikTrigrec_close(ikTrigrec *self) {
+    int err = 0;
+
+    if (self->state && NULL != self->ring) {
+        /* write the window cut short at the last sample */
+        err = writeWindow(self);
+        self->state = 0;
+    }
+
+    free(self->ring);
+    free(self->times);
+    free(self->previous);
+    self->ring = NULL;
+    self->times = NULL;
+    self->previous = NULL;
+
+    return err;
+}
+
+/* @endcond */
@@ -0,0 +1,180 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikTrigrec.h
+ *
+ * @brief Class ikTrigrec interface
+ */
+
+#ifndef IKTRIGREC_H
+#define IKTRIGREC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ikSiglog.h"
+
+#define IKTRIGREC_MAXTRIGGERS 8 /**<maximum number of trigger conditions*/
+
+#define IKTRIGREC_CHANGE 0 /**<trigger when the signal value changes*/
+#define IKTRIGREC_RISING 1 /**<trigger when the signal rises to or above the trigger level*/
+#define IKTRIGREC_FALLING 2 /**<trigger when the signal falls to or below the trigger level*/
+#define IKTRIGREC_ABSRISING 3 /**<trigger when the absolute value of the signal rises to or above the trigger level*/
+
+    /**
+     * @struct ikTrigrec
+     * @brief Event-triggered signal recorder
+     *
+     * The recorder keeps the last samples of a set of signals in a ring
+     * buffer. When one of its trigger conditions is met, it goes on
+     * recording for the post-trigger time and then writes the window, from
+     * the pre-trigger time before the trigger to the post-trigger time
+     * after it, to a new @link ikSiglog @endlink file, numbered on from the
+     * files already there. Triggers met while a window is being recorded are
+     * counted but do not start a new window.
+     *
+     * Between events, the cost of a step is a copy of the signal values into
+     * the ring buffer and a comparison per trigger condition, and there is no
+     * file I/O at all.
+     *
+     * @par Inputs
+     * @li time: in s, specify via @link ikTrigrec_step @endlink
+     * @li signal values: specify via @link ikTrigrec_step @endlink
+     *
+     * @par Outputs
+     * @li state: 0 waiting for a trigger, 1 recording a post-trigger window, get via @link ikTrigrec_step @endlink or @link ikTrigrec_getOutput @endlink
+     * @li events: number of windows written, get via @link ikTrigrec_getOutput @endlink
+     * @li suppressed triggers: number of triggers met while recording a window, get via @link ikTrigrec_getOutput @endlink
+     * @li last trigger: index of the trigger condition that started the last window, get via @link ikTrigrec_getOutput @endlink
+     *
+     * @par Methods
+     * @li @link ikTrigrec_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikTrigrec_init @endlink initialise an instance
+     * @li @link ikTrigrec_step @endlink execute periodic calculations
+     * @li @link ikTrigrec_getOutput @endlink get output value
+     * @li @link ikTrigrec_close @endlink write any pending window and release the ring buffer
+     */
+    typedef struct ikTrigrec {
+        /* @cond */
+        ikSiglogParams logParams;
+        char filePrefix[IKSIGLOG_MAXNAME];
+        int nTriggers;
+        int triggerSignal[IKTRIGREC_MAXTRIGGERS];
+        int triggerType[IKTRIGREC_MAXTRIGGERS];
+        double triggerLevel[IKTRIGREC_MAXTRIGGERS];
+        double *ring;
+        double *times;
+        double *previous;
+        int capacity;
+        int nPost;
+        int head;
+        int count;
+        int postCountdown;
+        int state;
+        int started;
+        int events;
+        int fileNumber;
+        int suppressed;
+        int lastTrigger;
+        /* @endcond */
+    } ikTrigrec;
+
+    /**
+     * @struct ikTrigrecTriggerParams
+     * @brief Trigger condition
+     */
+    typedef struct ikTrigrecTriggerParams {
+        int enable; /**<0 disabled, 1 enabled. The default value is 0*/
+        int signal; /**<index of the watched signal. The default value is 0*/
+        int type; /**<condition type: @link IKTRIGREC_CHANGE @endlink, @link IKTRIGREC_RISING @endlink, @link IKTRIGREC_FALLING @endlink or @link IKTRIGREC_ABSRISING @endlink. The default value is @link IKTRIGREC_CHANGE @endlink*/
+        double level; /**<trigger level, in the units of the watched signal. The default value is 0.0*/
+    } ikTrigrecTriggerParams;
+
+    /**
+     * @struct ikTrigrecParams
+     * @brief Event-triggered signal recorder initialisation parameters
+     */
+    typedef struct ikTrigrecParams {
+        ikSiglogParams log; /**<number, names and units of the recorded signals, sample period and chunk size of the written windows. The file name and start time are ignored, and the name and unit strings must remain valid while the recorder is in use*/
+        const char *filePrefix; /**<windows are written to files named after this prefix followed by "_" and a number of at least 4 digits and ".bin", the lowest not taken by an existing file, so that the windows of earlier runs are not overwritten. The default value is "event"*/
+        double preTriggerTime; /**<recorded time before a trigger, in s. The default value is 10.0*/
+        double postTriggerTime; /**<recorded time after a trigger, in s. The default value is 20.0*/
+        ikTrigrecTriggerParams triggers[IKTRIGREC_MAXTRIGGERS]; /**<trigger conditions*/
+    } ikTrigrecParams;
+
+    /**
+     * Initialise an instance
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signals, see @link ikSiglog_init @endlink
+     * @li -2: invalid pre-trigger or post-trigger time, they must not be negative
+     * @li -3: invalid trigger condition
+     * @li -4: unable to allocate memory
+     */
+    int ikTrigrec_init(ikTrigrec *self, const ikTrigrecParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikTrigrec_initParams(ikTrigrecParams *params);
+
+    /**
+     * Execute periodic calculations
+     * @param self recorder instance
+     * @param time current time, in s
+     * @param values signal values, in the order given at initialisation
+     * @return state:
+     * @li 0: waiting for a trigger
+     * @li 1: recording a post-trigger window
+     * @li -1: a window could not be written
+     */
+    int ikTrigrec_step(ikTrigrec *self, double time, const double *values);
+
+    /**
+     * Get output value by name. Available signals are "state", "events",
+     * "suppressed triggers" and "last trigger".
+     * @param self recorder instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     */
+    int ikTrigrec_getOutput(const ikTrigrec *self, double *output, const char *name);
+
+    /**
+     * Write the window being recorded, if any, cut short at the current time,
+     * and release the ring buffer
+     * @param self recorder instance
+     * @return error code:
+     * @li 0: no error
+     * @li -1: the window could not be written
+     */
+    int ikTrigrec_close(ikTrigrec *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKTRIGREC_H */
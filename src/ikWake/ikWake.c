@@ -0,0 +1,261 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikWake.c
+ *
+ * @brief Class ikWake implementation
+ */
+
+/* @cond */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ikWake.h"
+
+#define PI 3.14159265358979
+#define GAUSSIAN_INITIAL_WIDTH 0.25 /* rotor diameters, for a thrust coefficient of about 0.8 */
+
+typedef struct station {
+    double x;
+    int index;
+} station;
+
+static int compareStations(const void *a, const void *b) {
+    const station *p = (const station *) a;
+    const station *q = (const station *) b;
+
+    if (p->x < q->x) return -1;
+    if (p->x > q->x) return 1;
+    return p->index - q->index;
+}
+
+/* area of a circle of radius r inside one of radius R, no smaller, at distance d */
+static double overlap(double r, double R, double d) {
+    double a, b, c;
+
+    if (d >= r + R) return 0.0;
+    if (d <= R - r) return PI*r*r;
+    a = (d*d + r*r - R*R)/(2.0*d*r);
+    b = (d*d + R*R - r*r)/(2.0*d*R);
+    c = (-d + r + R)*(d + r - R)*(d - r + R)*(d + r + R);
+    return r*r*acos(a) + R*R*acos(b) - 0.5*sqrt(c > 0.0 ? c : 0.0);
+}
+
+/* gain and scale of the deficit caused at dx downwind and dy across, and
+   whether it is worth keeping */
+static int pairFactors(const ikWakeParams *params, double dx, double dy, double *gain, double *scale) {
+    const double D = params->rotorDiameter;
+    const double k = params->wakeExpansion;
+    double saturation;
+
+    if (dx <= 0.0 || dx > params->maximumDistance*D) return 0;
+    if (IKWAKE_JENSEN == params->model) {
+        const double ratio = D/(D + 2.0*k*dx);
+        *gain = ratio*ratio*overlap(0.5*D, 0.5*D + k*dx, fabs(dy))/(0.25*PI*D*D);
+        *scale = 1.0;
+    } else {
+        const double width = k*dx/D + GAUSSIAN_INITIAL_WIDTH;
+        *gain = exp(-dy*dy/(2.0*width*width*D*D));
+        *scale = 1.0/(8.0*width*width);
+    }
+    saturation = 1.0 - *scale;
+    return *gain*(1.0 - sqrt(saturation > 0.0 ? saturation : 0.0)) >= params->threshold;
+}
+
+/* go over the upwind neighbours of every turbine, counting the pairs kept,
+   and storing them too if there is room */
+static long findPairs(ikWake *self, const ikWakeParams *params, const station *stations) {
+    const int n = params->nTurbines;
+    const double reach = params->maximumDistance*params->rotorDiameter;
+    long nPairs = 0;
+    int i, j;
+
+    for (i = 0; i < n; i++) {
+        const double xi = params->x[i];
+        int low = 0, high = n;
+
+        /* the first turbine within reach upwind */
+        while (low < high) {
+            const int middle = low + (high - low)/2;
+            if (stations[middle].x < xi - reach) low = middle + 1;
+            else high = middle;
+        }
+        if (NULL != self->start) self->start[i] = nPairs;
+        for (j = low; j < n && stations[j].x < xi; j++) {
+            const int source = stations[j].index;
+            double gain, scale;
+            if (!pairFactors(params, xi - stations[j].x, params->y[i] - params->y[source], &gain, &scale)) continue;
+            if (NULL != self->source) {
+                self->source[nPairs] = source;
+                self->gain[nPairs] = gain;
+                self->scale[nPairs] = scale;
+            }
+            nPairs++;
+        }
+    }
+    if (NULL != self->start) self->start[n] = nPairs;
+    return nPairs;
+}
+
+int ikWake_init(ikWake *self, const ikWakeParams *params) {
+    station *stations;
+    long nPairs;
+    int i;
+
+    self->nTurbines = 0;
+    self->nPairs = 0;
+    self->start = NULL;
+    self->source = NULL;
+    self->gain = NULL;
+    self->scale = NULL;
+    self->deficit = NULL;
+    self->thrust = NULL;
+    self->squares = NULL;
+
+    /* check the parameters */
+    if (params->nTurbines < 1 || params->nTurbines > IKWAKE_MAXTURBINES || NULL == params->x || NULL == params->y) return -1;
+    for (i = 0; i < params->nTurbines; i++) {
+        if (!(fabs(params->x[i]) < 1.0e12) || !(fabs(params->y[i]) < 1.0e12)) return -1;
+    }
+    if ((IKWAKE_JENSEN != params->model && IKWAKE_GAUSSIAN != params->model) || !(params->rotorDiameter > 0.0)
+            || !(params->wakeExpansion >= 0.0) || !(params->maximumDistance > 0.0) || !(params->threshold >= 0.0)) return -2;
+
+    /* sort the turbines down the wind, and count the pairs */
+    stations = (station *) malloc(params->nTurbines*sizeof(station));
+    if (NULL == stations) return -3;
+    for (i = 0; i < params->nTurbines; i++) {
+        stations[i].x = params->x[i];
+        stations[i].index = i;
+    }
+    qsort(stations, params->nTurbines, sizeof(station), compareStations);
+    nPairs = findPairs(self, params, stations);
+
+    /* then store them, grouped by the turbine downwind */
+    self->nTurbines = params->nTurbines;
+    self->start = (long *) malloc((self->nTurbines + 1)*sizeof(long));
+    self->source = (int *) malloc((nPairs > 0 ? nPairs : 1)*sizeof(int));
+    self->gain = (double *) malloc((nPairs > 0 ? nPairs : 1)*sizeof(double));
+    self->scale = (double *) malloc((nPairs > 0 ? nPairs : 1)*sizeof(double));
+    self->deficit = (double *) malloc(self->nTurbines*sizeof(double));
+    self->thrust = (double *) malloc(self->nTurbines*sizeof(double));
+    self->squares = (double *) malloc((nPairs > 0 ? nPairs : 1)*sizeof(double));
+    if (NULL == self->start || NULL == self->source || NULL == self->gain || NULL == self->scale
+            || NULL == self->deficit || NULL == self->thrust || NULL == self->squares) {
+        free(stations);
+        ikWake_close(self);
+        return -3;
+    }
+    self->nPairs = findPairs(self, params, stations);
+    free(stations);
+
+    for (i = 0; i < self->nTurbines; i++) self->deficit[i] = 0.0;
+    return 0;
+}
+
+void ikWake_initParams(ikWakeParams *params) {
+    params->nTurbines = 0;
+    params->x = NULL;
+    params->y = NULL;
+    params->model = IKWAKE_GAUSSIAN;
+    params->rotorDiameter = 178.3;
+    params->wakeExpansion = 0.04;
+    params->maximumDistance = 30.0;
+    params->threshold = 0.001;
+}
+
+void ikWake_step(ikWake *self, const double *thrustCoefficient, double *deficit) {
+    const int *source = self->source;
+    const double *gain = self->gain;
+    const double *scale = self->scale;
+    const double *thrust = self->thrust;
+    double *squares = self->squares;
+    const long nPairs = self->nPairs;
+    long p;
+    int i;
+
+    for (i = 0; i < self->nTurbines; i++) {
+        const double c = thrustCoefficient[i];
+        self->thrust[i] = c < 0.0 ? 0.0 : (c > 1.0 ? 1.0 : c);
+    }
+
+    /* gather the thrust coefficient of the turbine upwind of every pair,
+       then work out the squared deficits in a flat pass with no branches,
+       clamping at 0 as (r + |r|)/2 */
+    for (p = 0; p < nPairs; p++) squares[p] = thrust[source[p]];
+    for (p = 0; p < nPairs; p++) {
+        const double remaining = 1.0 - scale[p]*squares[p];
+        const double d = gain[p]*(1.0 - sqrt(0.5*(remaining + fabs(remaining))));
+        squares[p] = d*d;
+    }
+
+    /* root sum of squares of the deficits caused by the turbines upwind */
+    for (i = 0; i < self->nTurbines; i++) {
+        const long end = self->start[i + 1];
+        double sum = 0.0;
+        for (p = self->start[i]; p < end; p++) sum += squares[p];
+        sum = sqrt(sum);
+        self->deficit[i] = sum < 1.0 ? sum : 1.0;
+    }
+
+    if (NULL != deficit) memcpy(deficit, self->deficit, self->nTurbines*sizeof(double));
+}
+
+int ikWake_getOutput(const ikWake *self, double *output, const char *name) {
+    char *end;
+    long i;
+
+    /* pick up the signal names */
+    if (!strcmp(name, "pairs")) {
+        *output = (double) self->nPairs;
+        return 0;
+    }
+    if (!strncmp(name, "deficit ", 8)) {
+        i = strtol(name + 8, &end, 10);
+        if (end != name + 8 && '\0' == *end && i >= 1 && i <= self->nTurbines) {
+            *output = self->deficit[i - 1];
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+void ikWake_close(ikWake *self) {
+    free(self->start);
+    free(self->source);
+    free(self->gain);
+    free(self->scale);
+    free(self->deficit);
+    free(self->thrust);
+    free(self->squares);
+    self->start = NULL;
+    self->source = NULL;
+    self->gain = NULL;
+    self->scale = NULL;
+    self->deficit = NULL;
+    self->thrust = NULL;
+    self->squares = NULL;
+    self->nTurbines = 0;
+    self->nPairs = 0;
+}
+
+/* @endcond */
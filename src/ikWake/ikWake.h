@@ -0,0 +1,159 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikWake.h
+ *
+ * @brief Class ikWake interface
+ */
+
+#ifndef IKWAKE_H
+#define IKWAKE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IKWAKE_JENSEN 0 /**<top-hat wake of Jensen, with the rotor overlap of Katic*/
+#define IKWAKE_GAUSSIAN 1 /**<Gaussian wake of Bastankhah and Porte-Agel*/
+#define IKWAKE_MAXTURBINES 100000 /**<maximum number of turbines*/
+
+    /**
+     * @struct ikWake
+     * @brief Engineering wind farm wake model
+     *
+     * The model gives the wind speed deficit at each turbine of a farm, as a
+     * fraction of the free stream wind speed, from the thrust coefficients
+     * of the turbines upwind of it. It is quasi-steady: the deficits follow
+     * the thrust coefficients at once, with no advection delay.
+     *
+     * The turbines stand on a horizontal plane, with x down the wind and y
+     * across it, all with the same rotor diameter D. The deficit caused by
+     * turbine j at turbine i, at dx downwind and dy across, is
+     * @li Jensen: (1 - sqrt(1 - Ct_j))*(D/(D + 2*k*dx))^2*A/(pi*D^2/4), with A the area of the rotor of i inside the wake of j, of diameter D + 2*k*dx
+     * @li Gaussian: (1 - sqrt(1 - Ct_j/(8*(s/D)^2)))*exp(-dy^2/(2*s^2)), with wake width s = k*dx + 0.25*D, evaluated at the hub of i
+     *
+     * with k the wake expansion, and the deficits caused by all the turbines
+     * upwind are combined as the root of the sum of their squares.
+     *
+     * Both models take the form g*(1 - sqrt(1 - c*Ct_j)), with a gain g and
+     * a scale c which only depend on where the turbines stand. These are
+     * worked out at initialisation for every pair of turbines which interact
+     * at all, and kept in arrays grouped by the turbine downwind; pairs
+     * further apart down the wind than a maximum distance, or whose deficit
+     * would stay below a threshold even at a thrust coefficient of 1, are
+     * pruned. Pairs are found by sorting the turbines down the wind, so that
+     * initialisation does not compare every turbine with every other. A step
+     * is then one flat pass over the pairs, with no branches, no reductions
+     * and no transcendental functions but a square root, which the compiler
+     * vectorises when square roots need not set errno, followed by the sums
+     * of the squared deficits of each turbine.
+     *
+     * @par Inputs
+     * @li thrust coefficients: non-dimensional, specify via @link ikWake_step @endlink
+     *
+     * @par Outputs
+     * @li deficits: wind speed deficit at each turbine, over the free stream wind speed, non-dimensional, get via @link ikWake_step @endlink or @link ikWake_getOutput @endlink as "deficit <i>", with i from 1 to the number of turbines
+     * @li pairs: number of pairs of interacting turbines kept, get via @link ikWake_getOutput @endlink
+     *
+     * @par Methods
+     * @li @link ikWake_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikWake_init @endlink initialise an instance
+     * @li @link ikWake_step @endlink execute periodic calculations
+     * @li @link ikWake_getOutput @endlink get output value
+     * @li @link ikWake_close @endlink release memory
+     */
+    typedef struct ikWake {
+        /* @cond */
+        int nTurbines;
+        long nPairs;
+        long *start;
+        int *source;
+        double *gain;
+        double *scale;
+        double *deficit;
+        double *thrust;
+        double *squares;
+        /* @endcond */
+    } ikWake;
+
+    /**
+     * @struct ikWakeParams
+     * @brief Engineering wind farm wake model initialisation parameters
+     */
+    typedef struct ikWakeParams {
+        int nTurbines; /**<number of turbines, between 1 and @link IKWAKE_MAXTURBINES @endlink. The default value is 0*/
+        const double *x; /**<downwind position of each turbine, in m. The default value is NULL*/
+        const double *y; /**<crosswind position of each turbine, in m. The default value is NULL*/
+        int model; /**<wake model: @link IKWAKE_JENSEN @endlink or @link IKWAKE_GAUSSIAN @endlink. The default value is @link IKWAKE_GAUSSIAN @endlink*/
+        double rotorDiameter; /**<rotor diameter, in m. The default value is 178.3*/
+        double wakeExpansion; /**<wake expansion, the growth of the wake radius, for Jensen, or width, for Gaussian, per unit distance downwind, non-dimensional. The default value is 0.04*/
+        double maximumDistance; /**<downwind distance beyond which wakes are neglected, in rotor diameters. The default value is 30.0*/
+        double threshold; /**<deficit, at a thrust coefficient of 1, below which a wake is neglected, non-dimensional. The default value is 0.001*/
+    } ikWakeParams;
+
+    /**
+     * Initialise an instance, with no deficits
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid number of turbines or positions
+     * @li -2: invalid model, rotor diameter, wake expansion, maximum distance or threshold
+     * @li -3: unable to allocate memory
+     */
+    int ikWake_init(ikWake *self, const ikWakeParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikWake_initParams(ikWakeParams *params);
+
+    /**
+     * Execute periodic calculations
+     * @param self wake instance
+     * @param thrustCoefficient thrust coefficient of each turbine, non-dimensional, limited to between 0 and 1
+     * @param deficit wind speed deficit at each turbine, over the free stream wind speed, non-dimensional, between 0 and 1, or NULL
+     */
+    void ikWake_step(ikWake *self, const double *thrustCoefficient, double *deficit);
+
+    /**
+     * Get output value by name. Available signals are "pairs" and
+     * "deficit <i>", of the last step.
+     * @param self wake instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     */
+    int ikWake_getOutput(const ikWake *self, double *output, const char *name);
+
+    /**
+     * Release memory
+     * @param self wake instance
+     */
+    void ikWake_close(ikWake *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKWAKE_H */
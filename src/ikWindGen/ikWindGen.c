@@ -0,0 +1,347 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikWindGen.c
+ *
+ * @brief Class ikWindGen implementation
+ */
+
+/* @cond */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ikWindGen.h"
+
+#define PI 3.14159265358979
+
+/* portable random numbers: xorshift64*, seeded through splitmix64 */
+
+static uint64_t seedRandom(uint64_t seed) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return z ? z : 0x9E3779B97F4A7C15ULL;
+}
+
+static double uniform(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return (double) ((x*0x2545F4914F6CDD1DULL) >> 11)*(1.0/9007199254740992.0);
+}
+
+static double spectralDensity(int spectrum, double f, double meanSpeed, double lengthScale) {
+    double x = f*lengthScale/meanSpeed;
+    if (IKWINDGEN_VONKARMAN == spectrum) return 4.0*lengthScale/meanSpeed/pow(1.0 + 70.8*x*x, 5.0/6.0);
+    return 4.0*lengthScale/meanSpeed/pow(1.0 + 6.0*x, 5.0/3.0);
+}
+
+static int allocate(ikWindGen *self) {
+    size_t n = (size_t) self->blockSize;
+    size_t l = (size_t) (self->overlap > 0 ? self->overlap : 1);
+
+    self->re = (double *) malloc(sizeof(double)*n);
+    self->im = (double *) malloc(sizeof(double)*n);
+    if (self->playback) return NULL == self->re || NULL == self->im;
+
+    self->amplitude = (double *) malloc(sizeof(double)*n/2);
+    self->phase = (double *) malloc(sizeof(double)*n);
+    self->cosTable = (double *) malloc(sizeof(double)*n/2);
+    self->sinTable = (double *) malloc(sizeof(double)*n/2);
+    self->bitReversal = (int *) malloc(sizeof(int)*n);
+    self->tail = (double *) malloc(sizeof(double)*l);
+    self->fadeOut = (double *) malloc(sizeof(double)*l);
+    self->fadeIn = (double *) malloc(sizeof(double)*l);
+    return NULL == self->re || NULL == self->im || NULL == self->amplitude || NULL == self->phase
+            || NULL == self->cosTable || NULL == self->sinTable || NULL == self->bitReversal
+            || NULL == self->tail || NULL == self->fadeOut || NULL == self->fadeIn;
+}
+
+/* synthesise the next two blocks, in re and im */
+
+static void synthesise(ikWindGen *self) {
+    int n = self->blockSize;
+    int h = n/2;
+    int len, i, j, k;
+
+    /* independent random phases for every bin */
+    for (k = 0; k < n; k++) self->phase[k] = 2.0*PI*uniform(&(self->random));
+
+    /* spectrum, in bit-reversed order, with no mean and no Nyquist component */
+    self->re[0] = 0.0;
+    self->im[0] = 0.0;
+    self->re[self->bitReversal[h]] = 0.0;
+    self->im[self->bitReversal[h]] = 0.0;
+    for (k = 1; k < h; k++) {
+        int b = self->bitReversal[k];
+        self->re[b] = self->amplitude[k]*cos(self->phase[k]);
+        self->im[b] = self->amplitude[k]*sin(self->phase[k]);
+    }
+    for (k = 1; k < h; k++) {
+        int b = self->bitReversal[n - k];
+        self->re[b] = self->amplitude[k]*cos(self->phase[n - k]);
+        self->im[b] = self->amplitude[k]*sin(self->phase[n - k]);
+    }
+
+    /* radix-2 decimation in time inverse FFT, unscaled */
+    for (len = 2; len <= n; len <<= 1) {
+        int half = len >> 1;
+        int stride = n/len;
+        for (i = 0; i < n; i += len) {
+            double *ar = self->re + i;
+            double *ai = self->im + i;
+            double *br = ar + half;
+            double *bi = ai + half;
+            for (j = 0; j < half; j++) {
+                double wr = self->cosTable[j*stride];
+                double wi = self->sinTable[j*stride];
+                double tr = br[j]*wr - bi[j]*wi;
+                double ti = br[j]*wi + bi[j]*wr;
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+static void readFile(ikWindGen *self) {
+    long done = 0;
+    while (done < self->blockSize) {
+        long count = self->nSamples - self->filePosition;
+        if (count > self->blockSize - done) count = self->blockSize - done;
+        ikSiglogReader_readColumn(&(self->reader), self->signal, self->re + done, self->filePosition, count);
+        done += count;
+        self->filePosition += count;
+        if (self->filePosition >= self->nSamples) self->filePosition = 0;
+    }
+}
+
+int ikWindGen_init(ikWindGen *self, const ikWindGenParams *params) {
+    int n;
+    int bits;
+    int k;
+
+    memset(self, 0, sizeof(*self));
+
+    /* register the block settings */
+    if (!(params->samplePeriod > 0.0)) return -2;
+    if (params->blockSize < 16 || params->blockSize > (1 << 22) || (params->blockSize & (params->blockSize - 1))) return -2;
+    self->samplePeriod = params->samplePeriod;
+    self->blockSize = params->blockSize;
+    self->time = params->startTime - params->samplePeriod;
+
+    if (NULL != params->fileName) {
+        /* open the file to play back */
+        self->playback = 1;
+        if (ikSiglogReader_open(&(self->reader), params->fileName)) return -3;
+        self->signal = ikSiglogReader_findSignal(&(self->reader), NULL != params->signalName ? params->signalName : "");
+        self->nSamples = self->reader.nSamples;
+        if (self->signal < 0 || self->nSamples < 1 || fabs(self->reader.samplePeriod - params->samplePeriod) > 1.0e-9*params->samplePeriod) {
+            ikWindGen_close(self);
+            return -3;
+        }
+        if (self->blockSize > self->nSamples) self->blockSize = (int) self->nSamples;
+        self->segmentLength = self->blockSize;
+        if (allocate(self)) {
+            ikWindGen_close(self);
+            return -4;
+        }
+        readFile(self);
+        self->block = self->re;
+        return 0;
+    }
+
+    /* register the spectrum */
+    if (params->spectrum < IKWINDGEN_KAIMAL || params->spectrum > IKWINDGEN_VONKARMAN) return -1;
+    if (!(params->meanSpeed > 0.0) || params->turbulenceIntensity < 0.0 || !(params->lengthScale > 0.0)) return -1;
+    if (params->overlap < 0 || params->overlap > params->blockSize/2) return -2;
+    self->meanSpeed = params->meanSpeed;
+    self->overlap = params->overlap;
+    self->segmentLength = self->blockSize - self->overlap;
+    if (allocate(self)) {
+        ikWindGen_close(self);
+        return -4;
+    }
+    n = self->blockSize;
+
+    /* tabulate the spectral amplitudes, scaled to the target variance */
+    {
+        double df = 1.0/(n*params->samplePeriod);
+        double sigma = params->turbulenceIntensity*params->meanSpeed;
+        double variance = 0.0;
+        double scale;
+        self->amplitude[0] = 0.0;
+        for (k = 1; k < n/2; k++) {
+            self->amplitude[k] = sqrt(spectralDensity(params->spectrum, k*df, params->meanSpeed, params->lengthScale)*df);
+            variance += self->amplitude[k]*self->amplitude[k];
+        }
+        scale = variance > 0.0 ? sigma/sqrt(variance) : 0.0;
+        for (k = 1; k < n/2; k++) self->amplitude[k] *= scale;
+    }
+
+    /* tabulate the twiddle factors and bit reversal */
+    for (k = 0; k < n/2; k++) {
+        self->cosTable[k] = cos(2.0*PI*k/n);
+        self->sinTable[k] = sin(2.0*PI*k/n);
+    }
+    for (bits = 0; (1 << bits) < n; bits++);
+    for (k = 0; k < n; k++) {
+        int r = 0;
+        int b;
+        for (b = 0; b < bits; b++) r |= ((k >> b) & 1) << (bits - 1 - b);
+        self->bitReversal[k] = r;
+    }
+
+    /* tabulate the crossfade windows, with constant total power */
+    for (k = 0; k < self->overlap; k++) {
+        double angle = 0.5*PI*(k + 0.5)/self->overlap;
+        self->fadeOut[k] = cos(angle);
+        self->fadeIn[k] = sin(angle);
+    }
+
+    /* start with the imaginary block, fading in from the real one */
+    self->random = seedRandom(params->seed);
+    synthesise(self);
+    if (self->overlap) memcpy(self->tail, self->re + self->segmentLength, sizeof(double)*self->overlap);
+    self->block = self->im;
+
+    return 0;
+}
+
+void ikWindGen_initParams(ikWindGenParams *params) {
+    params->fileName = NULL;
+    params->signalName = "wind speed";
+    params->spectrum = IKWINDGEN_KAIMAL;
+    params->meanSpeed = 11.4;
+    params->turbulenceIntensity = 0.16;
+    params->lengthScale = 340.2;
+    params->samplePeriod = 0.01;
+    params->blockSize = 65536;
+    params->overlap = 1024;
+    params->seed = 1;
+    params->startTime = 0.0;
+}
+
+/* move on to the next block */
+
+static void nextBlock(ikWindGen *self) {
+    self->position = 0;
+
+    if (self->playback) {
+        readFile(self);
+        return;
+    }
+
+    if (self->overlap) memcpy(self->tail, self->block + self->segmentLength, sizeof(double)*self->overlap);
+    if (self->block == self->re) {
+        self->block = self->im;
+    } else {
+        synthesise(self);
+        self->block = self->re;
+    }
+}
+
+double ikWindGen_step(ikWindGen *self) {
+    int p;
+
+    if (self->position >= self->segmentLength) nextBlock(self);
+    p = self->position++;
+
+    if (self->playback) {
+        self->windSpeed = self->block[p];
+    } else if (p < self->overlap) {
+        self->windSpeed = self->meanSpeed + self->fadeOut[p]*self->tail[p] + self->fadeIn[p]*self->block[p];
+    } else {
+        self->windSpeed = self->meanSpeed + self->block[p];
+    }
+    self->time += self->samplePeriod;
+
+    return self->windSpeed;
+}
+
+void ikWindGen_read(ikWindGen *self, double *output, long n) {
+    long done = 0;
+
+    while (done < n) {
+        long count;
+        long i;
+        int p;
+
+        if (self->position >= self->segmentLength) nextBlock(self);
+        p = self->position;
+        count = self->segmentLength - p;
+        if (count > n - done) count = n - done;
+
+        if (self->playback) {
+            memcpy(output + done, self->block + p, sizeof(double)*count);
+        } else {
+            for (i = 0; i < count && p + i < self->overlap; i++) {
+                output[done + i] = self->meanSpeed + self->fadeOut[p + i]*self->tail[p + i] + self->fadeIn[p + i]*self->block[p + i];
+            }
+            for (; i < count; i++) output[done + i] = self->meanSpeed + self->block[p + i];
+        }
+
+        self->position += (int) count;
+        done += count;
+    }
+
+    if (n > 0) {
+        self->windSpeed = output[n - 1];
+        self->time += n*self->samplePeriod;
+    }
+}
+
+int ikWindGen_getOutput(const ikWindGen *self, double *output, const char *name) {
+    /* pick up the signal names */
+    if (!strcmp(name, "wind speed")) {
+        *output = self->windSpeed;
+        return 0;
+    }
+    if (!strcmp(name, "time")) {
+        *output = self->time;
+        return 0;
+    }
+
+    return -1;
+}
+
+void ikWindGen_close(ikWindGen *self) {
+    if (self->playback) ikSiglogReader_close(&(self->reader));
+    free(self->amplitude);
+    free(self->phase);
+    free(self->cosTable);
+    free(self->sinTable);
+    free(self->bitReversal);
+    free(self->re);
+    free(self->im);
+    free(self->tail);
+    free(self->fadeOut);
+    free(self->fadeIn);
+    memset(self, 0, sizeof(*self));
+}
+
+/* @endcond */
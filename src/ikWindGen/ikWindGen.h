@@ -0,0 +1,187 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikWindGen.h
+ *
+ * @brief Class ikWindGen interface
+ */
+
+#ifndef IKWINDGEN_H
+#define IKWINDGEN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "ikSiglog.h"
+
+#define IKWINDGEN_KAIMAL 0 /**<Kaimal spectrum, as in IEC 61400-1*/
+#define IKWINDGEN_VONKARMAN 1 /**<von Karman spectrum*/
+
+    /**
+     * @struct ikWindGen
+     * @brief Streaming turbulent wind speed generator
+     *
+     * The generator produces a hub height longitudinal wind speed time series
+     * of unlimited length, sample by sample, with constant memory.
+     *
+     * The series is synthesised in blocks of a fixed number of samples by the
+     * spectral method: each block is the inverse FFT of a spectrum with the
+     * amplitudes of the Kaimal or von Karman spectrum and random phases. One
+     * complex inverse FFT yields two independent blocks, its real and
+     * imaginary parts. Consecutive blocks are joined by a cosine/sine
+     * crossfade over a number of samples, which keeps the variance constant
+     * across the joint. The spectral amplitudes, the FFT twiddle factors and
+     * the crossfade windows are tabulated at initialisation, so a block costs
+     * one random phase per frequency and one FFT.
+     *
+     * The amplitudes are scaled so that the standard deviation is exactly the
+     * turbulence intensity times the mean wind speed. Frequencies below the
+     * inverse of the block duration are not represented, so the block
+     * duration should be several times the length scale over the mean wind
+     * speed.
+     *
+     * The same seed and parameters always give the same series, on any
+     * platform.
+     *
+     * Alternatively, the generator plays back a pre-generated series from an
+     * @link ikSiglog @endlink file, which is memory-mapped and decoded one
+     * block at a time. When the end of the file is reached, play back starts
+     * again from its beginning.
+     *
+     * @par Outputs
+     * @li wind speed: in m/s, get via @link ikWindGen_step @endlink, @link ikWindGen_read @endlink or @link ikWindGen_getOutput @endlink
+     * @li time: time of the last sample, in s, get via @link ikWindGen_getOutput @endlink
+     *
+     * @par Methods
+     * @li @link ikWindGen_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikWindGen_init @endlink initialise an instance
+     * @li @link ikWindGen_step @endlink get the next sample
+     * @li @link ikWindGen_read @endlink get a number of samples at once
+     * @li @link ikWindGen_getOutput @endlink get output value
+     * @li @link ikWindGen_close @endlink release memory and files
+     */
+    typedef struct ikWindGen {
+        /* @cond */
+        int playback;
+        int blockSize;
+        int overlap;
+        double samplePeriod;
+        double meanSpeed;
+        double *amplitude;
+        double *phase;
+        double *cosTable;
+        double *sinTable;
+        int *bitReversal;
+        double *re;
+        double *im;
+        double *tail;
+        double *fadeOut;
+        double *fadeIn;
+        const double *block;
+        int position;
+        int segmentLength;
+        uint64_t random;
+        ikSiglogReader reader;
+        int signal;
+        long filePosition;
+        long nSamples;
+        double windSpeed;
+        double time;
+        /* @endcond */
+    } ikWindGen;
+
+    /**
+     * @struct ikWindGenParams
+     * @brief Streaming turbulent wind speed generator initialisation parameters
+     */
+    typedef struct ikWindGenParams {
+        const char *fileName; /**<name of an @link ikSiglog @endlink file to play back. NULL means the series is synthesised. The default value is NULL*/
+        const char *signalName; /**<name of the played back signal. The default value is "wind speed"*/
+        int spectrum; /**<spectrum type: @link IKWINDGEN_KAIMAL @endlink or @link IKWINDGEN_VONKARMAN @endlink. The default value is @link IKWINDGEN_KAIMAL @endlink*/
+        double meanSpeed; /**<mean wind speed, in m/s. The default value is 11.4*/
+        double turbulenceIntensity; /**<standard deviation over mean wind speed, non-dimensional. The default value is 0.16*/
+        double lengthScale; /**<spectrum length scale, in m. The default value is 340.2, the IEC 61400-1 value for the Kaimal spectrum; the IEC value for the von Karman spectrum is 147*/
+        double samplePeriod; /**<sample period, in s. When playing back, it must match that of the file. The default value is 0.01*/
+        int blockSize; /**<number of samples synthesised per block, a power of 2 between 16 and 2^22. The default value is 65536*/
+        int overlap; /**<number of samples over which consecutive blocks are crossfaded, between 0 and half the block size. The default value is 1024*/
+        uint64_t seed; /**<random seed. The default value is 1*/
+        double startTime; /**<time of the first sample, in s. The default value is 0.0*/
+    } ikWindGenParams;
+
+    /**
+     * Initialise an instance
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid spectrum type, mean wind speed, turbulence intensity or length scale
+     * @li -2: invalid sample period, block size or overlap
+     * @li -3: the file cannot be opened, does not contain the signal or has a different sample period
+     * @li -4: unable to allocate memory
+     */
+    int ikWindGen_init(ikWindGen *self, const ikWindGenParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikWindGen_initParams(ikWindGenParams *params);
+
+    /**
+     * Get the next sample
+     * @param self generator instance
+     * @return wind speed, in m/s
+     */
+    double ikWindGen_step(ikWindGen *self);
+
+    /**
+     * Get a number of samples at once, as from as many calls to
+     * @link ikWindGen_step @endlink
+     * @param self generator instance
+     * @param output wind speeds, in m/s
+     * @param n number of samples
+     */
+    void ikWindGen_read(ikWindGen *self, double *output, long n);
+
+    /**
+     * Get output value by name. Available signals are "wind speed" (m/s)
+     * and "time" (s), both of the last sample.
+     * @param self generator instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     */
+    int ikWindGen_getOutput(const ikWindGen *self, double *output, const char *name);
+
+    /**
+     * Release memory and files
+     * @param self generator instance
+     */
+    void ikWindGen_close(ikWindGen *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKWINDGEN_H */
@@ -0,0 +1,210 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikWsest.c
+ *
+ * @brief Class ikWsest implementation
+ */
+
+/* @cond */
+
+#include <string.h>
+#include <math.h>
+
+#include "ikWsest.h"
+
+/* y = (Cp/lambda^3)^(1/3) at every tip speed ratio of pitch angle j of the
+   power coefficient table, and the smallest tip speed ratio of the branch on
+   which y decreases with the tip speed ratio, where the rotor operates */
+static int branch(const ikWsestParams *params, int j, double *y) {
+    int i, peak;
+
+    for (i = 0; i < params->nLambda; i++) {
+        const double cp = params->cp[i][j] > 0.0 ? params->cp[i][j] : 0.0;
+        y[i] = cbrt(cp)/(params->lambdaMin + i*params->lambdaStep);
+    }
+    for (peak = params->nLambda - 1; peak > 0 && y[peak - 1] >= y[peak]; peak--);
+    return peak;
+}
+
+/* 1/lambda at evenly spaced values of y, from 0 to yMax, for pitch angle j,
+   on the operating branch */
+static void invert(ikWsest *self, const ikWsestParams *params, int j, double yMax) {
+    double y[IKWSEST_MAXLAMBDA];
+    const int peak = branch(params, j, y);
+    const int last = params->nLambda - 1;
+    int i, m;
+
+    for (m = 0; m < self->nPoints; m++) {
+        const double target = m*yMax/(self->nPoints - 1);
+        double lambda;
+        if (target >= y[peak]) {
+            lambda = params->lambdaMin + peak*params->lambdaStep;
+        } else if (target <= y[last]) {
+            /* where the power coefficient vanishes, or the table ends */
+            for (i = peak; i < last && y[i] > target; i++);
+            lambda = params->lambdaMin + i*params->lambdaStep;
+        } else {
+            for (i = peak; y[i + 1] > target; i++);
+            lambda = params->lambdaMin + (i + (y[i] - target)/(y[i] - y[i + 1]))*params->lambdaStep;
+        }
+        self->table[j][m] = 1.0/lambda;
+    }
+}
+
+int ikWsest_init(ikWsest *self, const ikWsestParams *params) {
+    double yMax = 0.0;
+    int j;
+
+    /* the state is set by the first step */
+    self->enable = params->enable;
+    self->started = 0;
+    self->rotorSpeed = 0.0;
+    self->aerodynamicTorque = 0.0;
+    self->inverseTipSpeedRatio = 0.0;
+    self->windSpeed = 0.0;
+    if (!self->enable) return 0;
+
+    /* check the parameters */
+    if (!(params->samplePeriod > 0.0) || !(params->airDensity > 0.0) || !(params->rotorRadius > 0.0)
+            || !(params->gearboxRatio > 0.0) || !(params->inertia > 0.0)) return -1;
+    if (!(params->bandwidth > 0.0) || !(params->damping > 0.0) || !(params->minimumSpeed > 0.0)) return -2;
+    if (params->nLambda < 2 || params->nLambda > IKWSEST_MAXLAMBDA || !(params->lambdaMin > 0.0) || !(params->lambdaStep > 0.0)
+            || params->nPitch < 2 || params->nPitch > IKWSEST_MAXPITCH || !(params->pitchStep > 0.0)
+            || params->nPoints < 2 || params->nPoints > IKWSEST_MAXPOINTS) return -3;
+
+    /* register the parameters, and the observer gains placing both poles at the bandwidth */
+    self->samplePeriod = params->samplePeriod;
+    self->rotorRadius = params->rotorRadius;
+    self->gearboxRatio = params->gearboxRatio;
+    self->inertia = params->inertia;
+    self->speedGain = 2.0*params->damping*params->bandwidth;
+    self->torqueGain = params->inertia*params->bandwidth*params->bandwidth;
+    self->minimumSpeed = params->minimumSpeed;
+    self->torqueScale = 1.0/(0.5*params->airDensity*3.14159265358979*pow(params->rotorRadius, 5.0));
+    self->pitchMin = params->pitchMin;
+    self->inversePitchStep = 1.0/params->pitchStep;
+    self->nPitch = params->nPitch;
+    self->nPoints = params->nPoints;
+
+    /* invert the table, over the range of y of the operating branches of all pitch angles */
+    for (j = 0; j < params->nPitch; j++) {
+        double y[IKWSEST_MAXLAMBDA];
+        const int peak = branch(params, j, y);
+        if (y[peak] > yMax) yMax = y[peak];
+    }
+    if (!(yMax > 0.0)) return -3;
+    self->inverseYStep = (self->nPoints - 1)/yMax;
+    for (j = 0; j < self->nPitch; j++) invert(self, params, j, yMax);
+
+    return 0;
+}
+
+void ikWsest_initParams(ikWsestParams *params) {
+    int i, j;
+
+    params->enable = 0;
+    params->samplePeriod = 0.01;
+    params->airDensity = 1.225;
+    params->rotorRadius = 89.15;
+    params->gearboxRatio = 50.0;
+    params->inertia = 1.5975e8;
+    params->bandwidth = 2.0;
+    params->damping = 0.7;
+    params->minimumSpeed = 0.1;
+    params->nLambda = 0;
+    params->lambdaMin = 0.5;
+    params->lambdaStep = 0.5;
+    params->nPitch = 0;
+    params->pitchMin = 0.0;
+    params->pitchStep = 1.0;
+    for (i = 0; i < IKWSEST_MAXLAMBDA; i++) {
+        for (j = 0; j < IKWSEST_MAXPITCH; j++) params->cp[i][j] = 0.0;
+    }
+    params->nPoints = 32;
+}
+
+double ikWsest_step(ikWsest *self, double generatorSpeed, double torqueDemand, double pitch) {
+    const double rotorSpeed = generatorSpeed/self->gearboxRatio;
+    const double generatorTorque = torqueDemand*1.0e3*self->gearboxRatio; /* kNm to Nm, on the low speed shaft */
+    double error, y, u, v, lo, hi;
+    int i, m;
+
+    if (!self->enable) return 0.0;
+
+    /* start in steady state */
+    if (!self->started) {
+        self->rotorSpeed = rotorSpeed;
+        self->aerodynamicTorque = generatorTorque;
+        self->started = 1;
+    }
+
+    /* drivetrain observer */
+    error = rotorSpeed - self->rotorSpeed;
+    self->rotorSpeed += self->samplePeriod*((self->aerodynamicTorque - generatorTorque)/self->inertia + self->speedGain*error);
+    self->aerodynamicTorque += self->samplePeriod*self->torqueGain*error;
+
+    /* hold the estimate while the rotor is too slow for the torque to tell the wind */
+    if (rotorSpeed < self->minimumSpeed) return self->windSpeed;
+
+    /* interpolate 1/lambda in the inverse table, within it */
+    y = self->aerodynamicTorque > 0.0 ? cbrt(self->aerodynamicTorque*self->torqueScale/(rotorSpeed*rotorSpeed)) : 0.0;
+    u = (pitch - self->pitchMin)*self->inversePitchStep;
+    v = y*self->inverseYStep;
+    if (u < 0.0) u = 0.0;
+    if (u > self->nPitch - 1) u = self->nPitch - 1;
+    if (v > self->nPoints - 1) v = self->nPoints - 1;
+    i = (int) u;
+    m = (int) v;
+    if (i > self->nPitch - 2) i = self->nPitch - 2;
+    if (m > self->nPoints - 2) m = self->nPoints - 2;
+    u -= i;
+    v -= m;
+    lo = self->table[i][m] + v*(self->table[i][m + 1] - self->table[i][m]);
+    hi = self->table[i + 1][m] + v*(self->table[i + 1][m + 1] - self->table[i + 1][m]);
+    self->inverseTipSpeedRatio = lo + u*(hi - lo);
+
+    self->windSpeed = rotorSpeed*self->rotorRadius*self->inverseTipSpeedRatio;
+    return self->windSpeed;
+}
+
+int ikWsest_getOutput(const ikWsest *self, double *output, const char *name) {
+    /* pick up the signal names */
+    if (!strcmp(name, "wind speed")) {
+        *output = self->windSpeed;
+        return 0;
+    }
+    if (!strcmp(name, "rotor speed")) {
+        *output = self->rotorSpeed;
+        return 0;
+    }
+    if (!strcmp(name, "aerodynamic torque")) {
+        *output = self->aerodynamicTorque*1.0e-3;
+        return 0;
+    }
+    if (!strcmp(name, "tip speed ratio")) {
+        *output = self->inverseTipSpeedRatio > 0.0 ? 1.0/self->inverseTipSpeedRatio : 0.0;
+        return 0;
+    }
+
+    return -1;
+}
+
+/* @endcond */
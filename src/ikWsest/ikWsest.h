@@ -0,0 +1,182 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikWsest.h
+ *
+ * @brief Class ikWsest interface
+ */
+
+#ifndef IKWSEST_H
+#define IKWSEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IKWSEST_MAXLAMBDA 48 /**<maximum number of tip speed ratios in the power coefficient table*/
+#define IKWSEST_MAXPITCH 32 /**<maximum number of pitch angles in the power coefficient table*/
+#define IKWSEST_MAXPOINTS 32 /**<maximum number of points per pitch angle in the inverse table*/
+
+    /**
+     * @struct ikWsest
+     * @brief Rotor effective wind speed estimator
+     *
+     * The estimator works out the rotor effective wind speed from the
+     * generator speed, the torque demand and the collective pitch angle.
+     *
+     * First, an observer of the drivetrain as a single inertia J estimates
+     * the rotor speed w and the aerodynamic torque Ta, taken as constant:
+     * dw/dt = (Ta - N*Tg)/J + l1*e and dTa/dt = l2*e, where Tg is the torque
+     * demand, N the gearbox ratio and e the error between the measured and
+     * estimated rotor speeds. The gains place both observer poles at a given
+     * bandwidth and damping ratio.
+     *
+     * Then, the wind speed v is the one for which the power coefficient
+     * table gives that aerodynamic torque, Ta = rho/2*pi*R^2*v^3*Cp(lambda,
+     * beta)/w, with lambda = w*R/v the tip speed ratio and beta the pitch
+     * angle. Solving this for v takes a search over lambda, since Cp is only
+     * known as a table. Instead, since Ta/(rho/2*pi*R^5*w^2) = Cp/lambda^3,
+     * at initialisation the table is inverted, for each of its pitch angles,
+     * into 1/lambda in terms of y = (Cp/lambda^3)^(1/3), at evenly spaced
+     * values of y. The inversion keeps to the tip speed ratios above the
+     * peak of y, where y decreases with lambda and the rotor operates; values
+     * of y above the peak give the tip speed ratio of the peak, near which
+     * the estimate is sensitive to torque errors. A step then costs a cube
+     * root and a bilinear interpolation in that table, whose cell is found
+     * by arithmetic rather than search: v = w*R*(1/lambda)(beta, y). With
+     * the default tables of @link ikWtPlant @endlink and 32 points, the
+     * error is within about 1% over the operating range.
+     *
+     * Pitch angles and values of y outside the table are taken at its
+     * nearest edge. Below a minimum rotor speed, the wind speed estimate is
+     * held. The observer starts in steady state at the first step, and
+     * drivetrain losses are neglected. Disabled, the estimator does
+     * nothing, and its outputs stay 0.
+     *
+     * @par Inputs
+     * @li generator speed: in rad/s, specify via @link ikWsest_step @endlink
+     * @li torque demand: in kNm, specify via @link ikWsest_step @endlink
+     * @li pitch angle: collective, in degrees, specify via @link ikWsest_step @endlink
+     *
+     * @par Outputs
+     * @li wind speed: rotor effective wind speed estimate, in m/s, get via @link ikWsest_step @endlink or @link ikWsest_getOutput @endlink
+     * @li rotor speed: rotor speed estimate, in rad/s, get via @link ikWsest_getOutput @endlink
+     * @li aerodynamic torque: aerodynamic torque estimate, on the low speed shaft, in kNm, get via @link ikWsest_getOutput @endlink
+     * @li tip speed ratio: tip speed ratio estimate, non-dimensional, get via @link ikWsest_getOutput @endlink
+     *
+     * @par Methods
+     * @li @link ikWsest_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikWsest_init @endlink initialise an instance
+     * @li @link ikWsest_step @endlink execute periodic calculations
+     * @li @link ikWsest_getOutput @endlink get output value
+     */
+    typedef struct ikWsest {
+        /* @cond */
+        int enable;
+        int started;
+        double samplePeriod;
+        double rotorRadius;
+        double gearboxRatio;
+        double inertia;
+        double speedGain;
+        double torqueGain;
+        double minimumSpeed;
+        double torqueScale;
+        double pitchMin;
+        double inversePitchStep;
+        int nPitch;
+        double inverseYStep;
+        int nPoints;
+        double rotorSpeed;
+        double aerodynamicTorque;
+        double inverseTipSpeedRatio;
+        double windSpeed;
+        double table[IKWSEST_MAXPITCH][IKWSEST_MAXPOINTS];
+        /* @endcond */
+    } ikWsest;
+
+    /**
+     * @struct ikWsestParams
+     * @brief Rotor effective wind speed estimator initialisation parameters
+     */
+    typedef struct ikWsestParams {
+        int enable; /**<enable flag, 0 to leave the estimator off, any other value to run it. The default value is 0*/
+        double samplePeriod; /**<sample period, in s. It must be positive. The default value is 0.01*/
+        double airDensity; /**<air density, in kg/m^3. The default value is 1.225*/
+        double rotorRadius; /**<rotor radius, in m. The default value is 89.15*/
+        double gearboxRatio; /**<gearbox ratio, non-dimensional. The default value is 50*/
+        double inertia; /**<rotor and generator inertia, on the low speed shaft, in kg m^2. The default value is 1.5975e8*/
+        double bandwidth; /**<observer bandwidth, in rad/s. It must be positive. The default value is 2.0*/
+        double damping; /**<observer damping ratio, non-dimensional. It must be positive. The default value is 0.7*/
+        double minimumSpeed; /**<rotor speed below which the wind speed estimate is held, in rad/s. It must be positive. The default value is 0.1*/
+        int nLambda; /**<number of tip speed ratios in the power coefficient table, between 2 and @link IKWSEST_MAXLAMBDA @endlink. The default value is 0*/
+        double lambdaMin; /**<first tip speed ratio in the power coefficient table. It must be positive. The default value is 0.5*/
+        double lambdaStep; /**<tip speed ratio step in the power coefficient table. It must be positive. The default value is 0.5*/
+        int nPitch; /**<number of pitch angles in the power coefficient table, between 2 and @link IKWSEST_MAXPITCH @endlink. The default value is 0*/
+        double pitchMin; /**<first pitch angle in the power coefficient table, in degrees. The default value is 0.0*/
+        double pitchStep; /**<pitch angle step in the power coefficient table, in degrees. It must be positive. The default value is 1.0*/
+        double cp[IKWSEST_MAXLAMBDA][IKWSEST_MAXPITCH]; /**<power coefficients, by tip speed ratio and pitch angle. The default value is {{0.0, ...}, ...}*/
+        int nPoints; /**<number of points per pitch angle in the inverse table, between 2 and @link IKWSEST_MAXPOINTS @endlink. The default value is 32*/
+    } ikWsestParams;
+
+    /**
+     * Initialise an instance. The parameters are only checked if enabled.
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid sample period, air density, rotor radius, gearbox ratio or inertia
+     * @li -2: invalid observer bandwidth, damping ratio or minimum speed
+     * @li -3: invalid power coefficient table or number of points of the inverse table
+     */
+    int ikWsest_init(ikWsest *self, const ikWsestParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikWsest_initParams(ikWsestParams *params);
+
+    /**
+     * Execute periodic calculations
+     * @param self estimator instance
+     * @param generatorSpeed generator speed, in rad/s
+     * @param torqueDemand torque demand, in kNm
+     * @param pitch collective pitch angle, in degrees
+     * @return wind speed estimate, in m/s
+     */
+    double ikWsest_step(ikWsest *self, double generatorSpeed, double torqueDemand, double pitch);
+
+    /**
+     * Get output value by name
+     * @param self estimator instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     */
+    int ikWsest_getOutput(const ikWsest *self, double *output, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKWSEST_H */
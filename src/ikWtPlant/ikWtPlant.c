@@ -0,0 +1,423 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikWtPlant.c
+ *
+ * @brief Class ikWtPlant implementation
+ */
+
+/* @cond */
+
+#include <string.h>
+#include <math.h>
+
+#include "ikWtPlant.h"
+
+#define PI 3.14159265358979
+
+int ikWtPlant_init(ikWtPlant *self, const ikWtPlantParams *params) {
+    ikWtPlantPrivate *p = &(self->priv);
+    int i, j;
+
+    /* register integration settings */
+    if (!(params->samplePeriod > 0.0) || params->nSubsteps < 1) return -1;
+    p->dt = params->samplePeriod;
+    p->nSubsteps = params->nSubsteps;
+
+    /* register rotor, drivetrain, actuator and tower parameters */
+    if (!(params->airDensity > 0.0) || !(params->rotorRadius > 0.0) || !(params->gearboxRatio > 0.0)) return -2;
+    if (!(params->rotorInertia > 0.0) || !(params->generatorInertia > 0.0) || !(params->shaftStiffness > 0.0)) return -2;
+    if (!(params->efficiency > 0.0) || !(params->pitchTimeConstant > 0.0) || !(params->pitchRateLimit > 0.0)) return -2;
+    if (!(params->towerModalMass > 0.0) || !(params->towerFrequency > 0.0)) return -2;
+    p->rho = params->airDensity;
+    p->rotorRadius = params->rotorRadius;
+    p->rotorArea = PI*params->rotorRadius*params->rotorRadius;
+    p->gearboxRatio = params->gearboxRatio;
+    p->rotorInertia = params->rotorInertia;
+    p->generatorInertia = params->generatorInertia*params->gearboxRatio*params->gearboxRatio;
+    p->shaftStiffness = params->shaftStiffness;
+    p->shaftDamping = params->shaftDamping;
+    p->efficiency = params->efficiency;
+    p->pitchTimeConstant = params->pitchTimeConstant;
+    p->pitchRateLimit = params->pitchRateLimit;
+    p->minPitch = params->minimumPitch;
+    p->maxPitch = params->maximumPitch;
+    p->towerMass = params->towerModalMass;
+    p->towerStiffness = params->towerModalMass*params->towerFrequency*params->towerFrequency;
+    p->towerDamping = 2.0*params->towerDampingRatio*params->towerModalMass*params->towerFrequency;
+
+    /* register aerodynamic tables */
+    if (params->nLambda < 2 || params->nLambda > IKWTPLANT_MAXLAMBDA || !(params->lambdaStep > 0.0)) return -3;
+    if (params->nPitch < 2 || params->nPitch > IKWTPLANT_MAXPITCH || !(params->pitchStep > 0.0)) return -3;
+    p->nLambda = params->nLambda;
+    p->nPitch = params->nPitch;
+    p->lambdaMin = params->lambdaMin;
+    p->lambdaStep = params->lambdaStep;
+    p->pitchMin = params->pitchMin;
+    p->pitchStep = params->pitchStep;
+    for (i = 0; i < p->nLambda; i++) {
+        for (j = 0; j < p->nPitch; j++) {
+            p->cp[i][j] = params->cp[i][j];
+            p->ct[i][j] = params->ct[i][j];
+        }
+    }
+
+    /* initialise states */
+    p->rotorSpeed = params->initialRotorSpeed;
+    p->generatorSpeed = params->initialRotorSpeed;
+    p->shaftTwist = 0.0;
+    for (i = 0; i < 3; i++) p->pitch[i] = params->initialPitch;
+    p->towerPosition = 0.0;
+    p->towerVelocity = 0.0;
+    p->towerAcceleration = 0.0;
+    p->lambda = 0.0;
+    p->powerCoefficient = 0.0;
+    p->thrustCoefficient = 0.0;
+    p->aeroTorque = 0.0;
+    p->thrust = 0.0;
+    p->shaftTorque = 0.0;
+
+    /* initialise inputs and outputs */
+    self->in.windSpeed = 0.0;
+    self->in.torqueDemand = 0.0;
+    for (i = 0; i < 3; i++) self->in.pitchDemand[i] = params->initialPitch;
+    memset(&(self->out), 0, sizeof(self->out));
+    self->out.generatorSpeed = p->generatorSpeed*p->gearboxRatio;
+    self->out.rotorSpeed = p->rotorSpeed;
+    for (i = 0; i < 3; i++) self->out.pitch[i] = p->pitch[i];
+
+    return 0;
+}
+
+static double powerCoefficient(double lambda, double pitch) {
+    /* analytic approximation, pitch in degrees */
+    double li = 1.0/(1.0/(lambda + 0.08*pitch) - 0.035/(pitch*pitch*pitch + 1.0));
+    double cp = 0.5176*(116.0/li - 0.4*pitch - 5.0)*exp(-21.0/li) + 0.0068*lambda;
+    return cp > 0.0 ? cp : 0.0;
+}
+
+static double thrustCoefficient(double cp) {
+    /* momentum theory: cp = 4a(1-a)^2 and ct = 4a(1-a), with 0 <= a <= 1/3 */
+    double lo = 0.0;
+    double hi = 1.0/3.0;
+    int i;
+
+    if (cp >= 16.0/27.0) return 8.0/9.0;
+    for (i = 0; i < 50; i++) {
+        double a = 0.5*(lo + hi);
+        if (4.0*a*(1.0 - a)*(1.0 - a) < cp) lo = a;
+        else hi = a;
+    }
+    return 4.0*lo*(1.0 - lo);
+}
+
+void ikWtPlant_initParams(ikWtPlantParams *params) {
+    int i, j;
+
+    params->samplePeriod = 0.01;
+    params->nSubsteps = 4;
+    params->airDensity = 1.225;
+    params->rotorRadius = 89.15;
+    params->gearboxRatio = 50.0;
+    params->rotorInertia = 1.56e8;
+    params->generatorInertia = 1500.5;
+    params->shaftStiffness = 1.631e9;
+    params->shaftDamping = 7.7e5;
+    params->efficiency = 0.94;
+    params->pitchTimeConstant = 0.1;
+    params->pitchRateLimit = 10.0/180.0*PI;
+    params->minimumPitch = 0.0;
+    params->maximumPitch = PI/2.0;
+    params->towerModalMass = 8.3e5;
+    params->towerFrequency = 1.59;
+    params->towerDampingRatio = 0.01;
+    params->initialRotorSpeed = 6.5/30.0*PI;
+    params->initialPitch = 0.0;
+
+    /* tabulate the analytic aerodynamic coefficients */
+    params->nLambda = 40;
+    params->lambdaMin = 0.5;
+    params->lambdaStep = 0.5;
+    params->nPitch = 40;
+    params->pitchMin = 0.0;
+    params->pitchStep = 1.0;
+    for (i = 0; i < IKWTPLANT_MAXLAMBDA; i++) {
+        for (j = 0; j < IKWTPLANT_MAXPITCH; j++) {
+            double cp = powerCoefficient(params->lambdaMin + i*params->lambdaStep, params->pitchMin + j*params->pitchStep);
+            params->cp[i][j] = cp;
+            params->ct[i][j] = thrustCoefficient(cp);
+        }
+    }
+}
+
+static void evalAero(ikWtPlantPrivate *p, double lambda, double pitch) {
+    /* bilinear interpolation on the uniform grid, clamped at the edges */
+    double x = (lambda - p->lambdaMin)/p->lambdaStep;
+    double y = (pitch - p->pitchMin)/p->pitchStep;
+    int i, j;
+    double fx, fy;
+
+    if (x < 0.0) x = 0.0;
+    if (x > p->nLambda - 1) x = p->nLambda - 1;
+    if (y < 0.0) y = 0.0;
+    if (y > p->nPitch - 1) y = p->nPitch - 1;
+    i = (int) x;
+    j = (int) y;
+    if (i > p->nLambda - 2) i = p->nLambda - 2;
+    if (j > p->nPitch - 2) j = p->nPitch - 2;
+    fx = x - i;
+    fy = y - j;
+
+    p->powerCoefficient = (1.0 - fx)*((1.0 - fy)*p->cp[i][j] + fy*p->cp[i][j + 1]) + fx*((1.0 - fy)*p->cp[i + 1][j] + fy*p->cp[i + 1][j + 1]);
+    p->thrustCoefficient = (1.0 - fx)*((1.0 - fy)*p->ct[i][j] + fy*p->ct[i][j + 1]) + fx*((1.0 - fy)*p->ct[i + 1][j] + fy*p->ct[i + 1][j + 1]);
+}
+
+static double aeroTorque(ikWtPlantPrivate *p, double rotorSpeed, double pitch, double wind) {
+    /* low speed shaft aerodynamic torque in Nm, pitch in rad */
+    double lambda = rotorSpeed*p->rotorRadius/wind;
+    evalAero(p, lambda, pitch*180.0/PI);
+    return 0.5*p->rho*p->rotorArea*wind*wind*p->rotorRadius*p->powerCoefficient/(lambda > 0.5 ? lambda : 0.5);
+}
+
+static double trimTorque(double generatorSpeed, double torqueGain, double maximumTorque) {
+    double torque = torqueGain*generatorSpeed*generatorSpeed;
+    return torque < maximumTorque ? torque : maximumTorque;
+}
+
+int ikWtPlant_trim(ikWtPlant *self, double windSpeed, double minimumSpeed, double maximumSpeed, double torqueGain, double maximumTorque, double minimumPitch) {
+    ikWtPlantPrivate *p = &(self->priv);
+    double wind = windSpeed > 0.1 ? windSpeed : 0.1;
+    double n = p->gearboxRatio;
+    double speed = maximumSpeed;
+    double pitch = minimumPitch > p->minPitch ? minimumPitch : p->minPitch;
+    double torque;
+    double lo, hi;
+    int i, b;
+
+    if (aeroTorque(p, maximumSpeed/n, pitch, wind) < n*trimTorque(maximumSpeed, torqueGain, maximumTorque)) {
+        /* below the maximum speed: take the highest speed where the torques balance, scanning down */
+        hi = maximumSpeed;
+        lo = hi;
+        for (i = 1; i <= 100; i++) {
+            lo = maximumSpeed - 0.01*i*(maximumSpeed - minimumSpeed);
+            if (aeroTorque(p, lo/n, pitch, wind) >= n*trimTorque(lo, torqueGain, maximumTorque)) break;
+            hi = lo;
+        }
+        if (i <= 100) {
+            for (i = 0; i < 60; i++) {
+                speed = 0.5*(lo + hi);
+                if (aeroTorque(p, speed/n, pitch, wind) >= n*trimTorque(speed, torqueGain, maximumTorque)) lo = speed;
+                else hi = speed;
+            }
+            speed = 0.5*(lo + hi);
+            torque = trimTorque(speed, torqueGain, maximumTorque);
+        } else {
+            /* held at the minimum speed, absorbing the rotor torque */
+            speed = minimumSpeed;
+            torque = aeroTorque(p, speed/n, pitch, wind)/n;
+            if (!(torque > 0.0)) return -1;
+        }
+    } else {
+        /* at the maximum speed: absorb the rotor torque, pitching when above the maximum torque */
+        torque = aeroTorque(p, speed/n, pitch, wind)/n;
+        if (torque > maximumTorque) {
+            torque = maximumTorque;
+            if (aeroTorque(p, speed/n, p->maxPitch, wind) > n*torque) return -2;
+            lo = pitch;
+            hi = p->maxPitch;
+            for (i = 0; i < 60; i++) {
+                pitch = 0.5*(lo + hi);
+                if (aeroTorque(p, speed/n, pitch, wind) > n*torque) lo = pitch;
+                else hi = pitch;
+            }
+            pitch = 0.5*(lo + hi);
+        }
+    }
+
+    /* set the states */
+    p->rotorSpeed = speed/n;
+    p->generatorSpeed = speed/n;
+    p->shaftTorque = n*torque;
+    p->shaftTwist = p->shaftTorque/p->shaftStiffness;
+    for (b = 0; b < 3; b++) p->pitch[b] = pitch;
+    p->aeroTorque = aeroTorque(p, p->rotorSpeed, pitch, wind);
+    p->lambda = p->rotorSpeed*p->rotorRadius/wind;
+    p->thrust = 0.5*p->rho*p->rotorArea*wind*wind*p->thrustCoefficient;
+    p->towerPosition = p->thrust/p->towerStiffness;
+    p->towerVelocity = 0.0;
+    p->towerAcceleration = 0.0;
+
+    /* set the inputs and outputs */
+    self->in.windSpeed = windSpeed;
+    self->in.torqueDemand = torque;
+    for (b = 0; b < 3; b++) self->in.pitchDemand[b] = pitch;
+    self->out.generatorSpeed = speed;
+    self->out.rotorSpeed = p->rotorSpeed;
+    self->out.generatorTorque = torque;
+    self->out.electricalPower = torque*speed*p->efficiency;
+    for (b = 0; b < 3; b++) self->out.pitch[b] = pitch;
+    self->out.towerTopAcceleration = 0.0;
+
+    return 0;
+}
+
+void ikWtPlant_step(ikWtPlant *self) {
+    ikWtPlantPrivate *p = &(self->priv);
+    double h = p->dt/p->nSubsteps;
+    double demand[3];
+    int s, b;
+
+    /* saturate the pitch demands */
+    for (b = 0; b < 3; b++) {
+        demand[b] = self->in.pitchDemand[b];
+        demand[b] = demand[b] > p->minPitch ? demand[b] : p->minPitch;
+        demand[b] = demand[b] < p->maxPitch ? demand[b] : p->maxPitch;
+    }
+
+    for (s = 0; s < p->nSubsteps; s++) {
+        double pitch = 0.0;
+        double wind;
+        double dynamicPressure;
+
+        /* pitch actuators */
+        for (b = 0; b < 3; b++) {
+            double rate = (demand[b] - p->pitch[b])/p->pitchTimeConstant;
+            rate = rate < p->pitchRateLimit ? rate : p->pitchRateLimit;
+            rate = rate > -p->pitchRateLimit ? rate : -p->pitchRateLimit;
+            p->pitch[b] += h*rate;
+            pitch += p->pitch[b];
+        }
+        pitch /= 3.0;
+
+        /* rotor aerodynamics, with the wind relative to the tower top */
+        wind = self->in.windSpeed - p->towerVelocity;
+        wind = wind > 0.1 ? wind : 0.1;
+        p->lambda = p->rotorSpeed*p->rotorRadius/wind;
+        evalAero(p, p->lambda, pitch*180.0/PI);
+        dynamicPressure = 0.5*p->rho*p->rotorArea*wind*wind;
+        p->aeroTorque = dynamicPressure*p->rotorRadius*p->powerCoefficient/(p->lambda > 0.5 ? p->lambda : 0.5);
+        p->thrust = dynamicPressure*p->thrustCoefficient;
+
+        /* two-mass drivetrain, generator speed on the low speed side */
+        p->shaftTorque = p->shaftStiffness*p->shaftTwist + p->shaftDamping*(p->rotorSpeed - p->generatorSpeed);
+        p->rotorSpeed += h*(p->aeroTorque - p->shaftTorque)/p->rotorInertia;
+        p->generatorSpeed += h*(p->shaftTorque - p->gearboxRatio*self->in.torqueDemand)/p->generatorInertia;
+        p->shaftTwist += h*(p->rotorSpeed - p->generatorSpeed);
+
+        /* tower fore-aft mode */
+        p->towerAcceleration = (p->thrust - p->towerStiffness*p->towerPosition - p->towerDamping*p->towerVelocity)/p->towerMass;
+        p->towerVelocity += h*p->towerAcceleration;
+        p->towerPosition += h*p->towerVelocity;
+    }
+
+    /* update outputs */
+    self->out.time += p->dt;
+    self->out.generatorSpeed = p->generatorSpeed*p->gearboxRatio;
+    self->out.rotorSpeed = p->rotorSpeed;
+    self->out.generatorTorque = self->in.torqueDemand;
+    self->out.electricalPower = self->in.torqueDemand*self->out.generatorSpeed*p->efficiency;
+    for (b = 0; b < 3; b++) self->out.pitch[b] = p->pitch[b];
+    self->out.towerTopAcceleration = p->towerAcceleration;
+}
+
+void ikWtPlant_readSwap(ikWtPlant *self, const float *DATA) {
+    self->in.torqueDemand = (double) DATA[46]; /* Nm */
+    self->in.pitchDemand[0] = (double) DATA[41]; /* rad */
+    self->in.pitchDemand[1] = (double) DATA[42]; /* rad */
+    self->in.pitchDemand[2] = (double) DATA[43]; /* rad */
+}
+
+void ikWtPlant_writeSwap(const ikWtPlant *self, float *DATA) {
+    DATA[1] = (float) self->out.time; /* s */
+    DATA[2] = (float) self->priv.dt; /* s */
+    DATA[3] = (float) self->out.pitch[0]; /* rad */
+    DATA[14] = (float) self->out.electricalPower; /* W */
+    DATA[19] = (float) self->out.generatorSpeed; /* rad/s */
+    DATA[20] = (float) self->out.rotorSpeed; /* rad/s */
+    DATA[22] = (float) self->out.generatorTorque; /* Nm */
+    DATA[26] = (float) self->in.windSpeed; /* m/s */
+    DATA[32] = (float) self->out.pitch[1]; /* rad */
+    DATA[33] = (float) self->out.pitch[2]; /* rad */
+    DATA[52] = (float) self->out.towerTopAcceleration; /* m/s^2 */
+}
+
+int ikWtPlant_getOutput(const ikWtPlant *self, double *output, const char *name) {
+    /* pick up the signal names */
+    if (!strcmp(name, "time")) {
+        *output = self->out.time;
+        return 0;
+    }
+    if (!strcmp(name, "generator speed")) {
+        *output = self->out.generatorSpeed;
+        return 0;
+    }
+    if (!strcmp(name, "rotor speed")) {
+        *output = self->out.rotorSpeed;
+        return 0;
+    }
+    if (!strcmp(name, "generator torque")) {
+        *output = self->out.generatorTorque;
+        return 0;
+    }
+    if (!strcmp(name, "electrical power")) {
+        *output = self->out.electricalPower;
+        return 0;
+    }
+    if (!strcmp(name, "tower top acceleration")) {
+        *output = self->out.towerTopAcceleration;
+        return 0;
+    }
+    if (!strcmp(name, "tip speed ratio")) {
+        *output = self->priv.lambda;
+        return 0;
+    }
+    if (!strcmp(name, "power coefficient")) {
+        *output = self->priv.powerCoefficient;
+        return 0;
+    }
+    if (!strcmp(name, "thrust coefficient")) {
+        *output = self->priv.thrustCoefficient;
+        return 0;
+    }
+    if (!strcmp(name, "aerodynamic torque")) {
+        *output = self->priv.aeroTorque;
+        return 0;
+    }
+    if (!strcmp(name, "thrust")) {
+        *output = self->priv.thrust;
+        return 0;
+    }
+    if (!strcmp(name, "shaft torque")) {
+        *output = self->priv.shaftTorque;
+        return 0;
+    }
+    if (!strcmp(name, "tower top displacement")) {
+        *output = self->priv.towerPosition;
+        return 0;
+    }
+    if (!strcmp(name, "tower top velocity")) {
+        *output = self->priv.towerVelocity;
+        return 0;
+    }
+
+    return -1;
+}
+
+/* @endcond */
@@ -0,0 +1,284 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ikWtPlant.h
+ *
+ * @brief Class ikWtPlant interface
+ */
+
+#ifndef IKWTPLANT_H
+#define IKWTPLANT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IKWTPLANT_MAXLAMBDA 48 /**<maximum number of tip speed ratios in the aerodynamic tables*/
+#define IKWTPLANT_MAXPITCH 48 /**<maximum number of pitch angles in the aerodynamic tables*/
+
+    /**
+     * @struct ikWtPlantInputs
+     * @brief plant inputs
+     */
+    typedef struct ikWtPlantInputs {
+        double windSpeed; /**<hub height wind speed in m/s*/
+        double torqueDemand; /**<generator torque demand in Nm*/
+        double pitchDemand[3]; /**<pitch angle demands in rad*/
+    } ikWtPlantInputs;
+
+    /**
+     * @struct ikWtPlantOutputs
+     * @brief plant outputs
+     */
+    typedef struct ikWtPlantOutputs {
+        double time; /**<simulation time in s*/
+        double generatorSpeed; /**<generator speed in rad/s*/
+        double rotorSpeed; /**<rotor speed in rad/s*/
+        double generatorTorque; /**<generator torque in Nm*/
+        double electricalPower; /**<electrical power in W*/
+        double pitch[3]; /**<pitch angles in rad*/
+        double towerTopAcceleration; /**<tower top fore-aft acceleration in m/s^2*/
+    } ikWtPlantOutputs;
+
+    /* @cond */
+    typedef struct ikWtPlantPrivate {
+        double dt;
+        int nSubsteps;
+        double rho;
+        double rotorRadius;
+        double rotorArea;
+        double gearboxRatio;
+        double rotorInertia;
+        double generatorInertia;
+        double shaftStiffness;
+        double shaftDamping;
+        double efficiency;
+        double pitchTimeConstant;
+        double pitchRateLimit;
+        double minPitch;
+        double maxPitch;
+        double towerMass;
+        double towerStiffness;
+        double towerDamping;
+        int nLambda;
+        int nPitch;
+        double lambdaMin;
+        double lambdaStep;
+        double pitchMin;
+        double pitchStep;
+        double cp[IKWTPLANT_MAXLAMBDA][IKWTPLANT_MAXPITCH];
+        double ct[IKWTPLANT_MAXLAMBDA][IKWTPLANT_MAXPITCH];
+        double rotorSpeed;
+        double generatorSpeed;
+        double shaftTwist;
+        double pitch[3];
+        double towerPosition;
+        double towerVelocity;
+        double towerAcceleration;
+        double lambda;
+        double powerCoefficient;
+        double thrustCoefficient;
+        double aeroTorque;
+        double thrust;
+        double shaftTorque;
+    } ikWtPlantPrivate;
+    /* @endcond */
+
+    /**
+     * @struct ikWtPlant
+     * @brief Reduced-order wind turbine plant
+     *
+     * This is a lightweight wind turbine model for closed-loop testing of the
+     * controller, tuned by default to the DTU 10MW reference wind turbine
+     * configured in @link ikClwindconWTConfig.c @endlink. It consists of
+     * @li a rigid rotor, with power and thrust coefficient tables in terms of tip speed ratio and pitch angle, evaluated at the collective pitch angle and the wind speed relative to the tower top
+     * @li a two-mass torsional drivetrain, with the generator on the high speed side of an ideal gearbox
+     * @li three first-order, rate-limited pitch actuators
+     * @li a single-mode tower fore-aft model driven by the rotor thrust
+     *
+     * The states are integrated with a semi-implicit Euler method over a fixed
+     * number of substeps per sample period.
+     *
+     * The plant speaks the swap array layout of DISCON, see
+     * @link ikWtPlant_readSwap @endlink and @link ikWtPlant_writeSwap @endlink.
+     *
+     * @par Inputs
+     * @li wind speed: hub height wind speed, in m/s, specify via @link ikWtPlantInputs.windSpeed @endlink at @link in @endlink
+     * @li torque demand: generator torque demand, in Nm, specify via @link ikWtPlantInputs.torqueDemand @endlink at @link in @endlink
+     * @li pitch demands: pitch angle demands, in rad, specify via @link ikWtPlantInputs.pitchDemand @endlink at @link in @endlink
+     *
+     * @par Outputs
+     * @li time: in s, get via @link ikWtPlantOutputs.time @endlink at @link out @endlink
+     * @li generator speed: in rad/s, get via @link ikWtPlantOutputs.generatorSpeed @endlink at @link out @endlink
+     * @li rotor speed: in rad/s, get via @link ikWtPlantOutputs.rotorSpeed @endlink at @link out @endlink
+     * @li generator torque: in Nm, get via @link ikWtPlantOutputs.generatorTorque @endlink at @link out @endlink
+     * @li electrical power: in W, get via @link ikWtPlantOutputs.electricalPower @endlink at @link out @endlink
+     * @li pitch angles: in rad, get via @link ikWtPlantOutputs.pitch @endlink at @link out @endlink
+     * @li tower top acceleration: fore-aft, in m/s^2, get via @link ikWtPlantOutputs.towerTopAcceleration @endlink at @link out @endlink
+     *
+     * @par Public members
+     * @li @link in @endlink inputs
+     * @li @link out @endlink outputs
+     *
+     * @par Methods
+     * @li @link ikWtPlant_initParams @endlink initialise initialisation parameter structure
+     * @li @link ikWtPlant_init @endlink initialise an instance
+     * @li @link ikWtPlant_trim @endlink set the states to a steady operating point
+     * @li @link ikWtPlant_step @endlink advance one sample period
+     * @li @link ikWtPlant_readSwap @endlink take the inputs from a DISCON swap array
+     * @li @link ikWtPlant_writeSwap @endlink write the outputs to a DISCON swap array
+     * @li @link ikWtPlant_getOutput @endlink get output value
+     */
+    typedef struct ikWtPlant {
+        ikWtPlantInputs in; /**<inputs*/
+        ikWtPlantOutputs out; /**<outputs*/
+        /* @cond */
+        ikWtPlantPrivate priv;
+        /* @endcond */
+    } ikWtPlant;
+
+    /**
+     * @struct ikWtPlantParams
+     * @brief plant initialisation parameters
+     *
+     * The default values suit the DTU 10MW reference wind turbine. The
+     * default aerodynamic tables are an analytic approximation of its power
+     * coefficient, with a maximum of 0.48 at a tip speed ratio of 8.1 and
+     * zero pitch, and the thrust coefficient derived from it by momentum
+     * theory.
+     */
+    typedef struct ikWtPlantParams {
+        double samplePeriod; /**<sample period, in s. The default value is 0.01*/
+        int nSubsteps; /**<integration substeps per sample period. The default value is 4*/
+        double airDensity; /**<air density, in kg/m^3. The default value is 1.225*/
+        double rotorRadius; /**<rotor radius, in m. The default value is 89.15*/
+        double gearboxRatio; /**<gearbox ratio, non-dimensional. The default value is 50*/
+        double rotorInertia; /**<rotor inertia, in kg m^2. The default value is 1.56e8*/
+        double generatorInertia; /**<generator inertia on the high speed side, in kg m^2. The default value is 1500.5*/
+        double shaftStiffness; /**<low speed shaft torsional stiffness, in Nm/rad. The default value is 1.631e9, placing the drivetrain mode at 21.1 rad/s*/
+        double shaftDamping; /**<low speed shaft torsional damping, in Nms/rad. The default value is 7.7e5*/
+        double efficiency; /**<generator efficiency, non-dimensional. The default value is 0.94*/
+        double pitchTimeConstant; /**<pitch actuator time constant, in s. The default value is 0.1*/
+        double pitchRateLimit; /**<pitch rate limit, in rad/s. The default value is 0.1745 (10 deg/s)*/
+        double minimumPitch; /**<lower pitch angle limit, in rad. The default value is 0.0*/
+        double maximumPitch; /**<upper pitch angle limit, in rad. The default value is 1.5708 (90 deg)*/
+        double towerModalMass; /**<tower fore-aft modal mass, in kg. The default value is 8.3e5*/
+        double towerFrequency; /**<tower fore-aft natural frequency, in rad/s. The default value is 1.59*/
+        double towerDampingRatio; /**<tower fore-aft structural damping ratio, non-dimensional. The default value is 0.01*/
+        double initialRotorSpeed; /**<initial rotor speed, in rad/s. The default value is 0.68 (6.5 rpm)*/
+        double initialPitch; /**<initial pitch angle, in rad. The default value is 0.0*/
+        int nLambda; /**<number of tip speed ratios in the aerodynamic tables. The default value is 40*/
+        double lambdaMin; /**<first tip speed ratio in the aerodynamic tables. The default value is 0.5*/
+        double lambdaStep; /**<tip speed ratio step in the aerodynamic tables. The default value is 0.5*/
+        int nPitch; /**<number of pitch angles in the aerodynamic tables. The default value is 40*/
+        double pitchMin; /**<first pitch angle in the aerodynamic tables, in degrees. The default value is 0.0*/
+        double pitchStep; /**<pitch angle step in the aerodynamic tables, in degrees. The default value is 1.0*/
+        double cp[IKWTPLANT_MAXLAMBDA][IKWTPLANT_MAXPITCH]; /**<power coefficients, by tip speed ratio and pitch angle*/
+        double ct[IKWTPLANT_MAXLAMBDA][IKWTPLANT_MAXPITCH]; /**<thrust coefficients, by tip speed ratio and pitch angle*/
+    } ikWtPlantParams;
+
+    /**
+     * Initialise a plant instance
+     * @param self instance
+     * @param params initialisation parameters
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid sample period or number of substeps
+     * @li -2: invalid rotor, drivetrain or tower parameters, they must be positive
+     * @li -3: invalid aerodynamic table size or spacing
+     */
+    int ikWtPlant_init(ikWtPlant *self, const ikWtPlantParams *params);
+
+    /**
+     * Initialise initialisation parameter structure
+     * @param params initialisation parameter structure
+     */
+    void ikWtPlant_initParams(ikWtPlantParams *params);
+
+    /**
+     * Set the states, inputs and outputs to the steady operating point reached
+     * at a constant wind speed under a variable speed, pitch regulated
+     * control law: the generator speed held at its minimum at low wind speeds,
+     * then a generator torque of torqueGain times the generator speed squared
+     * up to the maximum speed, then the torque that holds the maximum speed up
+     * to the maximum torque, with the pitch angle at its minimum, and finally
+     * the pitch angle that holds the maximum speed at the maximum torque. Tower and drivetrain deflections are set to their
+     * static values. The time is left unchanged.
+     * @param self plant instance
+     * @param windSpeed hub height wind speed, in m/s
+     * @param minimumSpeed minimum generator speed, in rad/s
+     * @param maximumSpeed maximum generator speed, in rad/s
+     * @param torqueGain below rated generator torque gain, in Nm s^2/rad^2
+     * @param maximumTorque maximum generator torque, in Nm
+     * @param minimumPitch minimum pitch angle, in rad
+     * @return error code:
+     * @li 0: no error
+     * @li -1: no steady operating point, the wind speed is too low
+     * @li -2: no steady operating point at the maximum speed, the wind speed is too high for the pitch range
+     */
+    int ikWtPlant_trim(ikWtPlant *self, double windSpeed, double minimumSpeed, double maximumSpeed, double torqueGain, double maximumTorque, double minimumPitch);
+
+    /**
+     * Advance one sample period
+     * @param self plant instance
+     */
+    void ikWtPlant_step(ikWtPlant *self);
+
+    /**
+     * Take the inputs from a DISCON swap array: the generator torque demand
+     * from DATA[46] and the pitch angle demands from DATA[41] to DATA[43].
+     * The wind speed is not part of the swap array and must be set
+     * separately.
+     * @param self plant instance
+     * @param DATA swap array
+     */
+    void ikWtPlant_readSwap(ikWtPlant *self, const float *DATA);
+
+    /**
+     * Write the outputs to a DISCON swap array: time to DATA[1], sample
+     * period to DATA[2], pitch angles to DATA[3], DATA[32] and DATA[33],
+     * electrical power to DATA[14], generator speed to DATA[19], rotor speed
+     * to DATA[20], generator torque to DATA[22], wind speed to DATA[26] and
+     * tower top fore-aft acceleration to DATA[52].
+     * @param self plant instance
+     * @param DATA swap array
+     */
+    void ikWtPlant_writeSwap(const ikWtPlant *self, float *DATA);
+
+    /**
+     * Get output value by name. Besides the outputs in
+     * @link ikWtPlant.out @endlink, the following signals are available:
+     * "tip speed ratio", "power coefficient", "thrust coefficient",
+     * "aerodynamic torque" (Nm), "thrust" (N), "shaft torque" (Nm),
+     * "tower top displacement" (m) and "tower top velocity" (m/s).
+     * @param self plant instance
+     * @param output output value
+     * @param name output name, NULL terminated string
+     * @return error code:
+     * @li 0: no error
+     * @li -1: invalid signal name
+     */
+    int ikWtPlant_getOutput(const ikWtPlant *self, double *output, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IKWTPLANT_H */
@@ -0,0 +1,158 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file logview.c
+ *
+ * @brief Signal log browser
+ *
+ * Prints the contents of an @link ikSiglog @endlink file, or an overview of
+ * one of its signals over a stretch of time. Usage:
+ * @li logview FILE: list the signals, the number of samples and the pyramid levels
+ * @li logview FILE SIGNAL [-f FROM] [-t TO] [-n POINTS]: print the signal from FROM to TO, in s, in at most POINTS rows
+ *
+ * The defaults are the whole log and 1000 rows. If the stretch holds no more
+ * than POINTS samples, they are printed as they are, with their time;
+ * otherwise each row holds the time, minimum, maximum and mean of an entry
+ * of the finest pyramid level giving no more than POINTS rows, so that an
+ * overview of hours of log only decodes a few kilobytes of it. Logs without
+ * a pyramid are only printed at full rate.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ikSiglog.h"
+
+static void usage(void) {
+    printf("usage: logview FILE [SIGNAL [-f FROM] [-t TO] [-n POINTS]]\n");
+}
+
+static int list(const ikSiglogReader *reader) {
+    long span = 1;
+    int i, l;
+
+    printf("%ld samples every %g s from %g s\n", reader->nSamples, reader->samplePeriod, reader->startTime);
+    for (l = 1; l <= reader->nLevels; l++) {
+        span *= reader->pyramidFactor;
+        printf("pyramid level %d: %ld entries of %ld samples\n", l, reader->nEntries[l], span);
+    }
+    for (i = 0; i < reader->nSignals; i++) printf("%s (%s)\n", reader->names[i], reader->units[i]);
+    return 0;
+}
+
+static int view(ikSiglogReader *reader, int signal, double from, double to, long points) {
+    double firstSample = (from - reader->startTime)/reader->samplePeriod + 0.5;
+    double lastSample = (to - reader->startTime)/reader->samplePeriod + 0.5;
+    long first, last;
+    long span = 1;
+    long n, k;
+    int level = 0;
+
+    if (firstSample < 0.0) firstSample = 0.0;
+    if (lastSample > reader->nSamples - 1) lastSample = reader->nSamples - 1;
+    if (lastSample < firstSample) return 0;
+    first = (long) firstSample;
+    last = (long) lastSample;
+
+    /* the finest level with no more than the points asked for */
+    while (level < reader->nLevels && last/span - first/span + 1 > points) {
+        level++;
+        span *= reader->pyramidFactor;
+    }
+    first /= span;
+    n = last/span - first + 1;
+
+    printf("# %s (%s), ", reader->names[signal], reader->units[signal]);
+    if (0 == level) {
+        double *values = (double *) malloc(sizeof(double)*n);
+        printf("full rate\n# time (s)\tvalue\n");
+        if (NULL == values || ikSiglogReader_readColumn(reader, signal, values, first, n) != n) {
+            free(values);
+            return -1;
+        }
+        for (k = 0; k < n; k++) printf("%.6g\t%.9g\n", reader->startTime + (first + k)*reader->samplePeriod, values[k]);
+        free(values);
+    } else {
+        double *values = (double *) malloc(sizeof(double)*3*n);
+        printf("pyramid level %d, %ld samples per row\n# time (s)\tminimum\tmaximum\tmean\n", level, span);
+        if (NULL == values || ikSiglogReader_readPyramid(reader, signal, level, values, values + n, values + 2*n, first, n) != n) {
+            free(values);
+            return -1;
+        }
+        for (k = 0; k < n; k++) {
+            printf("%.6g\t%.9g\t%.9g\t%.9g\n", reader->startTime + (first + k)*span*reader->samplePeriod, values[k], values[n + k], values[2*n + k]);
+        }
+        free(values);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    ikSiglogReader reader;
+    double from = -1.0e300;
+    double to = 1.0e300;
+    long points = 1000;
+    int signal;
+    int err;
+    int i;
+
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    for (i = 3; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) from = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) to = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) points = atol(argv[++i]);
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (points < 1) {
+        usage();
+        return 2;
+    }
+
+    err = ikSiglogReader_open(&reader, argv[1]);
+    if (err) {
+        printf("cannot read %s, error %d\n", argv[1], err);
+        return 1;
+    }
+    if (argc < 3) {
+        err = list(&reader);
+    } else {
+        signal = ikSiglogReader_findSignal(&reader, argv[2]);
+        if (signal < 0) {
+            printf("no signal %s in %s\n", argv[2], argv[1]);
+            ikSiglogReader_close(&reader);
+            return 1;
+        }
+        err = view(&reader, signal, from, to, points);
+    }
+    ikSiglogReader_close(&reader);
+
+    if (err) {
+        printf("cannot decode %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,277 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file powercurve.c
+ *
+ * @brief Steady-state power curves over wind speed and derating ratio
+ *
+ * Runs @link ikClwindconWTCon @endlink in closed loop with
+ * @link ikWtPlant @endlink at constant wind speed, for every cell of a grid
+ * of wind speeds and derating ratios, and writes the steady electrical
+ * power, generator speed, pitch angle and generator torque of each cell to
+ * FILE as text tables, with a row per wind speed and a column per derating
+ * ratio, followed by a table of settling times. Usage:
+ * @li powercurve FILE [-u FROM TO STEP] [-r FROM TO STEP] [-j THREADS] [-t MAXTIME] [-e TOLERANCE]
+ *
+ * Wind speeds are in m/s and times in s. The defaults are wind speeds from 4
+ * to 25 m/s by 1 m/s, derating ratios from 0 to 0.5 by 0.1, a thread per
+ * processor, 300 s and 1e-4.
+ *
+ * The cells are shared out among the threads as they become free. Each cell
+ * starts from the steady operating point found by
+ * @link ikWtPlant_trim @endlink for the control law at its derating ratio,
+ * with the controller, a clone of a template instance, settled on it by
+ * @link ikClwindconWTCon_trim @endlink. The signals are averaged over
+ * consecutive windows of 5 s, and the run stops as soon as the averages of a
+ * window differ from those of the previous one by no more than TOLERANCE
+ * times their value plus a small absolute margin, or after MAXTIME. Cells
+ * that do not settle are marked with a settling time of -1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "ikClwindconWTConfig.h"
+#include "ikAtomic.h"
+#include "ikWtPlant.h"
+#include "ikClosedLoop.h"
+
+#define PI 3.14159265358979
+#define SAMPLE_PERIOD 0.01 /* s */
+#define WINDOW 5.0 /* s */
+#define MAXTHREADS 64
+#define MAXCELLS 4096
+
+#define NSIGNALS 4
+static const char *signalNames[NSIGNALS] = {"power", "generator speed", "pitch", "torque"};
+static const char *signalUnits[NSIGNALS] = {"kW", "rad/s", "deg", "kNm"};
+static const double signalMargin[NSIGNALS] = {1.0, 1.0e-3, 1.0e-2, 1.0e-1}; /* absolute, in signal units */
+
+typedef struct cell {
+    double windSpeed; /* m/s */
+    double deratingRatio; /* - */
+    double values[NSIGNALS];
+    double settlingTime; /* s, -1 if not settled */
+} cell;
+
+static cell cells[MAXCELLS];
+static int nCells;
+static ikAtomicInt nextCell;
+static double maximumTime = 300.0;
+static double tolerance = 1.0e-4;
+
+static ikClwindconWTConParams param;
+static ikClwindconWTCon original;
+static ikClwindconWTCon cons[MAXTHREADS];
+static ikWtPlant plants[MAXTHREADS];
+
+static void runCell(cell *c, ikClwindconWTCon *con, ikWtPlant *wt) {
+    ikWtPlantParams plantParams;
+    long windowSteps = (long) (WINDOW/SAMPLE_PERIOD + 0.5);
+    long maximumSteps = (long) (maximumTime/SAMPLE_PERIOD + 0.5);
+    double sums[NSIGNALS];
+    double previous[NSIGNALS];
+    long k;
+    int windows = 0;
+    int i;
+
+    ikWtPlant_initParams(&plantParams);
+    plantParams.samplePeriod = SAMPLE_PERIOD;
+    ikWtPlant_init(wt, &plantParams);
+    if (ikClwindconWTCon_clone(con, &original)) ikClwindconWTCon_init(con, &param);
+    /* start at the steady operating point of the control law at the derating ratio, if there is one */
+    ikClosedLoop_setInputs(&(con->in), c->deratingRatio, 0.0);
+    ikClosedLoop_trim(con, wt, &param, c->windSpeed, IKCLOSEDLOOP_TRIMSTEPS);
+    wt->in.windSpeed = c->windSpeed;
+
+    c->settlingTime = -1.0;
+    for (i = 0; i < NSIGNALS; i++) {
+        sums[i] = 0.0;
+        previous[i] = 0.0;
+    }
+    for (k = 1; k <= maximumSteps; k++) {
+        ikClosedLoop_setInputs(&(con->in), c->deratingRatio, wt->out.generatorSpeed);
+        ikClwindconWTCon_step(con);
+        wt->in.torqueDemand = con->out.torqueDemand*1.0e3; /* kNm to Nm */
+        wt->in.pitchDemand[0] = con->out.pitchDemandBlade1/180.0*PI; /* deg to rad */
+        wt->in.pitchDemand[1] = con->out.pitchDemandBlade2/180.0*PI; /* deg to rad */
+        wt->in.pitchDemand[2] = con->out.pitchDemandBlade3/180.0*PI; /* deg to rad */
+        ikWtPlant_step(wt);
+
+        sums[0] += wt->out.electricalPower*1.0e-3; /* W to kW */
+        sums[1] += wt->out.generatorSpeed;
+        sums[2] += wt->out.pitch[0]*180.0/PI; /* rad to deg */
+        sums[3] += wt->out.generatorTorque*1.0e-3; /* Nm to kNm */
+        if (k % windowSteps) continue;
+
+        /* compare the window averages with the previous ones */
+        {
+            int settled = windows > 0;
+            for (i = 0; i < NSIGNALS; i++) {
+                double average = sums[i]/windowSteps;
+                if (fabs(average - previous[i]) > tolerance*fabs(previous[i]) + signalMargin[i]) settled = 0;
+                previous[i] = average;
+                c->values[i] = average;
+                sums[i] = 0.0;
+            }
+            windows++;
+            if (settled) {
+                c->settlingTime = k*SAMPLE_PERIOD;
+                return;
+            }
+        }
+    }
+}
+
+static void *worker(void *arg) {
+    int w = (int) (size_t) arg;
+    long i;
+
+    /* take the next free cell until there are none left */
+    while ((i = ikAtomic_fetchAdd(&nextCell, 1)) < nCells) runCell(&(cells[i]), &(cons[w]), &(plants[w]));
+
+    return NULL;
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9*ts.tv_nsec;
+}
+
+static int writeTables(const char *fileName, int nWind, int nDerating) {
+    FILE *f = fopen(fileName, "w");
+    int s, u, r;
+
+    if (NULL == f) return -1;
+    for (s = 0; s <= NSIGNALS; s++) {
+        if (s < NSIGNALS) fprintf(f, "# %s (%s)\n", signalNames[s], signalUnits[s]);
+        else fprintf(f, "# settling time (s)\n");
+        fprintf(f, "# wind speed (m/s) \\ derating ratio (-)");
+        for (r = 0; r < nDerating; r++) fprintf(f, "\t%g", cells[r].deratingRatio);
+        fprintf(f, "\n");
+        for (u = 0; u < nWind; u++) {
+            fprintf(f, "%g", cells[u*nDerating].windSpeed);
+            for (r = 0; r < nDerating; r++) {
+                const cell *c = &(cells[u*nDerating + r]);
+                fprintf(f, "\t%.6g", s < NSIGNALS ? c->values[s] : c->settlingTime);
+            }
+            fprintf(f, "\n");
+        }
+        fprintf(f, "\n\n");
+    }
+    return fclose(f) ? -1 : 0;
+}
+
+static void usage(void) {
+    printf("usage: powercurve FILE [-u FROM TO STEP] [-r FROM TO STEP] [-j THREADS] [-t MAXTIME] [-e TOLERANCE]\n");
+}
+
+int main(int argc, char *argv[]) {
+    double wind[3] = {4.0, 25.0, 1.0}; /* m/s */
+    double derating[3] = {0.0, 0.5, 0.1}; /* - */
+    pthread_t threads[MAXTHREADS];
+    long nProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    int nThreads = nProcessors > 0 ? (nProcessors < MAXTHREADS ? (int) nProcessors : MAXTHREADS) : 1;
+    int nWind, nDerating;
+    int nSettled = 0;
+    double simulated = 0.0;
+    double start, elapsed;
+    int i, u, r;
+
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    for (i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "-u") && i + 3 < argc) {
+            wind[0] = atof(argv[++i]);
+            wind[1] = atof(argv[++i]);
+            wind[2] = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-r") && i + 3 < argc) {
+            derating[0] = atof(argv[++i]);
+            derating[1] = atof(argv[++i]);
+            derating[2] = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-j") && i + 1 < argc) nThreads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) maximumTime = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc) tolerance = atof(argv[++i]);
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (wind[2] <= 0.0 || derating[2] <= 0.0 || nThreads < 1 || nThreads > MAXTHREADS || maximumTime < 2*WINDOW) {
+        usage();
+        return 2;
+    }
+    nWind = (int) floor((wind[1] - wind[0])/wind[2] + 1.0e-9) + 1;
+    nDerating = (int) floor((derating[1] - derating[0])/derating[2] + 1.0e-9) + 1;
+    if (nWind < 1 || nDerating < 1 || nWind*nDerating > MAXCELLS) {
+        printf("the grid must have between 1 and %d cells\n", MAXCELLS);
+        return 2;
+    }
+    nCells = nWind*nDerating;
+    for (u = 0; u < nWind; u++) {
+        for (r = 0; r < nDerating; r++) {
+            cells[u*nDerating + r].windSpeed = wind[0] + u*wind[2];
+            cells[u*nDerating + r].deratingRatio = derating[0] + r*derating[2];
+        }
+    }
+
+    /* every cell starts from a clone of this instance */
+    ikClwindconWTCon_initParams(&param);
+    setParams(&param);
+    if (ikClwindconWTCon_init(&original, &param)) {
+        printf("cannot initialise the controller\n");
+        return 1;
+    }
+
+    start = now();
+    nextCell = 0;
+    for (i = 0; i < nThreads; i++) {
+        if (pthread_create(&(threads[i]), NULL, worker, (void *) (size_t) i)) {
+            printf("cannot start the threads\n");
+            return 1;
+        }
+    }
+    for (i = 0; i < nThreads; i++) pthread_join(threads[i], NULL);
+    elapsed = now() - start;
+
+    for (i = 0; i < nCells; i++) {
+        if (cells[i].settlingTime >= 0.0) {
+            nSettled++;
+            simulated += cells[i].settlingTime;
+        } else {
+            simulated += maximumTime;
+        }
+    }
+    printf("%d cells, %d settled, %.0f s simulated in %.2f s on %d threads\n", nCells, nSettled, simulated, elapsed, nThreads);
+
+    if (writeTables(argv[1], nWind, nDerating)) {
+        printf("cannot write %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
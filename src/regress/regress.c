@@ -0,0 +1,562 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file regress.c
+ *
+ * @brief Golden-trace regression and performance check
+ *
+ * Drives @link ikClwindconWTCon @endlink directly and through DISCON in
+ * closed loop with @link ikWtPlant @endlink, over a set of scripted scenarios: a wind
+ * step, a gust, a derating ramp, an over-speed case, turbulent wind from
+ * @link ikWindGen @endlink and a wind step from a steady start, trimmed with
+ * @link ikWtPlant_trim @endlink and @link ikClwindconWTCon_trim @endlink.
+ * Usage:
+ * @li regress record DIR: run every scenario and store the output traces and the controller time per step in DIR
+ * @li regress check DIR [-r RTOL] [-s SLACK]: run every scenario and compare with the traces in DIR, failing if any sample differs by more than the tolerance or the time per step exceeds the recorded one by more than a fraction SLACK
+ * @li regress bench [DIR]: run every scenario and report the controller time per step, and its speedup over the time recorded in DIR, if given
+ *
+ * When built with OPENDISCON_FAST_STEP, the controller path runs the generic
+ * step, and a second instance initialised for
+ * @link ikClwindconWTCon_fastStep @endlink side by side with it on the same
+ * inputs, reports its time per step and fails if their outputs differ by
+ * more than rounding, or if the specialised step was not taken.
+ *
+ * Every mode also reports the size of a controller instance, in bytes and
+ * cache lines, and the time to initialise it and to clone it, and runs the
+ * over-speed case through @link ikHotswap @endlink, adopting collective pitch
+ * control gains raised by a quarter at 50 s. It reports the time taken by
+ * the step adopting them, and fails unless they are adopted at that step,
+ * without the pitch demand changing more than it did in the second before.
+ */
+
+#define NINT(a) ((a) >= 0.0 ? (int) ((a)+0.5) : ((a)-0.5))
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "ikClwindconWTConfig.h"
+#include "ikSiglog.h"
+#include "ikWtPlant.h"
+#include "ikClosedLoop.h"
+#include "ikWindGen.h"
+#include "ikHotswap.h"
+#include "OpenDiscon_EXPORT.h"
+
+void OpenDiscon_EXPORT DISCON(float *DATA, int FLAG, const char *INFILE, const char *OUTNAME, char *MESSAGE);
+
+#define PI 3.14159265358979
+#define SAMPLE_PERIOD 0.01 /* s */
+#define SWAP_SIZE 128
+
+#define PATH_CONTROLLER 1
+#define PATH_DISCON 2
+
+#define NSIGNALS 3
+static const char *signalNames[NSIGNALS] = {"generator speed", "torque demand", "collective pitch demand"};
+static const char *signalUnits[NSIGNALS] = {"rad/s", "kNm", "deg"};
+static const double signalTolerance[NSIGNALS] = {1.0e-4, 1.0e-2, 1.0e-3}; /* absolute, in signal units */
+
+#define NSCENARIOS 6
+static const char *scenarioNames[NSCENARIOS] = {"wind_step", "gust", "derating_ramp", "overspeed", "turbulence", "trimmed_step"};
+static const double scenarioDurations[NSCENARIOS] = {80.0, 60.0, 80.0, 60.0, 600.0, 40.0}; /* s */
+static const int scenarioPaths[NSCENARIOS] = {PATH_CONTROLLER | PATH_DISCON, PATH_CONTROLLER | PATH_DISCON, PATH_CONTROLLER, PATH_CONTROLLER | PATH_DISCON, PATH_CONTROLLER | PATH_DISCON, PATH_CONTROLLER};
+
+/* scripted inputs */
+
+static ikWindGen wind;
+
+static double windSpeed(int scenario, double t) {
+    switch (scenario) {
+        case 0: /* 8 to 14 m/s step */
+            return t < 20.0 ? 8.0 : 14.0;
+        case 1: /* 1-cos gust of 7 m/s over 10.5 s */
+            if (t >= 20.0 && t < 30.5) return 11.0 + 3.5*(1.0 - cos(2.0*PI*(t - 20.0)/10.5));
+            return 11.0;
+        case 2: /* above rated */
+            return 15.0;
+        case 3: /* 11 to 25 m/s step */
+            return t < 20.0 ? 11.0 : 25.0;
+        case 4: /* Kaimal turbulence, 13 m/s mean, class A */
+            return ikWindGen_step(&wind);
+        case 5: /* 16 to 18 m/s step, from a steady start */
+            return t < 20.0 ? 16.0 : 18.0;
+    }
+    return 0.0;
+}
+
+static double deratingRatio(int scenario, double t) {
+    double dr;
+    if (2 != scenario) return 0.0;
+    /* 0 to 0.5 ramp in 40 s */
+    dr = (t - 10.0)/40.0*0.5;
+    return dr < 0.0 ? 0.0 : (dr > 0.5 ? 0.5 : dr);
+}
+
+static void setInputs(ikClwindconWTConInputs *in, int scenario, double t, double generatorSpeed) {
+    ikClosedLoop_setInputs(in, deratingRatio(scenario, t), generatorSpeed);
+}
+
+/* steady start at the operating point of time 0 */
+
+static void trim(ikClwindconWTCon *con, ikWtPlant *wt, int scenario, const ikClwindconWTConParams *param) {
+    setInputs(&(con->in), scenario, 0.0, 0.0);
+    ikClosedLoop_trim(con, wt, param, windSpeed(scenario, 0.0), IKCLOSEDLOOP_TRIMSTEPS);
+}
+
+/* timing */
+
+static double now(void) {
+#ifdef _WIN32
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (double) count.QuadPart/(double) frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9*ts.tv_nsec;
+#endif
+}
+
+#ifdef OPENDISCON_FAST_STEP
+/* time per step and largest output difference of the specialised step in the last run */
+static double fastNs;
+static double fastDeviation;
+#define FAST_TOLERANCE 1.0e-9 /* relative, rounding differences only */
+
+/* the larger of a difference relative to a reference value and a previous one */
+static double relativeDifference(double value, double reference, double previous) {
+    double difference = fabs(value - reference)/(1.0 + fabs(reference));
+    return difference > previous ? difference : previous;
+}
+#endif
+
+/* closed-loop run of a scenario, returning the controller time per step in ns */
+
+static double run(int scenario, int path, double *trace, long n) {
+    static ikClwindconWTCon con;
+#ifdef OPENDISCON_FAST_STEP
+    static ikClwindconWTCon fast;
+    double fastElapsed = 0.0;
+#endif
+    static ikWtPlant wt;
+    static ikWtPlantParams plantParams;
+    ikClwindconWTConParams param;
+    float DATA[SWAP_SIZE];
+    char message[1024];
+    double elapsed = 0.0;
+    double start;
+    long k;
+
+    ikWtPlant_initParams(&plantParams);
+    plantParams.samplePeriod = SAMPLE_PERIOD;
+    ikWtPlant_init(&wt, &plantParams);
+    if (4 == scenario) {
+        ikWindGenParams windParams;
+        ikWindGen_initParams(&windParams);
+        windParams.meanSpeed = 13.0;
+        windParams.samplePeriod = SAMPLE_PERIOD;
+        windParams.seed = 1;
+        ikWindGen_init(&wind, &windParams);
+    }
+    memset(DATA, 0, sizeof(DATA));
+    if (PATH_CONTROLLER == path) {
+        ikClwindconWTCon_initParams(&param);
+        setParams(&param);
+#ifdef OPENDISCON_FAST_STEP
+        param.fastStep = 1;
+        ikClwindconWTCon_init(&fast, &param);
+        fastDeviation = fast.priv.fastStep ? 0.0 : HUGE_VAL;
+        param.fastStep = 0;
+#endif
+        ikClwindconWTCon_init(&con, &param);
+        if (5 == scenario) {
+            trim(&con, &wt, scenario, &param);
+#ifdef OPENDISCON_FAST_STEP
+            trim(&fast, &wt, scenario, &param);
+#endif
+        }
+    }
+
+    for (k = 0; k < n; k++) {
+        double t = k*SAMPLE_PERIOD;
+        double generatorSpeed = wt.out.generatorSpeed;
+        double torqueDemand, pitchDemand;
+
+        wt.in.windSpeed = windSpeed(scenario, t);
+
+        if (PATH_CONTROLLER == path) {
+            setInputs(&(con.in), scenario, t, generatorSpeed);
+            start = now();
+            ikClwindconWTCon_step(&con);
+            elapsed += now() - start;
+#ifdef OPENDISCON_FAST_STEP
+            fast.in = con.in;
+            start = now();
+            ikClwindconWTCon_step(&fast);
+            fastElapsed += now() - start;
+            fastDeviation = relativeDifference(fast.out.torqueDemand, con.out.torqueDemand, fastDeviation);
+            fastDeviation = relativeDifference(fast.out.pitchDemandBlade1, con.out.pitchDemandBlade1, fastDeviation);
+#endif
+            torqueDemand = con.out.torqueDemand;
+            pitchDemand = con.out.pitchDemandBlade1;
+            wt.in.torqueDemand = torqueDemand*1.0e3; /* kNm to Nm */
+            wt.in.pitchDemand[0] = con.out.pitchDemandBlade1/180.0*PI; /* deg to rad */
+            wt.in.pitchDemand[1] = con.out.pitchDemandBlade2/180.0*PI; /* deg to rad */
+            wt.in.pitchDemand[2] = con.out.pitchDemandBlade3/180.0*PI; /* deg to rad */
+        } else {
+            DATA[0] = (float) (0 == k ? 0 : (n - 1 == k ? -1 : 1));
+            ikWtPlant_writeSwap(&wt, DATA);
+            start = now();
+            DISCON(DATA, 0, "", "", message);
+            elapsed += now() - start;
+            ikWtPlant_readSwap(&wt, DATA);
+            torqueDemand = DATA[46]*1.0e-3;
+            pitchDemand = DATA[44]*180.0/PI;
+        }
+
+        trace[NSIGNALS*k + 0] = generatorSpeed;
+        trace[NSIGNALS*k + 1] = torqueDemand;
+        trace[NSIGNALS*k + 2] = pitchDemand;
+
+        ikWtPlant_step(&wt);
+    }
+
+    if (4 == scenario) ikWindGen_close(&wind);
+#ifdef OPENDISCON_FAST_STEP
+    fastNs = fastElapsed/n*1.0e9;
+#endif
+    return elapsed/n*1.0e9;
+}
+
+/* per-instance size and start-up cost, for sizing multi-turbine runs */
+
+static void footprint(void) {
+    static ikClwindconWTCon original;
+    static ikClwindconWTCon copy;
+    ikClwindconWTConParams param;
+    double start, initTime, cloneTime;
+#ifndef OPENDISCON_NO_DIAGNOSTICS
+    const size_t cold = sizeof(ikClwindconWTCon) - offsetof(ikClwindconWTCon, priv.diagnostics);
+#else
+    const size_t cold = sizeof(ikClwindconWTCon) - offsetof(ikClwindconWTCon, priv.spectralMonitorNames);
+#endif
+    int i;
+
+    printf("controller instance    %8lu bytes, %lu cache lines: %lu bytes of step signals, %lu of managers, %lu of control loops, %lu of diagnostics and signal names\n",
+            (unsigned long) sizeof(ikClwindconWTCon), (unsigned long) IKLAYOUT_CACHELINES(sizeof(ikClwindconWTCon)),
+            (unsigned long) offsetof(ikClwindconWTCon, priv.tpManager),
+            (unsigned long) (offsetof(ikClwindconWTCon, priv.dtdamper) - offsetof(ikClwindconWTCon, priv.tpManager)),
+            (unsigned long) (sizeof(ikClwindconWTCon) - offsetof(ikClwindconWTCon, priv.dtdamper) - cold),
+            (unsigned long) cold);
+
+    start = now();
+    for (i = 0; i < 1000; i++) {
+        ikClwindconWTCon_initParams(&param);
+        setParams(&param);
+        ikClwindconWTCon_init(&original, &param);
+    }
+    initTime = (now() - start)/1000;
+    if (ikClwindconWTCon_clone(&copy, &original)) {
+        printf("controller start-up    %8.1f ns to initialise, not cloneable\n", initTime*1.0e9);
+        return;
+    }
+    start = now();
+    for (i = 0; i < 1000; i++) ikClwindconWTCon_clone(&copy, &original);
+    cloneTime = (now() - start)/1000;
+    printf("controller start-up    %8.1f ns to initialise, %.1f ns to clone\n", initTime*1.0e9, cloneTime*1.0e9);
+}
+
+/* bumpless parameter adoption, above rated */
+
+#define SWAP_SCENARIO 3 /* overspeed */
+#define SWAP_TIME 50.0 /* s */
+#define SWAP_TOLERANCE 1.0e-9 /* deg */
+
+static int hotswap(void) {
+    static ikHotswap hs;
+    static ikHotswapParams params;
+    static ikClwindconWTConParams retuned;
+    static ikWtPlant wt;
+    ikWtPlantParams plantParams;
+    const long n = NINT(scenarioDurations[SWAP_SCENARIO]/SAMPLE_PERIOD);
+    const long swapStep = NINT(SWAP_TIME/SAMPLE_PERIOD);
+    double previousPitch = 0.0;
+    double largestChange = 0.0;
+    double swapChange = 0.0;
+    double nextChange = 0.0;
+    double publishTime = 0.0;
+    double swapTime = 0.0;
+    double swaps;
+    long k;
+
+    ikWtPlant_initParams(&plantParams);
+    plantParams.samplePeriod = SAMPLE_PERIOD;
+    ikWtPlant_init(&wt, &plantParams);
+    ikHotswap_initParams(&params);
+    setParams(&(params.controller));
+    if (ikHotswap_init(&hs, &params)) {
+        printf("hot-swap: cannot initialise the controller\n");
+        return -1;
+    }
+    retuned = params.controller;
+    retuned.collectivePitchControl.linearController.errorTfs.tfParams[0].b[0] *= 1.25;
+    retuned.collectivePitchControl.linearController.errorTfs.tfParams[0].b[1] *= 1.25;
+
+    for (k = 0; k < n; k++) {
+        double t = k*SAMPLE_PERIOD;
+        double start;
+
+        if (swapStep == k) {
+            start = now();
+            if (ikHotswap_publish(&hs, &retuned)) {
+                printf("hot-swap: cannot publish the parameters\n");
+                return -1;
+            }
+            publishTime = now() - start;
+        }
+        wt.in.windSpeed = windSpeed(SWAP_SCENARIO, t);
+        setInputs(&(hs.in), SWAP_SCENARIO, t, wt.out.generatorSpeed);
+        start = now();
+        ikHotswap_step(&hs);
+        if (swapStep == k) swapTime = now() - start;
+        if (k > 0 && k >= swapStep - NINT(1.0/SAMPLE_PERIOD) && k < swapStep && fabs(hs.out.pitchDemandBlade1 - previousPitch) > largestChange) largestChange = fabs(hs.out.pitchDemandBlade1 - previousPitch);
+        if (swapStep == k) swapChange = fabs(hs.out.pitchDemandBlade1 - previousPitch);
+        if (swapStep + 1 == k) nextChange = fabs(hs.out.pitchDemandBlade1 - previousPitch);
+        previousPitch = hs.out.pitchDemandBlade1;
+        wt.in.torqueDemand = hs.out.torqueDemand*1.0e3; /* kNm to Nm */
+        wt.in.pitchDemand[0] = hs.out.pitchDemandBlade1/180.0*PI; /* deg to rad */
+        wt.in.pitchDemand[1] = hs.out.pitchDemandBlade2/180.0*PI; /* deg to rad */
+        wt.in.pitchDemand[2] = hs.out.pitchDemandBlade3/180.0*PI; /* deg to rad */
+        ikWtPlant_step(&wt);
+
+        if (swapStep == k) {
+            ikHotswap_getOutput(&hs, &swaps, "swaps");
+            if (1.0 != swaps) {
+                printf("hot-swap: the parameters were not adopted at the step after they were published\n");
+                return -1;
+            }
+        }
+    }
+
+    printf("hot-swap       %8.1f us to publish, %8.1f us to adopt, pitch demand change %g deg, then %g deg, against %g deg at most in the second before\n",
+            publishTime*1.0e6, swapTime*1.0e6, swapChange, nextChange, largestChange);
+    if (swapChange > SWAP_TOLERANCE) {
+        printf("  the pitch demand jumped with the parameters\n");
+        return -1;
+    }
+    if (nextChange > 1.5*largestChange + SWAP_TOLERANCE) { /* the proportional and integral gains are a quarter higher */
+        printf("  the pitch demand did not carry on smoothly with the new parameters\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void traceFileName(char *fileName, const char *dir, int scenario, int path) {
+    sprintf(fileName, "%s/%s_%s.bin", dir, scenarioNames[scenario], PATH_CONTROLLER == path ? "controller" : "discon");
+}
+
+static int record(const char *dir, int scenario, int path, const double *trace, long n) {
+    ikSiglogParams params;
+    ikSiglog log;
+    char fileName[1024];
+    long k;
+    int i;
+
+    traceFileName(fileName, dir, scenario, path);
+    ikSiglog_initParams(&params);
+    params.fileName = fileName;
+    params.nSignals = NSIGNALS;
+    for (i = 0; i < NSIGNALS; i++) {
+        params.names[i] = signalNames[i];
+        params.units[i] = signalUnits[i];
+    }
+    params.samplePeriod = SAMPLE_PERIOD;
+    if (ikSiglog_init(&log, &params)) return -1;
+    for (k = 0; k < n; k++) ikSiglog_write(&log, trace + NSIGNALS*k);
+    return ikSiglog_close(&log);
+}
+
+static int compare(const char *dir, int scenario, int path, const double *trace, long n, double rtol) {
+    ikSiglogReader reader;
+    char fileName[1024];
+    double *golden;
+    int failed = 0;
+    int i;
+
+    traceFileName(fileName, dir, scenario, path);
+    if (ikSiglogReader_open(&reader, fileName)) {
+        printf("  cannot read %s\n", fileName);
+        return -1;
+    }
+    if (reader.nSamples != n) {
+        printf("  %s has %ld samples, expected %ld\n", fileName, reader.nSamples, n);
+        ikSiglogReader_close(&reader);
+        return -1;
+    }
+    golden = (double *) malloc(sizeof(double)*n);
+    for (i = 0; i < NSIGNALS && NULL != golden; i++) {
+        int signal = ikSiglogReader_findSignal(&reader, signalNames[i]);
+        double worst = 0.0;
+        long worstAt = -1;
+        long k;
+        if (signal < 0 || ikSiglogReader_readColumn(&reader, signal, golden, 0, n) != n) {
+            printf("  %s: missing or corrupt in %s\n", signalNames[i], fileName);
+            failed = 1;
+            continue;
+        }
+        for (k = 0; k < n; k++) {
+            double excess = fabs(trace[NSIGNALS*k + i] - golden[k]) - signalTolerance[i] - rtol*fabs(golden[k]);
+            if (excess > worst || (excess > 0.0 && worstAt < 0)) {
+                worst = excess;
+                worstAt = k;
+            }
+        }
+        if (worstAt >= 0) {
+            printf("  %s: out of tolerance by %g %s at t = %g s\n", signalNames[i], worst, signalUnits[i], worstAt*SAMPLE_PERIOD);
+            failed = 1;
+        }
+    }
+    if (NULL == golden) failed = 1;
+    free(golden);
+    ikSiglogReader_close(&reader);
+    return failed ? -1 : 0;
+}
+
+static double recordedTime(const char *dir, int scenario, int path) {
+    char fileName[1024];
+    char name[256];
+    int p;
+    double ns;
+    double found = -1.0;
+    FILE *f;
+
+    sprintf(fileName, "%s/performance.txt", dir);
+    f = fopen(fileName, "r");
+    if (NULL == f) return -1.0;
+    while (3 == fscanf(f, "%255s %d %lf", name, &p, &ns)) {
+        if (!strcmp(name, scenarioNames[scenario]) && p == path) found = ns;
+    }
+    fclose(f);
+    return found;
+}
+
+static void usage(void) {
+    printf("usage: regress record DIR\n");
+    printf("       regress check DIR [-r RTOL] [-s SLACK]\n");
+    printf("       regress bench [DIR]\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *mode;
+    const char *dir = ".";
+    double rtol = 1.0e-6;
+    double slack = 0.5;
+    FILE *performance = NULL;
+    int failures = 0;
+    int scenario;
+    int path;
+    int i;
+
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    mode = argv[1];
+    if (strcmp(mode, "record") && strcmp(mode, "check") && strcmp(mode, "bench")) {
+        usage();
+        return 2;
+    }
+    if (strcmp(mode, "bench") && argc < 3) {
+        usage();
+        return 2;
+    }
+    if (argc >= 3) dir = argv[2];
+    for (i = 3; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-r")) rtol = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "-s")) slack = atof(argv[i + 1]);
+    }
+
+    if (!strcmp(mode, "record")) {
+        char fileName[1024];
+        sprintf(fileName, "%s/performance.txt", dir);
+        performance = fopen(fileName, "w");
+        if (NULL == performance) {
+            printf("cannot write %s\n", fileName);
+            return 1;
+        }
+    }
+
+    footprint();
+
+    for (scenario = 0; scenario < NSCENARIOS; scenario++) {
+        long n = NINT(scenarioDurations[scenario]/SAMPLE_PERIOD);
+        double *trace = (double *) malloc(sizeof(double)*NSIGNALS*n);
+        if (NULL == trace) return 1;
+        for (path = PATH_CONTROLLER; path <= PATH_DISCON; path++) {
+            double ns;
+            int err = 0;
+            if (!(scenarioPaths[scenario] & path)) continue;
+            ns = run(scenario, path, trace, n);
+            printf("%-14s %-10s %8.1f ns/step\n", scenarioNames[scenario], PATH_CONTROLLER == path ? "controller" : "discon", ns);
+#ifdef OPENDISCON_FAST_STEP
+            if (PATH_CONTROLLER == path) {
+                printf("%-14s %-10s %8.1f ns/step, largest relative difference %g\n", scenarioNames[scenario], "fast", fastNs, fastDeviation);
+                if (!(fastDeviation <= FAST_TOLERANCE)) {
+                    printf("  the specialised step differs from the generic one\n");
+                    failures++;
+                }
+            }
+#endif
+            if (!strcmp(mode, "record")) {
+                err = record(dir, scenario, path, trace, n);
+                fprintf(performance, "%s %d %.1f\n", scenarioNames[scenario], path, ns);
+                if (err) printf("  cannot write the trace\n");
+            } else if (!strcmp(mode, "check")) {
+                double reference = recordedTime(dir, scenario, path);
+                err = compare(dir, scenario, path, trace, n, rtol);
+                if (reference > 0.0 && ns > (1.0 + slack)*reference) {
+                    printf("  %.1f ns/step exceeds the recorded %.1f ns/step by more than %g%%\n", ns, reference, 100.0*slack);
+                    err = -1;
+                }
+            } else if (argc >= 3) {
+                double reference = recordedTime(dir, scenario, path);
+                if (reference > 0.0) printf("  %.2fx the recorded %.1f ns/step\n", reference/ns, reference);
+            }
+            if (err) failures++;
+        }
+        free(trace);
+    }
+
+    if (hotswap()) failures++;
+
+    if (NULL != performance) fclose(performance);
+    if (!strcmp(mode, "check")) printf(failures ? "FAILED (%d)\n" : "PASSED\n", failures);
+    return failures ? 1 : 0;
+}
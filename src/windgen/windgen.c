@@ -0,0 +1,108 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file windgen.c
+ *
+ * @brief Turbulent wind speed series generator
+ *
+ * Writes a wind speed series synthesised by @link ikWindGen @endlink to an
+ * @link ikSiglog @endlink file, which @link ikWindGen @endlink can later play
+ * back. Usage:
+ * @li windgen FILE DURATION [-u MEAN] [-i TI] [-l LENGTH] [-s SEED] [-t PERIOD] [-v]
+ *
+ * DURATION is in s, MEAN in m/s, LENGTH in m and PERIOD in s. The default
+ * values are those of @link ikWindGen_initParams @endlink. -v selects the
+ * von Karman spectrum instead of the Kaimal one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ikSiglog.h"
+#include "ikWindGen.h"
+
+#define NBUFFER 4096
+
+static void usage(void) {
+    printf("usage: windgen FILE DURATION [-u MEAN] [-i TI] [-l LENGTH] [-s SEED] [-t PERIOD] [-v]\n");
+}
+
+int main(int argc, char *argv[]) {
+    ikWindGenParams params;
+    ikWindGen gen;
+    ikSiglogParams logParams;
+    ikSiglog log;
+    double buffer[NBUFFER];
+    long n, done;
+    int err;
+    int i;
+
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+
+    ikWindGen_initParams(&params);
+    for (i = 3; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) params.spectrum = IKWINDGEN_VONKARMAN;
+        else if (i + 1 >= argc) break;
+        else if (!strcmp(argv[i], "-u")) params.meanSpeed = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-i")) params.turbulenceIntensity = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-l")) params.lengthScale = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-s")) params.seed = strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-t")) params.samplePeriod = atof(argv[++i]);
+    }
+    n = (long) (atof(argv[2])/params.samplePeriod + 0.5);
+
+    err = ikWindGen_init(&gen, &params);
+    if (err) {
+        printf("invalid wind parameters, error %d\n", err);
+        return 1;
+    }
+
+    ikSiglog_initParams(&logParams);
+    logParams.fileName = argv[1];
+    logParams.nSignals = 1;
+    logParams.names[0] = "wind speed";
+    logParams.units[0] = "m/s";
+    logParams.samplePeriod = params.samplePeriod;
+    logParams.startTime = params.startTime;
+    if (ikSiglog_init(&log, &logParams)) {
+        printf("cannot write %s\n", argv[1]);
+        ikWindGen_close(&gen);
+        return 1;
+    }
+
+    /* generate and write in buffers, with constant memory */
+    for (done = 0; done < n && !err; done += NBUFFER) {
+        long count = n - done < NBUFFER ? n - done : NBUFFER;
+        ikWindGen_read(&gen, buffer, count);
+        for (i = 0; i < count && !err; i++) err = ikSiglog_write(&log, buffer + i);
+    }
+    if (ikSiglog_close(&log)) err = -1;
+    ikWindGen_close(&gen);
+
+    if (err) {
+        printf("cannot write %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*
+Copyright (C) 2017 IK4-IKERLAN
+
+This file is part of OpenDiscon.
+
+OpenDiscon is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenDiscon is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file wtcodegen.c
+ *
+ * @brief Specialised controller step generator
+ *
+ * Takes the parameter set given by @link setParams @endlink and writes a C
+ * source file with a specialised version of @link ikClwindconWTCon_step @endlink,
+ * @link ikClwindconWTCon_fastStep @endlink, in straight-line code:
+ * @li the power manager look-up tables are unrolled, with their breakpoints and values as compile-time constants, and single-point tables are folded into constants, for @link ikPowman_stepGains @endlink
+ * @li the disabled speed notches and wind speed estimator are dropped
+ * @li the signals that @link ikClwindconWTCon_step @endlink picks up by name are read directly
+ *
+ * The managers are run by their own step functions, and the control loops
+ * by ikConLoop_step, so that there is one copy of their logic, and the
+ * specialised step keeps the state where the generic one does. The file
+ * also defines @link ikClwindconWTCon_fastStepMatches @endlink, which tells
+ * whether a parameter set is the one the code was generated for, and
+ * ikClwindconWTCon_init checks the result against the generic step before
+ * using it. Parameters which are not finite numbers are rejected. Usage:
+ * @li wtcodegen FILE
+ *
+ * The build runs it when OPENDISCON_FAST_STEP is set.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+
+#include "ikClwindconWTConfig.h"
+
+static int invalid = 0; /* whether a parameter written was not a number */
+
+/* format a double as a C literal that reads back to the same value, infinities as HUGE_VAL */
+static const char *num(char *buffer, double value) {
+    if (value != value) {
+        invalid = 1;
+        strcpy(buffer, "0.0");
+    } else if (value > DBL_MAX) {
+        strcpy(buffer, "HUGE_VAL");
+    } else if (value < -DBL_MAX) {
+        strcpy(buffer, "-HUGE_VAL");
+    } else {
+        sprintf(buffer, "%.17g", value);
+        if (NULL == strpbrk(buffer, ".eE")) strcat(buffer, ".0");
+    }
+    return buffer;
+}
+
+static void writeTable(FILE *f, const char *name, const char *comment, int n, const double *x, const double *y) {
+    char a[32], b[32], c[32], d[32];
+    int i;
+
+    fprintf(f, "/* %s */\n", comment);
+    fprintf(f, "static double %s(double x) {\n", name);
+    if (1 == n) {
+        fprintf(f, "    (void) x;\n");
+        fprintf(f, "    return %s;\n", num(a, y[0]));
+        fprintf(f, "}\n\n");
+        return;
+    }
+    fprintf(f, "    if (x <= %s) return %s;\n", num(a, x[0]), num(b, y[0]));
+    for (i = 1; i < n; i++) {
+        fprintf(f, "    if (x < %s) return %s + (%s - %s)*(x - %s)/(%s - %s);\n",
+                num(a, x[i]), num(b, y[i - 1]), num(c, y[i]), num(b, y[i - 1]), num(d, x[i - 1]), num(a, x[i]), num(d, x[i - 1]));
+    }
+    fprintf(f, "    return %s;\n", num(a, y[n - 1]));
+    fprintf(f, "}\n\n");
+}
+
+static void writeTableCheck(FILE *f, const char *field, int n, const double *x, const double *y) {
+    char a[32], b[32];
+    int i;
+
+    fprintf(f, "    if (pm->%sN != %d) return 0;\n", field, n);
+    for (i = 0; i < n; i++) {
+        fprintf(f, "    if (pm->%sX[%d] != %s || pm->%sY[%d] != %s) return 0;\n", field, i, num(a, x[i]), field, i, num(b, y[i]));
+    }
+}
+
+static int writeSource(FILE *f, const ikClwindconWTConParams *param) {
+    const ikPowmanParams *pm = &(param->powerManager);
+    char a[32], b[32];
+
+    fprintf(f, "/*\n");
+    fprintf(f, "Copyright (C) 2017 IK4-IKERLAN\n\n");
+    fprintf(f, "This file is part of OpenDiscon.\n\n");
+    fprintf(f, "OpenDiscon is free software: you can redistribute it and/or modify\n");
+    fprintf(f, "it under the terms of the GNU General Public License as published by\n");
+    fprintf(f, "the Free Software Foundation, either version 3 of the License, or\n");
+    fprintf(f, "(at your option) any later version.\n\n");
+    fprintf(f, "OpenDiscon is distributed in the hope that it will be useful,\n");
+    fprintf(f, "but WITHOUT ANY WARRANTY; without even the implied warranty of\n");
+    fprintf(f, "MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\n");
+    fprintf(f, "GNU General Public License for more details.\n\n");
+    fprintf(f, "You should have received a copy of the GNU General Public License\n");
+    fprintf(f, "along with OpenDiscon. If not, see <http://www.gnu.org/licenses/>.\n");
+    fprintf(f, "*/\n\n");
+    fprintf(f, "/**\n");
+    fprintf(f, " * @file ikClwindconWTConFast.c\n");
+    fprintf(f, " *\n");
+    fprintf(f, " * @brief Specialised ikClwindconWTCon step, generated by wtcodegen. Do not edit\n");
+    fprintf(f, " */\n\n");
+    fprintf(f, "/* @cond */\n\n");
+    fprintf(f, "#include <math.h>\n\n");
+    fprintf(f, "#include \"ikClwindconWTCon.h\"\n\n");
+
+    /* folded look-up tables */
+    writeTable(f, "belowRatedTorqueGain", "below rated torque gain, in kNm*s^2/rad^2, by derating ratio",
+            pm->belowRatedTorqueGainTableN, pm->belowRatedTorqueGainTableX, pm->belowRatedTorqueGainTableY);
+    writeTable(f, "minimumPitch", "minimum pitch, in degrees, by derating ratio",
+            pm->minimumPitchTableN, pm->minimumPitchTableX, pm->minimumPitchTableY);
+
+    /* parameter check */
+    fprintf(f, "int ikClwindconWTCon_fastStepMatches(const ikClwindconWTConParams *params) {\n");
+    fprintf(f, "    const ikPowmanParams *pm = &(params->powerManager);\n\n");
+    fprintf(f, "    if (pm->ratedPower != %s || pm->efficiency != %s) return 0;\n", num(a, pm->ratedPower), num(b, pm->efficiency));
+    writeTableCheck(f, "belowRatedTorqueGainTable", pm->belowRatedTorqueGainTableN, pm->belowRatedTorqueGainTableX, pm->belowRatedTorqueGainTableY);
+    writeTableCheck(f, "minimumPitchTable", pm->minimumPitchTableN, pm->minimumPitchTableX, pm->minimumPitchTableY);
+    fprintf(f, "    if (%sparams->torqueSpeedNotch.enable || %sparams->pitchSpeedNotch.enable || %sparams->windSpeedEstimator.enable) return 0;\n\n",
+            param->torqueSpeedNotch.enable ? "!" : "", param->pitchSpeedNotch.enable ? "!" : "", param->windSpeedEstimator.enable ? "!" : "");
+    fprintf(f, "    return 1;\n");
+    fprintf(f, "}\n\n");
+
+    /* step */
+    fprintf(f, "int ikClwindconWTCon_fastStep(ikClwindconWTCon *self) {\n");
+    fprintf(f, "    ikClwindconWTConPrivate *p = &(self->priv);\n");
+    fprintf(f, "    const double deratingRatio = self->in.deratingRatio;\n");
+    fprintf(f, "    const double generatorSpeed = self->in.generatorSpeed;\n\n");
+
+    if (param->windSpeedEstimator.enable) {
+        fprintf(f, "    /* run wind speed estimator, on the control actions of the step before */\n");
+        fprintf(f, "    ikWsest_step(&(p->windSpeedEstimator), generatorSpeed, self->out.torqueDemand, p->collectivePitchDemand);\n\n");
+    }
+
+    fprintf(f, "    /* run power manager */\n");
+    fprintf(f, "    p->maxTorqueFromPowman = ikPowman_stepGains(&(p->powerManager), deratingRatio, self->in.maximumSpeed, generatorSpeed,\n");
+    fprintf(f, "            belowRatedTorqueGain(deratingRatio), minimumPitch(deratingRatio));\n");
+    fprintf(f, "    p->minPitchFromPowman = p->powerManager.minimumPitch;\n");
+    fprintf(f, "    p->belowRatedTorque = p->powerManager.belowRatedTorque;\n\n");
+
+    fprintf(f, "    /* calculate minimum pitch and maximum torque */\n");
+    fprintf(f, "    p->minPitch = p->minPitchFromPowman > self->in.externalMinimumPitch ? p->minPitchFromPowman : self->in.externalMinimumPitch;\n");
+    fprintf(f, "    p->maxTorque = p->maxTorqueFromPowman < self->in.externalMaximumTorque ? p->maxTorqueFromPowman : self->in.externalMaximumTorque;\n\n");
+
+    fprintf(f, "    /* run torque-pitch manager */\n");
+    fprintf(f, "    p->tpManState = ikTpman_step(&(p->tpManager), p->torqueFromTorqueCon, p->maxTorque, self->in.externalMinimumTorque, p->collectivePitchDemand, self->in.externalMaximumPitch, p->minPitch);\n");
+    fprintf(f, "    p->maxPitch = p->tpManager.maxPitch;\n");
+    fprintf(f, "    p->minTorque = p->tpManager.minTorque;\n\n");
+
+    fprintf(f, "    /* hold the torque and pitch control actions if tracking */\n");
+    fprintf(f, "    if (p->tracking) {\n");
+    fprintf(f, "        p->minTorque = p->trackedTorque;\n");
+    fprintf(f, "        p->maxTorque = p->trackedTorque;\n");
+    fprintf(f, "        p->minPitch = p->trackedPitch;\n");
+    fprintf(f, "        p->maxPitch = p->trackedPitch;\n");
+    fprintf(f, "    }\n\n");
+
+    fprintf(f, "    /* run speed notches */\n");
+    if (param->torqueSpeedNotch.enable) {
+        fprintf(f, "    p->torqueControlSpeed = ikCvfnotch_step(&(p->torqueSpeedNotch), generatorSpeed, generatorSpeed);\n");
+    } else {
+        fprintf(f, "    p->torqueSpeedNotch.input = generatorSpeed;\n");
+        fprintf(f, "    p->torqueSpeedNotch.output = generatorSpeed;\n");
+        fprintf(f, "    p->torqueControlSpeed = generatorSpeed;\n");
+    }
+    if (param->pitchSpeedNotch.enable) {
+        fprintf(f, "    p->pitchControlSpeed = ikCvfnotch_step(&(p->pitchSpeedNotch), generatorSpeed, generatorSpeed);\n\n");
+    } else {
+        fprintf(f, "    p->pitchSpeedNotch.input = generatorSpeed;\n");
+        fprintf(f, "    p->pitchSpeedNotch.output = generatorSpeed;\n");
+        fprintf(f, "    p->pitchControlSpeed = generatorSpeed;\n\n");
+    }
+
+    fprintf(f, "    /* run drivetrain damper */\n");
+    fprintf(f, "    p->torqueFromDtdamper = ikConLoop_step(&(p->dtdamper), 0.0, generatorSpeed, -(self->in.externalMaximumTorque), self->in.externalMaximumTorque);\n\n");
+    fprintf(f, "    /* run torque control */\n");
+    fprintf(f, "    p->torqueFromTorqueCon = ikConLoop_step(&(p->torquecon), self->in.maximumSpeed, p->torqueControlSpeed, p->minTorque, p->maxTorque);\n\n");
+    fprintf(f, "    /* calculate torque demand */\n");
+    fprintf(f, "    self->out.torqueDemand = p->torqueFromDtdamper + p->torqueFromTorqueCon;\n\n");
+    fprintf(f, "    /* run collective pitch control */\n");
+    fprintf(f, "    p->collectivePitchDemand = ikConLoop_step(&(p->colpitchcon), self->in.maximumSpeed, p->pitchControlSpeed, p->minPitch, p->maxPitch);\n\n");
+
+    fprintf(f, "    /* run IPC */\n");
+    fprintf(f, "    self->out.pitchDemandBlade1 = p->collectivePitchDemand;\n");
+    fprintf(f, "    self->out.pitchDemandBlade2 = p->collectivePitchDemand;\n");
+    fprintf(f, "    self->out.pitchDemandBlade3 = p->collectivePitchDemand;\n\n");
+
+    fprintf(f, "    /* run spectral monitor */\n");
+    fprintf(f, "    {\n");
+    fprintf(f, "        double monitored[3];\n");
+    fprintf(f, "        monitored[0] = generatorSpeed;\n");
+    fprintf(f, "        monitored[1] = self->out.torqueDemand;\n");
+    fprintf(f, "        monitored[2] = p->collectivePitchDemand;\n");
+    fprintf(f, "        ikSpecmon_step(&(p->spectralMonitor), monitored);\n");
+    fprintf(f, "    }\n\n");
+    fprintf(f, "    return p->tpManState;\n");
+    fprintf(f, "}\n\n");
+    fprintf(f, "/* @endcond */\n");
+
+    if (invalid) {
+        fprintf(stderr, "wtcodegen: a power manager parameter is not a number\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    ikClwindconWTConParams param;
+    FILE *f;
+
+    if (argc < 2) {
+        printf("usage: wtcodegen FILE\n");
+        return 2;
+    }
+
+    ikClwindconWTCon_initParams(&param);
+    setParams(&param);
+
+    f = fopen(argv[1], "w");
+    if (NULL == f) {
+        printf("cannot write %s\n", argv[1]);
+        return 1;
+    }
+    if (writeSource(f, &param)) {
+        fclose(f);
+        remove(argv[1]);
+        return 1;
+    }
+    if (fclose(f)) {
+        printf("cannot write %s\n", argv[1]);
+        return 1;
+    }
+
+    return 0;
+}